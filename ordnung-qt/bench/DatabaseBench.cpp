@@ -0,0 +1,508 @@
+// ordnung_db_bench — times the Database operations the UI depends on against
+// synthetic libraries and prints the results as JSON.
+//
+//   ordnung_db_bench [--sizes 10000,100000,500000] [--profiles balanced]
+//                    [--repeat 5] [--dir /tmp] [--out results.json] [--keep]
+//
+// Each (size, profile) pair gets a fresh database file: songs are ingested
+// through Database::syncFromDiskBatch, then playlists, cue points, play
+// history and waveform blobs are added in bulk through a separate fixture
+// connection. Every timed operation runs on a real Database instance exactly
+// as the app calls it. Compare two builds by diffing their JSON output.
+
+#include "core/Track.h"
+#include "core/CuePoint.h"
+#include "services/Database.h"
+#include "services/TrackQuery.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include <QDebug>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <random>
+
+namespace {
+
+// ── Synthetic library ───────────────────────────────────────────────────────
+
+constexpr int kFolders          = 50;    // top-level library folders
+constexpr int kSongsPerPlaylist = 250;   // average playlist size
+constexpr int kWaveformBytes    = 800;   // WaveformGenerator::computePeaks default
+constexpr double kDuplicateRate = 0.02;  // tracks re-tagged into an existing artist/title
+
+const char* const kWords[] = {
+    "acid", "after", "alpha", "analog", "aurora", "bass", "beyond", "black",
+    "blue", "city", "cold", "control", "dark", "deep", "delta", "dream",
+    "drift", "echo", "electric", "empire", "fade", "fire", "floor", "focus",
+    "ghost", "glass", "gravity", "heat", "horizon", "house", "hyper", "inner",
+    "jungle", "kinetic", "light", "liquid", "low", "machine", "midnight", "mirror",
+    "motion", "night", "noise", "nova", "orbit", "pulse", "rain", "rave",
+    "rhythm", "signal", "silver", "solar", "sound", "space", "static", "storm",
+    "system", "tempo", "theory", "tokyo", "trance", "tribe", "velvet", "wave",
+};
+constexpr int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+const char* const kGenres[] = {
+    "Techno", "House", "Deep House", "Tech House", "Minimal", "Trance",
+    "Drum & Bass", "Dubstep", "Electro", "Breaks", "Ambient", "Disco",
+};
+const char* const kKeys[] = {
+    "1A", "2A", "3A", "4A", "5A", "6A", "7A", "8A", "9A", "10A", "11A", "12A",
+    "1B", "2B", "3B", "4B", "5B", "6B", "7B", "8B", "9B", "10B", "11B", "12B",
+};
+const char* const kFormats[] = { "mp3", "mp3", "mp3", "flac", "aiff", "wav", "m4a" };
+
+template<typename T, std::size_t N>
+const T& pick(std::mt19937& rng, const T (&items)[N])
+{
+    return items[std::uniform_int_distribution<int>(0, int(N) - 1)(rng)];
+}
+
+std::string phrase(std::mt19937& rng, int words)
+{
+    std::string s;
+    for (int i = 0; i < words; ++i) {
+        if (i) s += ' ';
+        std::string w = kWords[std::uniform_int_distribution<int>(0, kWordCount - 1)(rng)];
+        if (i == 0) w[0] = char(std::toupper(static_cast<unsigned char>(w[0])));
+        s += w;
+    }
+    return s;
+}
+
+QString folderPath(const QString& root, int folder)
+{
+    return root + QStringLiteral("/Music/Crate %1").arg(folder, 2, 10, QLatin1Char('0'));
+}
+
+// Scan-shaped tracks, as LibraryScanner + prepareScanTracks would produce.
+QVector<Track> generateTracks(int count, const QString& root, std::mt19937& rng)
+{
+    const int artists = std::max(10, count / 20);
+    QVector<Track> tracks;
+    tracks.reserve(count);
+    const std::string now = QDateTime::currentDateTime().toString(Qt::ISODate).toStdString();
+
+    for (int i = 0; i < count; ++i) {
+        Track t;
+        const int artist = std::uniform_int_distribution<int>(0, artists - 1)(rng);
+        std::mt19937 artistRng(artist);   // stable name per artist
+        t.artist  = phrase(artistRng, 2);
+        t.title   = phrase(rng, 3) + " " + std::to_string(i);
+        t.album   = phrase(rng, 2);
+        t.genre   = pick(rng, kGenres);
+        t.bpm     = std::uniform_int_distribution<int>(9000, 17500)(rng) / 100.0;
+        t.key_sig = pick(rng, kKeys);
+        t.format  = pick(rng, kFormats);
+        t.bitrate = t.format == "mp3" ? 320 : 1411;
+        const int seconds = std::uniform_int_distribution<int>(150, 600)(rng);
+        t.time    = std::to_string(seconds / 60) + ":" + (seconds % 60 < 10 ? "0" : "")
+                  + std::to_string(seconds % 60);
+        t.date_added = now;
+
+        const int folder = i % kFolders;
+        t.filepath = (folderPath(root, folder)
+                      + QStringLiteral("/%1 - %2.%3")
+                            .arg(QString::fromStdString(t.artist),
+                                 QString::fromStdString(t.title),
+                                 QString::fromStdString(t.format))).toStdString();
+
+        t.match_key = (QString::fromStdString(t.artist).toLower() + QStringLiteral("|||")
+                       + QString::fromStdString(t.title).toLower()).toStdString();
+        tracks.append(t);
+    }
+
+    // Duplicates: copies of an existing artist/title stored under a file key,
+    // the way an untagged file looks once it has been tagged in place.
+    const int dupes = int(count * kDuplicateRate);
+    for (int i = 0; i < dupes; ++i) {
+        Track t = tracks[std::uniform_int_distribution<int>(0, count - 1)(rng)];
+        t.format   = "flac";
+        t.filepath = (folderPath(root, i % kFolders)
+                      + QStringLiteral("/dupes/%1.flac").arg(i)).toStdString();
+        t.match_key = "file:" + t.filepath;
+        tracks[std::uniform_int_distribution<int>(0, count - 1)(rng)] = t;
+    }
+    return tracks;
+}
+
+// Playlists, cue points, history and waveforms, written in one transaction
+// through a plain connection: this is fixture setup, not something we time.
+bool populateExtras(const QString& dbPath, const QVector<long long>& songIds, std::mt19937& rng)
+{
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"),
+                                                    QStringLiteral("bench_fixture"));
+        db.setDatabaseName(dbPath);
+        if (!db.open())
+            return false;
+        db.transaction();
+        QSqlQuery q(db);
+
+        const int playlists = std::max(4, int(songIds.size()) / (kSongsPerPlaylist * 4));
+        q.prepare(QStringLiteral("INSERT INTO playlists (name, imported_at) VALUES (?, ?)"));
+        QSqlQuery link(db);
+        link.prepare(QStringLiteral(
+            "INSERT OR IGNORE INTO playlist_songs (playlist_id, song_id) VALUES (?, ?)"));
+        for (int p = 0; ok && p < playlists; ++p) {
+            q.addBindValue(QString::fromStdString(phrase(rng, 2)));
+            q.addBindValue(QDateTime::currentDateTime().addDays(-p).toString(Qt::ISODate));
+            ok = q.exec();
+            const qlonglong playlistId = q.lastInsertId().toLongLong();
+            // One large playlist (a "whole crate" export), the rest typical.
+            const int size = p == 0 ? int(songIds.size()) / 5
+                                    : std::uniform_int_distribution<int>(20, kSongsPerPlaylist * 2)(rng);
+            for (int i = 0; ok && i < size; ++i) {
+                link.addBindValue(playlistId);
+                link.addBindValue(songIds[std::uniform_int_distribution<int>(
+                    0, int(songIds.size()) - 1)(rng)]);
+                ok = link.exec();
+            }
+        }
+
+        q.prepare(QStringLiteral(
+            "INSERT INTO cue_points (song_id, cue_type, slot, position_ms, end_ms, name, color, sort_order) "
+            "VALUES (?, 'hot_cue', ?, ?, -1, ?, ?, ?)"));
+        QSqlQuery wave(db);
+        wave.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO waveform_cache (song_id, peaks, generated_at) "
+            "VALUES (?, ?, datetime('now'))"));
+        QSqlQuery play(db);
+        play.prepare(QStringLiteral(
+            "INSERT INTO play_history (song_id, played_at) VALUES (?, ?)"));
+
+        QByteArray peaks(kWaveformBytes, '\0');
+        const QDateTime start = QDateTime::currentDateTime().addDays(-365);
+        for (int i = 0; ok && i < songIds.size(); ++i) {
+            const qlonglong id = songIds[i];
+            // Roughly half the library is prepared with 1-8 hot cues.
+            if (i % 2 == 0) {
+                const int cues = 1 + i % 8;
+                for (int c = 0; ok && c < cues; ++c) {
+                    q.addBindValue(id);
+                    q.addBindValue(c);
+                    q.addBindValue(c * 30000);
+                    q.addBindValue(QStringLiteral("Cue %1").arg(c + 1));
+                    q.addBindValue(c + 1);
+                    q.addBindValue(c);
+                    ok = q.exec();
+                }
+            }
+            for (char& b : peaks)
+                b = char(rng() & 0xff);
+            wave.addBindValue(id);
+            wave.addBindValue(peaks);
+            ok = ok && wave.exec();
+
+            if (i % 4 == 0) {
+                play.addBindValue(id);
+                play.addBindValue(start.addSecs(qint64(i) * 60).toString(
+                    QStringLiteral("yyyy-MM-dd HH:mm:ss")));
+                ok = ok && play.exec();
+            }
+        }
+        if (!ok) {
+            qWarning() << "bench: fixture insert failed:" << q.lastError().text()
+                       << link.lastError().text() << wave.lastError().text();
+            db.rollback();
+        } else {
+            ok = db.commit();
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("bench_fixture"));
+    return ok;
+}
+
+// ── Measurement ─────────────────────────────────────────────────────────────
+
+// fn returns the number of rows it produced; recorded so runs can be sanity-checked.
+QJsonObject measure(int repeat, const std::function<qint64()>& fn)
+{
+    QVector<double> samples;
+    qint64 rows = 0;
+    for (int r = 0; r < repeat; ++r) {
+        QElapsedTimer t;
+        t.start();
+        rows = fn();
+        samples.append(t.nsecsElapsed() / 1.0e6);
+    }
+    std::sort(samples.begin(), samples.end());
+    QJsonObject o;
+    o.insert(QStringLiteral("min_ms"),    samples.first());
+    o.insert(QStringLiteral("median_ms"), samples[samples.size() / 2]);
+    o.insert(QStringLiteral("max_ms"),    samples.last());
+    o.insert(QStringLiteral("rows"),      rows);
+    return o;
+}
+
+QJsonObject runLibrary(int songs, const QString& profileName, int repeat,
+                       const QString& dir, bool keep)
+{
+    const QString dbPath = QDir(dir).filePath(
+        QStringLiteral("ordnung-bench-%1-%2.db").arg(songs).arg(profileName));
+    for (const QString& suffix : {QString(), QStringLiteral("-wal"), QStringLiteral("-shm")})
+        QFile::remove(dbPath + suffix);
+
+    const QString root = QStringLiteral("/bench");
+    std::mt19937 rng(songs);
+    QJsonObject results;
+    QJsonObject run;
+    run.insert(QStringLiteral("songs"), songs);
+    run.insert(QStringLiteral("profile"), profileName);
+
+    QElapsedTimer setup;
+    setup.start();
+    const QVector<Track> scan = generateTracks(songs, root, rng);
+    QVector<long long> songIds;
+
+    // Ingest: the first full scan of a new library, then a rescan of it.
+    {
+        Database db;
+        db.setSqliteProfile(Database::sqliteProfileNamed(profileName));
+        if (!db.open(dbPath)) {
+            qCritical() << "bench: cannot open" << dbPath << db.errorString();
+            return run;
+        }
+        results.insert(QStringLiteral("sync_from_disk_batch.initial"), measure(1, [&] {
+            const QVector<Track> synced = db.syncFromDiskBatch(scan);
+            for (const Track& t : synced)
+                if (t.id > 0) songIds.append(t.id);
+            return qint64(synced.size());
+        }));
+        results.insert(QStringLiteral("sync_from_disk_batch.rescan"), measure(repeat, [&] {
+            return qint64(db.syncFromDiskBatch(scan).size());
+        }));
+        std::sort(songIds.begin(), songIds.end());
+        songIds.erase(std::unique(songIds.begin(), songIds.end()), songIds.end());
+    }
+    if (!populateExtras(dbPath, songIds, rng)) {
+        qCritical() << "bench: fixture setup failed for" << songs << "songs";
+        return run;
+    }
+    run.insert(QStringLiteral("setup_ms"), double(setup.elapsed()));
+
+    // Reopen so the timed section starts from a normal app startup.
+    Database db;
+    db.setSqliteProfile(Database::sqliteProfileNamed(profileName));
+    QElapsedTimer openTimer;
+    openTimer.start();
+    if (!db.open(dbPath)) {
+        qCritical() << "bench: cannot reopen" << dbPath << db.errorString();
+        return run;
+    }
+    results.insert(QStringLiteral("open"), QJsonObject{
+        {QStringLiteral("min_ms"), double(openTimer.nsecsElapsed()) / 1.0e6}});
+
+    results.insert(QStringLiteral("sync_from_disk.single"), measure(repeat, [&] {
+        // The per-file path used by FolderWatcher: 200 existing files.
+        for (int i = 0; i < 200; ++i)
+            db.syncFromDisk(scan[(i * 7919) % scan.size()]);
+        return qint64(200);
+    }));
+
+    results.insert(QStringLiteral("load_all_songs"), measure(repeat, [&] {
+        return qint64(db.loadAllSongs().size());
+    }));
+
+    results.insert(QStringLiteral("load_library_songs.folder"), measure(repeat, [&] {
+        return qint64(db.loadLibrarySongs(folderPath(root, 7)).size());
+    }));
+
+    results.insert(QStringLiteral("load_library_songs.root"), measure(repeat, [&] {
+        return qint64(db.loadLibrarySongs(root).size());
+    }));
+
+    const QStringList searches = {
+        QStringLiteral("acid"), QStringLiteral("deep house"),
+        QStringLiteral("midnight sig"), QStringLiteral("tokyo"),
+        QStringLiteral("bpm:122-128"), QStringLiteral("bpm:122-128 key:8A,9A"),
+        QStringLiteral("genre:techno bpm>=130 \"acid\""),
+    };
+    for (const QString& s : searches) {
+        QString name = s;
+        name.replace(QRegularExpression(QStringLiteral("[^A-Za-z0-9]+")), QStringLiteral("_"));
+        while (name.endsWith(QLatin1Char('_')))
+            name.chop(1);
+        results.insert(QStringLiteral("search_tracks.") + name,
+                       measure(repeat, [&] { return qint64(db.searchTracks(s).size()); }));
+    }
+
+    // What VirtualTrackModel does on open, on a header click and per page.
+    results.insert(QStringLiteral("find_track_ids.title"), measure(repeat, [&] {
+        return qint64(db.findTrackIds(TrackQuery()).size());
+    }));
+    results.insert(QStringLiteral("find_track_ids.key_bpm"), measure(repeat, [&] {
+        return qint64(db.findTrackIds(TrackQuery(), QString(),
+            {{SongOrder::KeySig, false}, {SongOrder::Bpm, true}}).size());
+    }));
+    const QVector<long long> allIds = db.findTrackIds(TrackQuery());
+    results.insert(QStringLiteral("load_songs_by_ids.page"), measure(repeat, [&] {
+        const int first = int(allIds.size() / 2);
+        const int count = qMin(256, int(allIds.size()) - first);
+        return qint64(db.loadSongsByIds(allIds.mid(first, count)).size());
+    }));
+
+    results.insert(QStringLiteral("load_playlists"), measure(repeat, [&] {
+        return qint64(db.loadPlaylists().size());
+    }));
+
+    results.insert(QStringLiteral("find_duplicate_groups"), measure(repeat, [&] {
+        return qint64(db.findDuplicateGroups().size());
+    }));
+
+    // Scroll the largest playlist to the bottom, 200 rows per fetchMore.
+    const QVector<Playlist> playlists = db.loadPlaylists();
+    long long largest = -1;
+    int largestTotal = -1;
+    for (const Playlist& p : playlists) {
+        if (p.total > largestTotal) {
+            largestTotal = p.total;
+            largest = p.id;
+        }
+    }
+    results.insert(QStringLiteral("load_tracks.paged_scroll"), measure(repeat, [&] {
+        qint64 rows = 0;
+        QString title;
+        long long id = 0;
+        for (;;) {
+            const QVector<Track> page = db.loadTracksAfter(largest, title, id, 200);
+            if (page.isEmpty())
+                break;
+            rows += page.size();
+            title = QString::fromStdString(page.last().title);
+            id    = page.last().id;
+        }
+        return rows;
+    }));
+
+    // What ExportService reads before writing anything.
+    results.insert(QStringLiteral("export_loaders"), measure(repeat, [&] {
+        qint64 rows = 0;
+        QSet<long long> seen;
+        for (const Playlist& p : db.loadPlaylists()) {
+            for (const Track& t : db.loadPlaylistSongs(p.id)) {
+                ++rows;
+                if (!seen.contains(t.id)) {
+                    seen.insert(t.id);
+                    rows += db.loadCuePoints(t.id).size();
+                }
+            }
+        }
+        return rows;
+    }));
+
+    results.insert(QStringLiteral("load_waveform_overview"), measure(repeat, [&] {
+        qint64 bytes = 0;
+        for (int i = 0; i < 1000; ++i)
+            bytes += db.loadWaveformOverview(songIds[(i * 104729) % songIds.size()]).size();
+        return bytes;
+    }));
+
+    results.insert(QStringLiteral("history"), measure(repeat, [&] {
+        qint64 rows = 0;
+        for (const QString& date : db.loadHistoryDates(30))
+            rows += db.loadTracksPlayedOn(date).size();
+        return rows;
+    }));
+
+    run.insert(QStringLiteral("db_bytes"), QFileInfo(dbPath).size());
+    run.insert(QStringLiteral("results"), results);
+
+    if (!keep) {
+        for (const QString& suffix : {QString(), QStringLiteral("-wal"), QStringLiteral("-shm")})
+            QFile::remove(dbPath + suffix);
+    }
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("ordnung_db_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Ordnung database micro-benchmarks"));
+    parser.addHelpOption();
+    const QCommandLineOption sizesOpt(QStringLiteral("sizes"),
+        QStringLiteral("Comma-separated library sizes."), QStringLiteral("list"),
+        QStringLiteral("10000,100000,500000"));
+    const QCommandLineOption profilesOpt(QStringLiteral("profiles"),
+        QStringLiteral("Comma-separated SQLite profiles (safe, balanced, fast)."),
+        QStringLiteral("list"), QStringLiteral("balanced"));
+    const QCommandLineOption repeatOpt(QStringLiteral("repeat"),
+        QStringLiteral("Runs per operation."), QStringLiteral("n"), QStringLiteral("5"));
+    const QCommandLineOption dirOpt(QStringLiteral("dir"),
+        QStringLiteral("Directory for the database files."), QStringLiteral("path"),
+        QDir::tempPath());
+    const QCommandLineOption outOpt(QStringLiteral("out"),
+        QStringLiteral("Write JSON here instead of stdout."), QStringLiteral("file"));
+    const QCommandLineOption keepOpt(QStringLiteral("keep"),
+        QStringLiteral("Keep the generated databases."));
+    parser.addOptions({sizesOpt, profilesOpt, repeatOpt, dirOpt, outOpt, keepOpt});
+    parser.process(app);
+
+    const int repeat = std::max(1, parser.value(repeatOpt).toInt());
+    QJsonArray runs;
+    for (const QString& profile : parser.value(profilesOpt).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        for (const QString& size : parser.value(sizesOpt).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+            const int songs = size.trimmed().toInt();
+            if (songs <= 0)
+                continue;
+            qInfo() << "bench:" << songs << "songs, profile" << profile;
+            runs.append(runLibrary(songs, profile.trimmed(), repeat,
+                                   parser.value(dirOpt), parser.isSet(keepOpt)));
+        }
+    }
+
+    QJsonObject report;
+    {
+        QSqlDatabase probe = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"),
+                                                       QStringLiteral("bench_probe"));
+        probe.setDatabaseName(QStringLiteral(":memory:"));
+        if (probe.open()) {
+            QSqlQuery q(probe);
+            if (q.exec(QStringLiteral("SELECT sqlite_version()")) && q.next())
+                report.insert(QStringLiteral("sqlite_version"), q.value(0).toString());
+        }
+        probe.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("bench_probe"));
+    report.insert(QStringLiteral("qt_version"), QString::fromLatin1(qVersion()));
+    report.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert(QStringLiteral("repeat"), repeat);
+    report.insert(QStringLiteral("runs"), runs);
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outOpt)) {
+        QFile f(parser.value(outOpt));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "bench: cannot write" << f.fileName();
+            return 1;
+        }
+        f.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -35,7 +35,8 @@ private:
     ServiceRegistry*  m_registry      = nullptr;
 
     // Services
-    class Database*   m_db = nullptr;
+    class DatabasePool* m_dbPool = nullptr;
+    class Database*   m_db = nullptr;      // m_dbPool->primary(), GUI thread only
     ConversionWorker* m_converter    = nullptr;
     FolderWatcher*    m_watcher      = nullptr;
     QThread*          m_workerThread = nullptr;
@@ -10,3 +10,14 @@ struct Playlist {
     int         total         = 0;
     std::map<std::string, int> format_counts;  // {"mp3": 42, "flac": 8, ...}
 };
+
+// A rules-based playlist. query is TrackQuery text ("bpm:120-128 key:8A");
+// membership is kept materialized by the Database.
+struct SmartPlaylist {
+    long long   id            = 0;
+    std::string name;
+    std::string query;
+    std::string sort_field    = "title";
+    bool        descending    = false;
+    int         total         = 0;
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Track.h"
+
+// Pure C++ — zero Qt headers.
+
+// StringPool — interns text: each distinct value is stored once and rows
+// refer to it by a 32-bit id. Id 0 is always the empty string. Values are
+// never evicted; clear() drops them all.
+class StringPool {
+public:
+    using Id = std::uint32_t;
+
+    StringPool() { clear(); }
+
+    // m_ids keys on views into m_strings, so a copy must re-key on its own
+    // strings. Moves keep the deque's elements where they are.
+    StringPool(const StringPool& other) : m_strings(other.m_strings) { rebuildIds(); }
+    StringPool& operator=(const StringPool& other) {
+        if (this != &other) {
+            m_strings = other.m_strings;
+            rebuildIds();
+        }
+        return *this;
+    }
+    StringPool(StringPool&&) noexcept = default;
+    StringPool& operator=(StringPool&&) noexcept = default;
+
+    Id intern(const std::string& s) {
+        if (s.empty()) return 0;
+        const auto it = m_ids.find(s);
+        if (it != m_ids.end()) return it->second;
+        const Id id = Id(m_strings.size());
+        m_strings.push_back(s);               // deque: earlier strings never move,
+        m_ids.emplace(m_strings.back(), id);  // so the map can key on views of them
+        return id;
+    }
+
+    const std::string& str(Id id) const { return m_strings[id]; }
+    std::size_t size() const { return m_strings.size(); }
+
+    void clear() {
+        m_ids.clear();
+        m_strings.assign(1, std::string());
+    }
+
+private:
+    void rebuildIds() {
+        m_ids.clear();
+        m_ids.reserve(m_strings.size());
+        for (std::size_t i = 1; i < m_strings.size(); ++i)
+            m_ids.emplace(m_strings[i], Id(i));
+    }
+
+    std::deque<std::string>                  m_strings;
+    std::unordered_map<std::string_view, Id> m_ids;
+};
+
+class TrackRef;
+
+// TrackStore — a track list stored by column. Every field of Track lives in
+// its own contiguous array, so a scan over one field (sorting by BPM,
+// filtering by genre) reads only that field's memory. Text that repeats
+// across a library — artist, album, genre, key, format, time, date added,
+// comment, tag lists — is interned in a StringPool; text unique to a row
+// (title, filepath, match key, date played) keeps its own string. Booleans
+// share one byte per row.
+//
+// Rows are addressed by index like QVector<Track>; operator[] returns a
+// TrackRef handle that reads fields in place, and track(row) rebuilds a full
+// Track when one has to leave the store (database writes, dialogs).
+class TrackStore {
+public:
+    int  size() const    { return int(m_id.size()); }
+    bool isEmpty() const { return m_id.empty(); }
+
+    void clear() {
+        forEachColumn([](auto& c) { std::decay_t<decltype(c)>().swap(c); });
+        m_pool.clear();
+    }
+
+    void reserve(int rows) {
+        forEachColumn([rows](auto& c) { c.reserve(std::size_t(rows)); });
+    }
+
+    template<typename It>
+    void assign(It first, It last) {
+        clear();
+        reserve(int(std::distance(first, last)));
+        for (; first != last; ++first) append(*first);
+    }
+
+    void append(const Track& t) {
+        insertDefault(size(), 1);
+        set(size() - 1, t);
+    }
+
+    template<typename It>
+    void insert(int row, It first, It last) {
+        const int count = int(std::distance(first, last));
+        insertDefault(row, count);
+        for (int r = row; first != last; ++first, ++r) set(r, *first);
+    }
+
+    void remove(int row, int count = 1) {
+        forEachColumn([row, count](auto& c) {
+            c.erase(c.begin() + row, c.begin() + row + count);
+        });
+    }
+
+    // Moves row from to position to, shifting the rows between (as QList::move).
+    void move(int from, int to) {
+        forEachColumn([from, to](auto& c) {
+            if (from < to)
+                std::rotate(c.begin() + from, c.begin() + from + 1, c.begin() + to + 1);
+            else
+                std::rotate(c.begin() + to, c.begin() + from, c.begin() + from + 1);
+        });
+    }
+
+    void set(int row, const Track& t) {
+        m_id[row]           = t.id;
+        m_title[row]        = t.title;
+        m_filepath[row]     = t.filepath;
+        m_matchKey[row]     = t.match_key;
+        m_datePlayed[row]   = t.date_played;
+        m_artist[row]       = m_pool.intern(t.artist);
+        m_album[row]        = m_pool.intern(t.album);
+        m_genre[row]        = m_pool.intern(t.genre);
+        m_keySig[row]       = m_pool.intern(t.key_sig);
+        m_format[row]       = m_pool.intern(t.format);
+        m_time[row]         = m_pool.intern(t.time);
+        m_dateAdded[row]    = m_pool.intern(t.date_added);
+        m_comment[row]      = m_pool.intern(t.comment);
+        m_moodTags[row]     = m_pool.intern(t.mood_tags);
+        m_styleTags[row]    = m_pool.intern(t.style_tags);
+        m_bpm[row]          = t.bpm;
+        m_danceability[row] = t.danceability;
+        m_valence[row]      = t.valence;
+        m_vocalProb[row]    = t.vocal_prob;
+        m_bitrate[row]      = t.bitrate;
+        m_playCount[row]    = t.play_count;
+        m_rating[row]       = std::int8_t(t.rating);
+        m_energy[row]       = std::int8_t(t.energy);
+        m_colorLabel[row]   = std::int8_t(t.color_label);
+        m_flags[row]        = std::uint8_t((t.has_aiff ? HasAiff : 0)
+                                         | (t.essentia_analyzed ? EssentiaAnalyzed : 0)
+                                         | (t.is_prepared ? Prepared : 0)
+                                         | (t.expanded ? Expanded : 0)
+                                         | (t.is_analyzing ? Analyzing : 0));
+    }
+
+    Track track(int row) const {
+        Track t;
+        t.id                = m_id[row];
+        t.title             = m_title[row];
+        t.filepath          = m_filepath[row];
+        t.match_key         = m_matchKey[row];
+        t.date_played       = m_datePlayed[row];
+        t.artist            = artist(row);
+        t.album             = album(row);
+        t.genre             = genre(row);
+        t.key_sig           = keySig(row);
+        t.format            = format(row);
+        t.time              = time(row);
+        t.date_added        = dateAdded(row);
+        t.comment           = comment(row);
+        t.mood_tags         = moodTags(row);
+        t.style_tags        = styleTags(row);
+        t.bpm               = m_bpm[row];
+        t.danceability      = m_danceability[row];
+        t.valence           = m_valence[row];
+        t.vocal_prob        = m_vocalProb[row];
+        t.bitrate           = m_bitrate[row];
+        t.play_count        = m_playCount[row];
+        t.rating            = m_rating[row];
+        t.energy            = m_energy[row];
+        t.color_label       = m_colorLabel[row];
+        t.has_aiff          = hasAiff(row);
+        t.essentia_analyzed = essentiaAnalyzed(row);
+        t.is_prepared       = isPrepared(row);
+        t.expanded          = expanded(row);
+        t.is_analyzing      = isAnalyzing(row);
+        return t;
+    }
+
+    TrackRef operator[](int row) const;
+
+    // ── Field reads ─────────────────────────────────────────────────────────
+    long long          id(int row) const          { return m_id[row]; }
+    const std::string& title(int row) const       { return m_title[row]; }
+    const std::string& filepath(int row) const    { return m_filepath[row]; }
+    const std::string& matchKey(int row) const    { return m_matchKey[row]; }
+    const std::string& datePlayed(int row) const  { return m_datePlayed[row]; }
+    const std::string& artist(int row) const      { return m_pool.str(m_artist[row]); }
+    const std::string& album(int row) const       { return m_pool.str(m_album[row]); }
+    const std::string& genre(int row) const       { return m_pool.str(m_genre[row]); }
+    const std::string& keySig(int row) const      { return m_pool.str(m_keySig[row]); }
+    const std::string& format(int row) const      { return m_pool.str(m_format[row]); }
+    const std::string& time(int row) const        { return m_pool.str(m_time[row]); }
+    const std::string& dateAdded(int row) const   { return m_pool.str(m_dateAdded[row]); }
+    const std::string& comment(int row) const     { return m_pool.str(m_comment[row]); }
+    const std::string& moodTags(int row) const    { return m_pool.str(m_moodTags[row]); }
+    const std::string& styleTags(int row) const   { return m_pool.str(m_styleTags[row]); }
+    double             bpm(int row) const         { return m_bpm[row]; }
+    float              danceability(int row) const { return m_danceability[row]; }
+    float              valence(int row) const     { return m_valence[row]; }
+    float              vocalProb(int row) const   { return m_vocalProb[row]; }
+    int                bitrate(int row) const     { return m_bitrate[row]; }
+    int                playCount(int row) const   { return m_playCount[row]; }
+    int                rating(int row) const      { return m_rating[row]; }
+    int                energy(int row) const      { return m_energy[row]; }
+    int                colorLabel(int row) const  { return m_colorLabel[row]; }
+    bool hasAiff(int row) const          { return m_flags[row] & HasAiff; }
+    bool essentiaAnalyzed(int row) const { return m_flags[row] & EssentiaAnalyzed; }
+    bool isPrepared(int row) const       { return m_flags[row] & Prepared; }
+    bool expanded(int row) const         { return m_flags[row] & Expanded; }
+    bool isAnalyzing(int row) const      { return m_flags[row] & Analyzing; }
+
+    // ── In-place writes for fields the table toggles ────────────────────────
+    void setFormat(int row, const std::string& format) { m_format[row] = m_pool.intern(format); }
+    void setColorLabel(int row, int label)   { m_colorLabel[row] = std::int8_t(label); }
+    void setHasAiff(int row, bool on)        { setFlag(row, HasAiff, on); }
+    void setPrepared(int row, bool on)       { setFlag(row, Prepared, on); }
+    void setExpanded(int row, bool on)       { setFlag(row, Expanded, on); }
+    void setAnalyzing(int row, bool on)      { setFlag(row, Analyzing, on); }
+
+    // ── Whole columns, for scans over one field ─────────────────────────────
+    const std::vector<long long>&   idColumn() const  { return m_id; }
+    const std::vector<double>&      bpmColumn() const { return m_bpm; }
+    const std::vector<std::string>& titleColumn() const { return m_title; }
+    const StringPool&               strings() const   { return m_pool; }
+
+private:
+    enum Flag : std::uint8_t {
+        HasAiff = 1, EssentiaAnalyzed = 2, Prepared = 4, Expanded = 8, Analyzing = 16,
+    };
+
+    void setFlag(int row, Flag flag, bool on) {
+        m_flags[row] = std::uint8_t(on ? (m_flags[row] | flag) : (m_flags[row] & ~flag));
+    }
+
+    void insertDefault(int row, int count) {
+        forEachColumn([row, count](auto& c) {
+            c.insert(c.begin() + row, std::size_t(count),
+                     typename std::decay_t<decltype(c)>::value_type());
+        });
+    }
+
+    template<typename Fn>
+    void forEachColumn(Fn fn) {
+        fn(m_id);
+        fn(m_title); fn(m_filepath); fn(m_matchKey); fn(m_datePlayed);
+        fn(m_artist); fn(m_album); fn(m_genre); fn(m_keySig); fn(m_format);
+        fn(m_time); fn(m_dateAdded); fn(m_comment); fn(m_moodTags); fn(m_styleTags);
+        fn(m_bpm); fn(m_danceability); fn(m_valence); fn(m_vocalProb);
+        fn(m_bitrate); fn(m_playCount);
+        fn(m_rating); fn(m_energy); fn(m_colorLabel); fn(m_flags);
+    }
+
+    StringPool m_pool;
+
+    std::vector<long long>      m_id;
+    std::vector<std::string>    m_title, m_filepath, m_matchKey, m_datePlayed;
+    std::vector<StringPool::Id> m_artist, m_album, m_genre, m_keySig, m_format,
+                                m_time, m_dateAdded, m_comment, m_moodTags, m_styleTags;
+    std::vector<double>         m_bpm;
+    std::vector<float>          m_danceability, m_valence, m_vocalProb;
+    std::vector<std::int32_t>   m_bitrate, m_playCount;
+    std::vector<std::int8_t>    m_rating, m_energy, m_colorLabel;
+    std::vector<std::uint8_t>   m_flags;
+};
+
+// TrackRef — a (store, row) handle with Track's fields as accessors. Cheap to
+// copy; valid until the store's rows change.
+class TrackRef {
+public:
+    TrackRef() = default;
+    TrackRef(const TrackStore* store, int row) : m_store(store), m_row(row) {}
+
+    bool isValid() const { return m_store != nullptr && m_row >= 0 && m_row < m_store->size(); }
+    int  row() const     { return m_row; }
+    Track track() const  { return m_store->track(m_row); }
+
+    long long          id() const          { return m_store->id(m_row); }
+    const std::string& title() const       { return m_store->title(m_row); }
+    const std::string& artist() const      { return m_store->artist(m_row); }
+    const std::string& album() const       { return m_store->album(m_row); }
+    const std::string& genre() const       { return m_store->genre(m_row); }
+    const std::string& keySig() const      { return m_store->keySig(m_row); }
+    const std::string& format() const      { return m_store->format(m_row); }
+    const std::string& time() const        { return m_store->time(m_row); }
+    const std::string& dateAdded() const   { return m_store->dateAdded(m_row); }
+    const std::string& datePlayed() const  { return m_store->datePlayed(m_row); }
+    const std::string& filepath() const    { return m_store->filepath(m_row); }
+    const std::string& comment() const     { return m_store->comment(m_row); }
+    const std::string& moodTags() const    { return m_store->moodTags(m_row); }
+    const std::string& styleTags() const   { return m_store->styleTags(m_row); }
+    double bpm() const          { return m_store->bpm(m_row); }
+    int    rating() const       { return m_store->rating(m_row); }
+    int    bitrate() const      { return m_store->bitrate(m_row); }
+    int    playCount() const    { return m_store->playCount(m_row); }
+    int    energy() const       { return m_store->energy(m_row); }
+    int    colorLabel() const   { return m_store->colorLabel(m_row); }
+    float  danceability() const { return m_store->danceability(m_row); }
+    float  valence() const      { return m_store->valence(m_row); }
+    float  vocalProb() const    { return m_store->vocalProb(m_row); }
+    bool   hasAiff() const      { return m_store->hasAiff(m_row); }
+    bool   isPrepared() const   { return m_store->isPrepared(m_row); }
+    bool   expanded() const     { return m_store->expanded(m_row); }
+    bool   isAnalyzing() const  { return m_store->isAnalyzing(m_row); }
+
+private:
+    const TrackStore* m_store = nullptr;
+    int               m_row   = -1;
+};
+
+inline TrackRef TrackStore::operator[](int row) const
+{
+    return TrackRef(this, row);
+}
@@ -29,13 +29,12 @@ void FormatDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option
 
     TrackModel* tm = view->trackModel();
     const int srcRow = sourceIdx.row();
-    if (srcRow < 0 || srcRow >= tm->tracks().size())
+    if (srcRow < 0 || srcRow >= tm->store().size())
         return;
 
-    const Track& track = tm->tracks()[srcRow];
-    const bool rowExpanded = tm->data(sourceIdx, TrackModel::ExpandedRole).toBool();
+    const bool rowExpanded = tm->store().expanded(srcRow);
 
-    LibraryTableRow row(&track, srcRow);
+    LibraryTableRow row(&tm->store(), srcRow);
     LibraryTableRowPainter::paintCell(painter, index.column(), option.rect, row,
                                      option, rowExpanded, view);
 
@@ -1,5 +1,6 @@
 #include "TrackModel.h"
 #include "services/Database.h"
+#include "services/WriteBehindQueue.h"
 #include "services/PlaylistImporter.h"
 #include "views/table/LibraryTableColumn.h"
 
@@ -7,6 +8,9 @@
 #include <QColor>
 #include <QLocale>
 #include <QDateTime>
+#include <QSet>
+
+#include <algorithm>
 
 TrackModel::TrackModel(Database* db, QObject* parent)
     : QAbstractTableModel(parent)
@@ -20,6 +24,10 @@ void TrackModel::loadPlaylist(long long playlistId)
     m_playlistId  = playlistId;
     m_totalCount  = m_db->countTracks(playlistId);
     m_loadedCount = 0;
+    m_pageTitle.clear();
+    m_pageId      = 0;
+    m_searchQuery.clear();
+    rebuildRowIndex();
     endResetModel();
 
     // Immediately fetch the first batch so the view is not empty on load.
@@ -30,27 +38,42 @@ void TrackModel::loadFromDatabase(const QVector<Track>& tracks)
 {
     qInfo() << "TrackModel::loadFromDatabase:" << tracks.size() << "tracks";
     beginResetModel();
-    m_tracks      = tracks;
+    m_tracks.assign(tracks.begin(), tracks.end());
     m_playlistId  = -1;
     m_totalCount  = tracks.size();
     m_loadedCount = tracks.size();
+    m_searchQuery.clear();
+    rebuildRowIndex();
     endResetModel();
 }
 
-void TrackModel::ingestAndAppend(const QVector<Track>& scanTracks)
+// Fill in match_key / date_added the way syncFromDisk expects them.
+static QVector<Track> prepareScanTracks(const QVector<Track>& scanTracks)
 {
     const QString now = QDateTime::currentDateTime().toString(Qt::ISODate);
-    QVector<Track> toAdd;
-    toAdd.reserve(scanTracks.size());
+    QVector<Track> prepared;
+    prepared.reserve(scanTracks.size());
     for (Track t : scanTracks) {
         if (t.match_key.empty())
             t.match_key = PlaylistImporter::makeMatchKey(
                 QString::fromStdString(t.artist), QString::fromStdString(t.title)).toStdString();
+        // When artist and title are both empty, makeMatchKey returns "|||" — use filepath
+        // so each unnamed file gets its own DB row rather than colliding.
         if (t.match_key == "|||")
             t.match_key = "file:" + t.filepath;
         if (t.date_added.empty())
             t.date_added = now.toStdString();
-        Track dbTrack = m_db->syncFromDisk(t);
+        prepared.append(t);
+    }
+    return prepared;
+}
+
+void TrackModel::ingestAndAppend(const QVector<Track>& scanTracks)
+{
+    const QVector<Track> synced = m_db->syncFromDiskBatch(prepareScanTracks(scanTracks));
+    QVector<Track> toAdd;
+    toAdd.reserve(synced.size());
+    for (Track dbTrack : synced) {
         if (dbTrack.id > 0) {
             dbTrack.is_analyzing = true;  // metadata pending background analysis
             toAdd.append(dbTrack);
@@ -59,9 +82,12 @@ void TrackModel::ingestAndAppend(const QVector<Track>& scanTracks)
     if (toAdd.isEmpty()) return;
     const int first = m_tracks.size();
     beginInsertRows({}, first, first + toAdd.size() - 1);
-    m_tracks.append(toAdd);
+    m_tracks.insert(first, toAdd.begin(), toAdd.end());
     m_totalCount  += toAdd.size();
     m_loadedCount += toAdd.size();
+    indexRows(first);
+    for (const Track& t : std::as_const(toAdd))
+        m_analyzingIds.insert(t.id);
     endInsertRows();
     qInfo() << "TrackModel::ingestAndAppend:" << toAdd.size() << "new tracks added";
 }
@@ -69,38 +95,109 @@ void TrackModel::ingestAndAppend(const QVector<Track>& scanTracks)
 void TrackModel::loadFromFiles(const QVector<Track>& tracks)
 {
     qDebug() << "TrackModel::loadFromFiles:" << tracks.size() << "tracks from scan";
-    QVector<Track> synced;
-    synced.reserve(tracks.size());
-    const QString now = QDateTime::currentDateTime().toString(Qt::ISODate);
-    for (Track t : tracks) {
-        if (t.match_key.empty())
-            t.match_key = PlaylistImporter::makeMatchKey(
-                QString::fromStdString(t.artist), QString::fromStdString(t.title)).toStdString();
-        // When artist and title are both empty, makeMatchKey returns "|||" — use filepath
-        // so each unnamed file gets its own DB row rather than colliding.
-        if (t.match_key == "|||")
-            t.match_key = "file:" + t.filepath;
-        if (t.date_added.empty())
-            t.date_added = now.toStdString();
-
-        // syncFromDisk: if match_key exists in DB, returns the full DB row (user edits intact).
-        // If new, inserts and returns the new row. Always sets id > 0 on success.
-        const Track dbTrack = m_db->syncFromDisk(t);
-        synced.append(dbTrack);
-    }
+    // syncFromDiskBatch: rows whose match_key exists in the DB come back with user edits
+    // intact; new files are inserted. One transaction for the whole scan.
+    const QVector<Track> synced = m_db->syncFromDiskBatch(prepareScanTracks(tracks));
     qInfo() << "TrackModel::loadFromFiles: loaded" << synced.size() << "tracks into model";
     beginResetModel();
-    m_tracks      = synced;
+    m_tracks.assign(synced.begin(), synced.end());
     m_playlistId  = -1;
     m_totalCount  = synced.size();
     m_loadedCount = synced.size();
+    m_searchQuery.clear();
+    rebuildRowIndex();
     endResetModel();
 }
 
-void TrackModel::searchFts(const QString& query)
+void TrackModel::showSearchResults(const QString& query, const QVector<Track>& firstPage,
+                                   int total)
+{
+    replaceTracks(firstPage);
+    m_playlistId  = -1;
+    m_totalCount  = qMax(total, int(firstPage.size()));
+    m_loadedCount = firstPage.size();
+    m_searchQuery = query;
+}
+
+void TrackModel::replaceTracks(const QVector<Track>& tracks)
 {
-    const QVector<Track> results = m_db->searchTracks(query);
-    loadFromDatabase(results);
+    m_playlistId  = -1;
+    m_totalCount  = tracks.size();
+    m_loadedCount = tracks.size();
+    m_searchQuery.clear();
+
+    if (m_tracks.size() > kMaxDiffRows || tracks.size() > kMaxDiffRows) {
+        beginResetModel();
+        m_tracks.assign(tracks.begin(), tracks.end());
+        rebuildRowIndex();
+        endResetModel();
+        return;
+    }
+
+    QSet<long long> incoming;
+    incoming.reserve(tracks.size());
+    for (const Track& t : tracks)
+        incoming.insert(t.id);
+
+    // Drop rows missing from the new list, one contiguous run at a time and
+    // bottom-up so the rows above keep their numbers.
+    for (int last = m_tracks.size() - 1; last >= 0; ) {
+        if (incoming.contains(m_tracks.id(last))) { --last; continue; }
+        int first = last;
+        while (first > 0 && !incoming.contains(m_tracks.id(first - 1)))
+            --first;
+        beginRemoveRows({}, first, last);
+        for (int r = first; r <= last; ++r)
+            m_rowById.remove(m_tracks.id(r));
+        m_tracks.remove(first, last - first + 1);
+        indexRows(first);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    QSet<long long> present;
+    present.reserve(m_tracks.size());
+    for (const long long id : m_tracks.idColumn())
+        present.insert(id);
+
+    // Every remaining row is in the new list. Walk it in order: rows already
+    // in place stay, rows further down move up, runs of new tracks go in.
+    int row = 0;
+    for (int i = 0; i < tracks.size(); ) {
+        if (present.contains(tracks[i].id)) {
+            if (m_tracks.id(row) != tracks[i].id) {
+                int from = row + 1;
+                while (m_tracks.id(from) != tracks[i].id)
+                    ++from;
+                beginMoveRows({}, from, from, {}, row);
+                m_tracks.move(from, row);
+                for (int r = row; r <= from; ++r)
+                    m_rowById.insert(m_tracks.id(r), r);
+                endMoveRows();
+            }
+            // Fresh column values, but the row's UI state stays with it.
+            Track t = tracks[i];
+            t.expanded     = m_tracks.expanded(row);
+            t.is_analyzing = m_tracks.isAnalyzing(row);
+            m_tracks.set(row, t);
+            ++row;
+            ++i;
+            continue;
+        }
+        int end = i + 1;
+        while (end < tracks.size() && !present.contains(tracks[end].id))
+            ++end;
+        const int count = end - i;
+        beginInsertRows({}, row, row + count - 1);
+        m_tracks.insert(row, tracks.begin() + i, tracks.begin() + end);
+        indexRows(row);
+        endInsertRows();
+        row += count;
+        i = end;
+    }
+
+    if (!m_tracks.isEmpty())
+        emit dataChanged(index(0, 0), index(m_tracks.size() - 1, columnCount() - 1));
 }
 
 void TrackModel::clear()
@@ -110,6 +207,8 @@ void TrackModel::clear()
     m_playlistId  = -1;
     m_totalCount  = 0;
     m_loadedCount = 0;
+    m_searchQuery.clear();
+    rebuildRowIndex();
     endResetModel();
 }
 
@@ -120,18 +219,36 @@ bool TrackModel::canFetchMore(const QModelIndex& /*parent*/) const
 
 void TrackModel::fetchMore(const QModelIndex& /*parent*/)
 {
-    if (m_playlistId < 0) return;
+    fetchPage(kBatchSize);
+}
+
+void TrackModel::fetchPage(int limit)
+{
+    if (m_playlistId < 0 && m_searchQuery.isEmpty()) return;
 
     const int remaining = m_totalCount - m_loadedCount;
-    const int batch     = qMin(kBatchSize, remaining);
+    const int batch     = qMin(limit, remaining);
     if (batch <= 0) return;
 
-    const QVector<Track> newTracks = m_db->loadTracks(m_playlistId, m_loadedCount, batch);
+    // Seek from the key of the last row fetched, not from m_loadedCount:
+    // rows added to the playlist meanwhile neither shift nor repeat pages.
+    // Search results are ordered by rank, which has no such key, so they
+    // page by offset.
+    const QVector<Track> newTracks = m_searchQuery.isEmpty()
+        ? m_db->loadTracksAfter(m_playlistId, m_pageTitle, m_pageId, batch)
+        : m_db->searchTracks(m_searchQuery, batch, m_loadedCount);
+    if (newTracks.size() < batch)
+        m_totalCount = m_loadedCount + newTracks.size();   // fewer rows than counted
     if (newTracks.isEmpty()) return;
 
+    m_pageTitle = QString::fromStdString(newTracks.last().title);
+    m_pageId    = newTracks.last().id;
+
     beginInsertRows({}, m_loadedCount, m_loadedCount + newTracks.size() - 1);
-    m_tracks.append(newTracks);
+    const int first = m_tracks.size();
+    m_tracks.insert(first, newTracks.begin(), newTracks.end());
     m_loadedCount += newTracks.size();
+    indexRows(first);
     endInsertRows();
 }
 
@@ -152,59 +269,50 @@ QVariant TrackModel::data(const QModelIndex& index, int role) const
     if (!index.isValid() || index.row() >= m_tracks.size())
         return {};
 
-    const Track& t = m_tracks.at(index.row());
+    const TrackRef t = m_tracks[index.row()];
 
     switch (role) {
     case Qt::DisplayRole:
-    case Qt::EditRole: {
-        switch (LibraryTableColumn::columnRole(index.column())) {
-        case LibraryTableColumn::Title:   return QString::fromStdString(t.title);
-        case LibraryTableColumn::Artist:  return QString::fromStdString(t.artist);
-        case LibraryTableColumn::Bpm:     return t.bpm > 0 ? QString::number(static_cast<int>(t.bpm)) : QString();
-        case LibraryTableColumn::Key:     return QString::fromStdString(t.key_sig);
-        case LibraryTableColumn::Time:    return QString::fromStdString(t.time);
-        case LibraryTableColumn::Format:   return QString::fromStdString(t.format.empty() ? "mp3" : t.format);
-        }
-        return {};
-        }
+    case Qt::EditRole:
+        return displayText(t, index.column());
 
     case ExpandedRole:
-        return t.expanded;
+        return t.expanded();
 
     case TrackIdRole:
-        return static_cast<qlonglong>(t.id);
+        return static_cast<qlonglong>(t.id());
 
     case RawTrackRole: {
         // Pack the whole track into a QVariant for the detail panel.
         // We use a QVariantMap since Track is not registered as QMetaType.
         QVariantMap m;
-        m[QStringLiteral("id")]         = static_cast<qlonglong>(t.id);
-        m[QStringLiteral("title")]      = QString::fromStdString(t.title);
-        m[QStringLiteral("artist")]     = QString::fromStdString(t.artist);
-        m[QStringLiteral("album")]      = QString::fromStdString(t.album);
-        m[QStringLiteral("genre")]      = QString::fromStdString(t.genre);
-        m[QStringLiteral("bpm")]        = t.bpm;
-        m[QStringLiteral("rating")]     = t.rating;
-        m[QStringLiteral("time")]       = QString::fromStdString(t.time);
-        m[QStringLiteral("key")]        = QString::fromStdString(t.key_sig);
-        m[QStringLiteral("added")]      = QString::fromStdString(t.date_added);
-        m[QStringLiteral("format")]     = QString::fromStdString(t.format);
-        m[QStringLiteral("has_aiff")]   = t.has_aiff;
-        m[QStringLiteral("filepath")]   = QString::fromStdString(t.filepath);
+        m[QStringLiteral("id")]         = static_cast<qlonglong>(t.id());
+        m[QStringLiteral("title")]      = QString::fromStdString(t.title());
+        m[QStringLiteral("artist")]     = QString::fromStdString(t.artist());
+        m[QStringLiteral("album")]      = QString::fromStdString(t.album());
+        m[QStringLiteral("genre")]      = QString::fromStdString(t.genre());
+        m[QStringLiteral("bpm")]        = t.bpm();
+        m[QStringLiteral("rating")]     = t.rating();
+        m[QStringLiteral("time")]       = QString::fromStdString(t.time());
+        m[QStringLiteral("key")]        = QString::fromStdString(t.keySig());
+        m[QStringLiteral("added")]      = QString::fromStdString(t.dateAdded());
+        m[QStringLiteral("format")]     = QString::fromStdString(t.format());
+        m[QStringLiteral("has_aiff")]   = t.hasAiff();
+        m[QStringLiteral("filepath")]   = QString::fromStdString(t.filepath());
         return m;
     }
 
     case HasAiffRole:
-        return t.has_aiff;
+        return t.hasAiff();
 
     case IsAnalyzingRole:
-        return t.is_analyzing;
+        return t.isAnalyzing();
 
     case ColorLabelRole:
-        return t.color_label;
+        return t.colorLabel();
 
     case PreparedRole:
-        return t.is_prepared;
+        return t.isPrepared();
 
     case Qt::TextAlignmentRole: {
         const auto colRole = LibraryTableColumn::columnRole(index.column());
@@ -222,15 +330,29 @@ QVariant TrackModel::data(const QModelIndex& index, int role) const
     }
 }
 
+QVariant TrackModel::displayText(const TrackRef& t, int column)
+{
+    switch (LibraryTableColumn::columnRole(column)) {
+    case LibraryTableColumn::Title:   return QString::fromStdString(t.title());
+    case LibraryTableColumn::Artist:  return QString::fromStdString(t.artist());
+    case LibraryTableColumn::Bpm:     return t.bpm() > 0 ? QString::number(static_cast<int>(t.bpm())) : QString();
+    case LibraryTableColumn::Key:     return QString::fromStdString(t.keySig());
+    case LibraryTableColumn::Time:    return QString::fromStdString(t.time());
+    case LibraryTableColumn::Format:   return QString::fromStdString(t.format().empty() ? "mp3" : t.format());
+    default:                          return {};
+    }
+}
+
 bool TrackModel::setData(const QModelIndex& index, const QVariant& value, int role)
 {
     if (!index.isValid() || index.row() >= m_tracks.size())
         return false;
 
-    Track& t = m_tracks[index.row()];
+    const int row = index.row();
 
     switch (role) {
     case Qt::EditRole: {
+        Track t = m_tracks.track(row);
         const QString str = value.toString().trimmed();
         switch (LibraryTableColumn::columnRole(index.column())) {
         case LibraryTableColumn::Title:
@@ -260,21 +382,22 @@ bool TrackModel::setData(const QModelIndex& index, const QVariant& value, int ro
             break;
         }
         // All column roles handled above; invalid column falls through and we still update.
+        m_tracks.set(row, t);
         if (t.id > 0)
-            m_db->updateSongMetadata(t.id, t);
+            m_db->writeBehind()->updateSongMetadata(t.id, t);
         emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
         return true;
     }
 
     case ExpandedRole:
-        t.expanded = value.toBool();
-        emit dataChanged(this->index(index.row(), 0),
-                         this->index(index.row(), LibraryTableColumn::columnCount() - 1),
+        m_tracks.setExpanded(row, value.toBool());
+        emit dataChanged(this->index(row, 0),
+                         this->index(row, LibraryTableColumn::columnCount() - 1),
                          {ExpandedRole, Qt::DecorationRole});
         return true;
 
     case HasAiffRole:
-        t.has_aiff = value.toBool();
+        m_tracks.setHasAiff(row, value.toBool());
         emit dataChanged(index, index, {HasAiffRole});
         return true;
 
@@ -312,7 +435,7 @@ Qt::ItemFlags TrackModel::flags(const QModelIndex& index) const
 void TrackModel::setFormat(int row, const QString& format)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    m_tracks[row].format = format.toStdString();
+    m_tracks.setFormat(row, format.toStdString());
     const QModelIndex idx = index(row, LibraryTableColumn::columnIndex(LibraryTableColumn::Format));
     emit dataChanged(idx, idx, {Qt::DisplayRole});
 }
@@ -320,14 +443,14 @@ void TrackModel::setFormat(int row, const QString& format)
 void TrackModel::setHasAiff(int row, bool hasAiff)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    m_tracks[row].has_aiff = hasAiff;
+    m_tracks.setHasAiff(row, hasAiff);
     emit dataChanged(index(row, 0), index(row, LibraryTableColumn::columnCount() - 1), {HasAiffRole});
 }
 
 void TrackModel::setExpanded(int row, bool expanded)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    m_tracks[row].expanded = expanded;
+    m_tracks.setExpanded(row, expanded);
     // Emit DecorationRole (not DisplayRole) so QSortFilterProxyModel does not re-sort.
     // The view repaints on any role; delegates read ExpandedRole directly.
     emit dataChanged(index(row, 0), index(row, LibraryTableColumn::columnCount() - 1), {ExpandedRole, Qt::DecorationRole});
@@ -336,32 +459,51 @@ void TrackModel::setExpanded(int row, bool expanded)
 void TrackModel::setColorLabel(int row, int colorLabel)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    Track& t = m_tracks[row];
-    t.color_label = colorLabel;
-    if (t.id > 0)
-        m_db->updateSongColorLabel(t.id, colorLabel);
+    m_tracks.setColorLabel(row, colorLabel);
+    const long long id = m_tracks.id(row);
+    if (id > 0)
+        m_db->writeBehind()->updateSongColorLabel(id, colorLabel);
     const QModelIndex idx = index(row, LibraryTableColumn::columnIndex(LibraryTableColumn::Color));
     emit dataChanged(idx, idx, {ColorLabelRole, Qt::DecorationRole});
 }
 
-int TrackModel::rowForId(long long id) const
+QVector<int> TrackModel::rowsForIds(const QVector<long long>& ids) const
+{
+    QVector<int> rows;
+    rows.reserve(ids.size());
+    for (const long long id : ids)
+        rows.append(rowForId(id));
+    return rows;
+}
+
+void TrackModel::indexRows(int first)
+{
+    for (int r = first; r < m_tracks.size(); ++r)
+        m_rowById.insert(m_tracks.id(r), r);
+}
+
+void TrackModel::rebuildRowIndex()
 {
-    for (int i = 0; i < m_tracks.size(); ++i)
-        if (m_tracks[i].id == id) return i;
-    return -1;
+    m_rowById.clear();
+    m_rowById.reserve(m_tracks.size());
+    indexRows(0);
 }
 
 void TrackModel::setIsAnalyzing(int row, bool analyzing)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    m_tracks[row].is_analyzing = analyzing;
+    m_tracks.setAnalyzing(row, analyzing);
+    if (analyzing)
+        m_analyzingIds.insert(m_tracks.id(row));
+    else
+        m_analyzingIds.remove(m_tracks.id(row));
     emit dataChanged(index(row, 0), index(row, columnCount() - 1), {IsAnalyzingRole});
 }
 
 void TrackModel::setPrepared(int row, bool prepared)
 {
     if (row < 0 || row >= m_tracks.size()) return;
-    m_tracks[row].is_prepared = prepared;
+    m_tracks.setPrepared(row, prepared);
     const QModelIndex idx = index(row, LibraryTableColumn::columnIndex(LibraryTableColumn::Prepared));
     emit dataChanged(idx, idx, {PreparedRole, Qt::DecorationRole});
 }
@@ -371,17 +513,80 @@ void TrackModel::updateTrackMetadata(const Track& updated)
     const int row = rowForId(updated.id);
     if (row < 0) return;
 
-    Track& t = m_tracks[row];
+    mergeMetadata(row, updated);
+    emit dataChanged(index(row, 0), index(row, columnCount() - 1),
+                     {Qt::DisplayRole, IsAnalyzingRole});
+}
+
+void TrackModel::updateTracksMetadata(const QVector<Track>& updated)
+{
+    QVector<int> rows;
+    rows.reserve(updated.size());
+    for (const Track& u : updated) {
+        const int row = rowForId(u.id);
+        if (row < 0) continue;
+        mergeMetadata(row, u);
+        rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    emitRowRuns(rows, {Qt::DisplayRole, IsAnalyzingRole});
+}
+
+void TrackModel::emitRowRuns(const QVector<int>& rows, const QVector<int>& roles)
+{
+    for (int i = 0; i < rows.size(); ) {
+        int end = i + 1;
+        while (end < rows.size() && rows[end] == rows[end - 1] + 1)
+            ++end;
+        emit dataChanged(index(rows[i], 0), index(rows[end - 1], columnCount() - 1), roles);
+        i = end;
+    }
+}
+
+void TrackModel::mergeMetadata(int row, const Track& updated)
+{
+    Track t = m_tracks.track(row);
     // Merge: only overwrite if the new value is more informative
     if (updated.bpm > 0.0)        t.bpm     = updated.bpm;
     if (!updated.key_sig.empty()) t.key_sig = updated.key_sig;
     if (updated.bitrate > 0)      t.bitrate = updated.bitrate;
     if (!updated.time.empty())    t.time    = updated.time;
     t.is_analyzing = false;
+    m_tracks.set(row, t);
+    m_analyzingIds.remove(t.id);
 
     if (t.id > 0)
-        m_db->updateSongMetadata(t.id, t);
+        m_db->writeBehind()->updateSongMetadata(t.id, t);
+}
 
-    emit dataChanged(index(row, 0), index(row, columnCount() - 1),
-                     {Qt::DisplayRole, IsAnalyzingRole});
+QVector<Track> TrackModel::analyzingTracks() const
+{
+    QVector<int> rows;
+    for (const long long id : m_analyzingIds) {
+        const int row = rowForId(id);
+        if (row >= 0 && m_tracks.isAnalyzing(row))
+            rows.append(row);
+    }
+    std::sort(rows.begin(), rows.end());   // model order, as the table shows them
+
+    QVector<Track> result;
+    result.reserve(rows.size());
+    for (const int row : std::as_const(rows))
+        result.append(m_tracks.track(row));
+    return result;
+}
+
+void TrackModel::clearAnalyzing()
+{
+    QVector<int> rows;
+    for (const long long id : std::as_const(m_analyzingIds)) {
+        const int row = rowForId(id);
+        if (row < 0 || !m_tracks.isAnalyzing(row)) continue;
+        m_tracks.setAnalyzing(row, false);
+        rows.append(row);
+    }
+    m_analyzingIds.clear();
+    std::sort(rows.begin(), rows.end());
+    emitRowRuns(rows, {IsAnalyzingRole});
 }
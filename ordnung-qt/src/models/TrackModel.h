@@ -1,10 +1,13 @@
 #pragma once
 
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
 #include <QVector>
 #include <QString>
 
 #include "core/Track.h"
+#include "core/TrackStore.h"
 
 class Database;
 
@@ -33,15 +36,25 @@ public:
     // Use on startup to show the library instantly.
     void loadFromDatabase(const QVector<Track>& tracks);
 
-    // Ingest new scan results: runs syncFromDisk for each track and appends
+    // Ingest new scan results: merges them with syncFromDiskBatch and appends
     // the resulting rows to the existing model without resetting it.
     void ingestAndAppend(const QVector<Track>& scanTracks);
 
     // Load tracks directly from a pre-scanned list (filesystem-based library).
     void loadFromFiles(const QVector<Track>& tracks);
 
-    // Replace current track list with FTS5 search results.
-    void searchFts(const QString& query);
+    // Show the first page of FTS5 results for query; total is the full match
+    // count and fetchMore pages in the rest. Goes through replaceTracks, so
+    // refining a query updates the rows on screen instead of resetting them.
+    void showSearchResults(const QString& query, const QVector<Track>& firstPage, int total);
+
+    // Query whose results the model holds, or empty when it shows anything else.
+    const QString& searchQuery() const { return m_searchQuery; }
+
+    // Swap in tracks as row removals, moves and inserts keyed by song id
+    // rather than a model reset; rows present in both lists keep their
+    // selection and expanded state. Large models fall back to a reset.
+    void replaceTracks(const QVector<Track>& tracks);
 
     // Clear all tracks.
     void clear();
@@ -54,12 +67,17 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
+    // DisplayRole text for one cell; shared with VirtualTrackModel.
+    static QVariant displayText(const TrackRef& t, int column);
+
     // Lazy loading
     bool canFetchMore(const QModelIndex& parent) const override;
     void fetchMore(const QModelIndex& parent) override;
 
-    // Access all currently loaded tracks (for bulk operations).
-    const QVector<Track>& tracks() const { return m_tracks; }
+    // Currently loaded tracks, by column. Hand out store()[row] handles
+    // rather than copies; track(row) builds a full Track when one is needed.
+    const TrackStore& store() const { return m_tracks; }
+    Track track(int row) const { return m_tracks.track(row); }
 
     // Direct mutations (called by commands).
     void setFormat(int row, const QString& format);
@@ -73,17 +91,50 @@ public:
     // Clears is_analyzing, persists to DB, and emits dataChanged.
     void updateTrackMetadata(const Track& updated);
 
-    // Find row by song id.
-    int rowForId(long long id) const;
+    // Batch form of updateTrackMetadata: one dataChanged per run of adjacent
+    // rows touched, so scattered rows do not re-notify everything between them.
+    void updateTracksMetadata(const QVector<Track>& updated);
+
+    // Tracks still waiting for background analysis, and clearing that mark
+    // (e.g. after a cancelled run). Neither walks the whole model.
+    QVector<Track> analyzingTracks() const;
+    void clearAnalyzing();
+
+    // Find row by song id (-1 if absent). Constant time: m_rowById is kept in
+    // step with every reset, append, removal, insert and move.
+    int rowForId(long long id) const { return m_rowById.value(id, -1); }
+
+    // rowForId for each id, in order.
+    QVector<int> rowsForIds(const QVector<long long>& ids) const;
 
     long long playlistId() const { return m_playlistId; }
 
+    // Rows per fetchMore page, for playlists and search results alike.
+    static constexpr int kBatchSize = 200;
+
 private:
+    void fetchPage(int limit);
+
+    // Point m_rowById at the ids of rows first..end of m_tracks.
+    void indexRows(int first);
+    void rebuildRowIndex();
+    // Merge analysis results into row without notifying views.
+    void mergeMetadata(int row, const Track& updated);
+    // dataChanged for each run of consecutive rows (sorted, no duplicates).
+    void emitRowRuns(const QVector<int>& rows, const QVector<int>& roles);
+
     Database*     m_db;
-    QVector<Track> m_tracks;
+    TrackStore    m_tracks;
     long long     m_playlistId  = -1;
     int           m_totalCount  = 0;
     int           m_loadedCount = 0;
+    QString       m_pageTitle;          // (title, id) key of the last fetched row
+    long long     m_pageId      = 0;
+    QString       m_searchQuery;        // non-empty: rows are ranked FTS5 results
 
-    static constexpr int kBatchSize = 200;
+    QHash<long long, int> m_rowById;
+    QSet<long long>       m_analyzingIds; // may hold ids no longer in the model
+
+    // Above this many rows a diff costs more than a reset (see replaceTracks).
+    static constexpr int kMaxDiffRows = 2000;
 };
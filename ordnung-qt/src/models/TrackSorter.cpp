@@ -0,0 +1,284 @@
+#include "TrackSorter.h"
+
+#include "core/TrackStore.h"
+#include "views/table/LibraryTableColumn.h"
+
+#include <QLocale>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// Rows per task when keys are built or rows sorted in parallel.
+constexpr int kParallelChunk = 8192;
+
+// fn(from, to) over [first, last], split across the global thread pool when
+// the range is large. The caller blocks until every chunk is done.
+template<typename Fn>
+void forEachRowChunk(int first, int last, Fn fn)
+{
+    if (last - first + 1 <= kParallelChunk) {
+        fn(first, last);
+        return;
+    }
+    QVector<int> starts;
+    for (int from = first; from <= last; from += kParallelChunk)
+        starts.append(from);
+    QtConcurrent::blockingMap(starts, [&](int from) {
+        fn(from, qMin(from + kParallelChunk - 1, last));
+    });
+}
+
+// "M:SS" or "H:MM:SS" in seconds; 0 when empty or malformed.
+double durationSeconds(const std::string& time)
+{
+    double seconds = 0.0;
+    int    field   = 0;
+    bool   digits  = false;
+    for (const char c : time) {
+        if (c >= '0' && c <= '9') {
+            field  = field * 10 + (c - '0');
+            digits = true;
+        } else if (c == ':' && digits) {
+            seconds = seconds * 60 + field;
+            field   = 0;
+            digits  = false;
+        } else {
+            return 0.0;
+        }
+    }
+    return digits ? seconds * 60 + field : 0.0;
+}
+
+bool isTextColumn(LibraryTableColumn::ColumnRole role)
+{
+    switch (role) {
+    case LibraryTableColumn::Title:
+    case LibraryTableColumn::Artist:
+    case LibraryTableColumn::Key:
+    case LibraryTableColumn::Format:
+    case LibraryTableColumn::Comment:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+TrackSorter::TrackSorter()
+    : m_collator(QLocale())
+{
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+    m_collator.setNumericMode(true);
+}
+
+void TrackSorter::setColumns(const QVector<SortColumn>& columns)
+{
+    m_columns = columns;
+    for (auto it = m_keys.begin(); it != m_keys.end(); ) {
+        const bool used = std::any_of(columns.begin(), columns.end(),
+            [&](const SortColumn& c) { return c.column == it->first; });
+        it = used ? std::next(it) : m_keys.erase(it);
+    }
+    m_reversed.clear();
+    for (const SortColumn& c : columns)
+        m_reversed.push_back(c.order != columns.first().order);
+    m_active.clear();
+    m_rank.clear();
+}
+
+void TrackSorter::buildKeys(const TrackStore& store)
+{
+    m_active.clear();
+    for (const SortColumn& c : std::as_const(m_columns)) {
+        auto it = m_keys.find(c.column);
+        if (it == m_keys.end()) {
+            it = m_keys.emplace(c.column, Keys()).first;
+            Keys& keys = it->second;
+            keys.text = isTextColumn(LibraryTableColumn::columnRole(c.column));
+            if (keys.text)
+                keys.texts.fill(m_collator.sortKey(QString()), store.size());
+            else
+                keys.numbers.assign(size_t(store.size()), 0.0);
+            if (store.size() > 0)
+                fillKeys(store, c.column, keys, 0, store.size() - 1);
+        }
+        m_active.push_back(&it->second);
+    }
+}
+
+void TrackSorter::fillKeys(const TrackStore& store, int column, Keys& keys,
+                           int first, int last) const
+{
+    const LibraryTableColumn::ColumnRole role = LibraryTableColumn::columnRole(column);
+
+    if (keys.text) {
+        // Writes go through the raw pointer: detach once here, not per thread.
+        QCollatorSortKey* texts = keys.texts.data();
+        forEachRowChunk(first, last, [&](int from, int to) {
+            // A copy would share m_collator's private data; build one per chunk.
+            QCollator collator(m_collator.locale());
+            collator.setCaseSensitivity(m_collator.caseSensitivity());
+            collator.setNumericMode(m_collator.numericMode());
+            for (int r = from; r <= to; ++r) {
+                const std::string* text = nullptr;
+                switch (role) {
+                case LibraryTableColumn::Title:   text = &store.title(r);   break;
+                case LibraryTableColumn::Artist:  text = &store.artist(r);  break;
+                case LibraryTableColumn::Key:     text = &store.keySig(r);  break;
+                case LibraryTableColumn::Comment: text = &store.comment(r); break;
+                default:                          text = &store.format(r);  break;
+                }
+                QString value = QString::fromStdString(*text);
+                if (role == LibraryTableColumn::Format && value.isEmpty())
+                    value = QStringLiteral("mp3");   // as TrackModel::data shows it
+                texts[r] = collator.sortKey(value);
+            }
+        });
+        return;
+    }
+
+    forEachRowChunk(first, last, [&](int from, int to) {
+        for (int r = from; r <= to; ++r) {
+            double value = 0.0;
+            switch (role) {
+            case LibraryTableColumn::Bpm:      value = store.bpm(r);                   break;
+            case LibraryTableColumn::Time:     value = durationSeconds(store.time(r)); break;
+            case LibraryTableColumn::Color:    value = store.colorLabel(r);            break;
+            case LibraryTableColumn::Prepared: value = store.isPrepared(r) ? 1 : 0;    break;
+            case LibraryTableColumn::Bitrate:  value = store.bitrate(r);               break;
+            default:                                                                   break;
+            }
+            keys.numbers[size_t(r)] = value;
+        }
+    });
+}
+
+int TrackSorter::rowCount() const
+{
+    if (m_active.empty()) return 0;
+    const Keys* keys = m_active.front();
+    return keys->text ? int(keys->texts.size()) : int(keys->numbers.size());
+}
+
+int TrackSorter::compare(int a, int b) const
+{
+    if (!m_rank.empty())
+        return m_rank[size_t(a)] - m_rank[size_t(b)];
+
+    for (size_t i = 0; i < m_active.size(); ++i) {
+        const Keys* keys = m_active[i];
+        int cmp;
+        if (keys->text) {
+            cmp = keys->texts.at(a).compare(keys->texts.at(b));
+        } else {
+            const double x = keys->numbers[size_t(a)], y = keys->numbers[size_t(b)];
+            cmp = x < y ? -1 : (y < x ? 1 : 0);
+        }
+        if (cmp != 0)
+            return m_reversed[i] ? -cmp : cmp;
+    }
+    return 0;
+}
+
+void TrackSorter::rank()
+{
+    m_rank.clear();
+    const int rows = rowCount();
+    if (rows == 0) return;
+
+    std::vector<int> order(size_t(rows));
+    std::iota(order.begin(), order.end(), 0);
+    const auto less = [this](int a, int b) { return compare(a, b) < 0; };
+
+    // Sort fixed-size runs in parallel, then merge neighbouring runs pairwise,
+    // doubling the run length each round. Both steps are stable, and so is the
+    // whole.
+    forEachRowChunk(0, rows - 1, [&](int from, int to) {
+        std::stable_sort(order.begin() + from, order.begin() + to + 1, less);
+    });
+    for (int width = kParallelChunk; width < rows; width *= 2) {
+        QVector<int> starts;
+        for (int from = 0; from + width < rows; from += 2 * width)
+            starts.append(from);
+        QtConcurrent::blockingMap(starts, [&](int from) {
+            const int mid = from + width;
+            const int end = qMin(from + 2 * width, rows);
+            std::inplace_merge(order.begin() + from, order.begin() + mid,
+                               order.begin() + end, less);
+        });
+    }
+
+    // Rows with equal keys share a rank, so the proxy's stable sort keeps
+    // them in model order whichever way it runs.
+    std::vector<int> rank(size_t(rows));
+    int current = 0;
+    for (int i = 0; i < rows; ++i) {
+        if (i > 0 && compare(order[size_t(i - 1)], order[size_t(i)]) != 0)
+            current = i;
+        rank[size_t(order[size_t(i)])] = current;
+    }
+    m_rank = std::move(rank);
+}
+
+// ── Key maintenance ──────────────────────────────────────────────────────────
+
+void TrackSorter::clear()
+{
+    m_keys.clear();
+    m_active.clear();
+    m_rank.clear();
+}
+
+void TrackSorter::updateRows(const TrackStore& store, int first, int last)
+{
+    m_rank.clear();
+    for (auto& [column, keys] : m_keys)
+        fillKeys(store, column, keys, first, last);
+}
+
+void TrackSorter::insertRows(const TrackStore& store, int first, int last)
+{
+    m_rank.clear();
+    const int count = last - first + 1;
+    for (auto& [column, keys] : m_keys) {
+        if (keys.text)
+            keys.texts.insert(first, count, m_collator.sortKey(QString()));
+        else
+            keys.numbers.insert(keys.numbers.begin() + first, size_t(count), 0.0);
+        fillKeys(store, column, keys, first, last);
+    }
+}
+
+void TrackSorter::removeRows(int first, int last)
+{
+    m_rank.clear();
+    const int count = last - first + 1;
+    for (auto& [column, keys] : m_keys) {
+        if (keys.text)
+            keys.texts.remove(first, count);
+        else
+            keys.numbers.erase(keys.numbers.begin() + first,
+                               keys.numbers.begin() + last + 1);
+    }
+}
+
+void TrackSorter::moveRows(int first, int last, int dest)
+{
+    m_rank.clear();
+    auto move = [=](auto begin) {
+        if (dest > last)
+            std::rotate(begin + first, begin + last + 1, begin + dest);
+        else
+            std::rotate(begin + dest, begin + first, begin + last + 1);
+    };
+    for (auto& [column, keys] : m_keys) {
+        if (keys.text)
+            move(keys.texts.begin());
+        else
+            move(keys.numbers.begin());
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QVector>
+
+#include <unordered_map>
+#include <vector>
+
+class TrackStore;
+
+// TrackSorter — the library table's sort engine.
+//
+// Sorting goes by one or more columns (e.g. key, then BPM) over typed keys
+// built once per column rather than display strings per comparison: BPM,
+// time (in seconds), color, prepared and bitrate compare as numbers; title,
+// artist, key, format and comment through locale collation keys with
+// numeric ordering, so "2A" sorts before "10A". Keys are kept in step with
+// the model by the update/insert/remove/move calls, which the proxy forwards
+// from the source model's row signals.
+//
+// rank() orders every row with a parallel stable merge sort and records each
+// row's position, so the proxy's own sort then only compares integers. Any
+// row change drops the ranks; compare() falls back to the keys until the
+// next rank().
+class TrackSorter
+{
+public:
+    struct SortColumn {
+        int           column = 0;
+        Qt::SortOrder order  = Qt::AscendingOrder;
+    };
+
+    TrackSorter();
+
+    // Columns in priority order; keys for columns no longer used are dropped.
+    void setColumns(const QVector<SortColumn>& columns);
+    const QVector<SortColumn>& columns() const { return m_columns; }
+    bool isEmpty() const { return m_columns.isEmpty(); }
+
+    // Build keys for any sort column that has none yet.
+    void buildKeys(const TrackStore& store);
+    // Parallel stable sort of all rows; fills the rank table.
+    void rank();
+
+    // <0, 0 or >0 as row a sorts before, with or after row b. Directions are
+    // relative to the first column's order, which QSortFilterProxyModel
+    // applies itself.
+    int compare(int a, int b) const;
+
+    // ── Key maintenance (source model row signals) ──────────────────────────
+    void clear();
+    void updateRows(const TrackStore& store, int first, int last);
+    void insertRows(const TrackStore& store, int first, int last);
+    void removeRows(int first, int last);
+    void moveRows(int first, int last, int dest);
+
+private:
+    struct Keys {
+        bool                      text = false;
+        std::vector<double>       numbers;
+        QVector<QCollatorSortKey> texts;
+    };
+
+    void fillKeys(const TrackStore& store, int column, Keys& keys, int first, int last) const;
+    int  rowCount() const;
+
+    QVector<SortColumn>           m_columns;
+    std::unordered_map<int, Keys> m_keys;      // by column; references stay valid
+    std::vector<const Keys*>      m_active;    // m_keys for m_columns, in order
+    std::vector<char>             m_reversed;  // per m_columns entry: opposite of the first
+    std::vector<int>              m_rank;      // by source row; empty = stale
+    QCollator                     m_collator;
+};
@@ -0,0 +1,49 @@
+#include "TrackUpdateCoalescer.h"
+#include "TrackModel.h"
+
+#include <QMutexLocker>
+#include <QTimer>
+#include <QVector>
+
+TrackUpdateCoalescer::TrackUpdateCoalescer(TrackModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kFrameMs);
+    connect(m_timer, &QTimer::timeout, this, &TrackUpdateCoalescer::flush);
+}
+
+void TrackUpdateCoalescer::post(const Track& updated)
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        m_pending.insert(updated.id, updated);
+        if (m_scheduled) return;
+        m_scheduled = true;
+    }
+    // The timer belongs to the GUI thread; start it there.
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_timer->isActive())
+            m_timer->start();
+    }, Qt::QueuedConnection);
+}
+
+void TrackUpdateCoalescer::flush()
+{
+    QHash<long long, Track> pending;
+    {
+        QMutexLocker lock(&m_mutex);
+        pending.swap(m_pending);
+        m_scheduled = false;
+    }
+    m_timer->stop();
+    if (pending.isEmpty()) return;
+
+    QVector<Track> batch;
+    batch.reserve(pending.size());
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+        batch.append(it.value());
+    m_model->updateTracksMetadata(batch);
+}
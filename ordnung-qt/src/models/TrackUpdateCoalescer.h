@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+
+#include "core/Track.h"
+
+class TrackModel;
+class QTimer;
+
+// TrackUpdateCoalescer — funnels per-track results from background work into
+// TrackModel at most once per frame.
+//
+// Analysis reports one track at a time from a worker thread. Applied one by
+// one, each result was its own queued event, its own dataChanged and its own
+// proxy re-filter and re-sort. post() is thread-safe and only records the
+// result (a later one for the same track replaces an earlier one); the GUI
+// thread applies everything pending in one TrackModel::updateTracksMetadata
+// call, which notifies views once per run of adjacent rows.
+class TrackUpdateCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrackUpdateCoalescer(TrackModel* model, QObject* parent = nullptr);
+
+    // Any thread.
+    void post(const Track& updated);
+
+    // GUI thread: apply everything pending now, e.g. before reading the model.
+    void flush();
+
+    static constexpr int kFrameMs = 16;
+
+private:
+    TrackModel* m_model;
+    QTimer*     m_timer;
+
+    QMutex                  m_mutex;
+    QHash<long long, Track> m_pending;      // song id -> latest result; guarded by m_mutex
+    bool                    m_scheduled = false;
+};
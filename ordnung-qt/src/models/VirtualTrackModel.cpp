@@ -0,0 +1,245 @@
+#include "VirtualTrackModel.h"
+#include "TrackModel.h"
+#include "services/DatabasePool.h"
+#include "views/table/LibraryTableColumn.h"
+
+#include <QDebug>
+#include <QHash>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// SQL sort field for a table column; false when it has none.
+bool sortField(int column, SongOrder::Field& field)
+{
+    switch (LibraryTableColumn::columnRole(column)) {
+    case LibraryTableColumn::Title:    field = SongOrder::Title;      return true;
+    case LibraryTableColumn::Artist:   field = SongOrder::Artist;     return true;
+    case LibraryTableColumn::Bpm:      field = SongOrder::Bpm;        return true;
+    case LibraryTableColumn::Key:      field = SongOrder::KeySig;     return true;
+    case LibraryTableColumn::Time:     field = SongOrder::Duration;   return true;
+    case LibraryTableColumn::Format:   field = SongOrder::Format;     return true;
+    case LibraryTableColumn::Color:    field = SongOrder::ColorLabel; return true;
+    case LibraryTableColumn::Prepared: field = SongOrder::Prepared;   return true;
+    case LibraryTableColumn::Bitrate:  field = SongOrder::Bitrate;    return true;
+    case LibraryTableColumn::Comment:  field = SongOrder::Comment;    return true;
+    }
+    return false;
+}
+
+} // namespace
+
+VirtualTrackModel::VirtualTrackModel(Database* db, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_db(db)
+    , m_idsWatcher(new QFutureWatcher<QVector<long long>>(this))
+    , m_channel(QStringLiteral("virtual.ids.%1").arg(quintptr(this), 0, 16))
+{
+    m_pages.setMaxCost(kMaxPages);
+    connect(m_idsWatcher, &QFutureWatcher<QVector<long long>>::finished,
+            this, &VirtualTrackModel::onIdsRead);
+}
+
+void VirtualTrackModel::setQuery(const TrackQuery& query, const QString& folderPrefix)
+{
+    m_query        = query;
+    m_folderPrefix = folderPrefix;
+    reloadIds(true);
+}
+
+void VirtualTrackModel::refresh()
+{
+    reloadIds(true);
+}
+
+void VirtualTrackModel::reloadIds(bool reset)
+{
+    // A sort superseded by a new query still owes the reset.
+    m_resetPending = m_resetPending || reset;
+
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        // Standalone Database (no pool): read synchronously.
+        applyIds(m_db->findTrackIds(m_query, m_folderPrefix, m_order),
+                 std::exchange(m_resetPending, false));
+        return;
+    }
+    m_idsWatcher->setFuture(pool->read<QVector<long long>>(m_channel,
+        [query = m_query, folder = m_folderPrefix, order = m_order](Database& db) {
+            return db.findTrackIds(query, folder, order);
+        }));
+}
+
+void VirtualTrackModel::onIdsRead()
+{
+    const QFuture<QVector<long long>> future = m_idsWatcher->future();
+    if (future.isCanceled() || future.resultCount() == 0)
+        return;   // superseded; the newer read applies
+    applyIds(future.result(), std::exchange(m_resetPending, false));
+}
+
+void VirtualTrackModel::applyIds(const QVector<long long>& ids, bool reset)
+{
+    // A layout change may only move rows; a different row count (a track
+    // added or deleted since the last read) needs a reset.
+    if (reset || size_t(ids.size()) != m_ids.size()) {
+        beginResetModel();
+        m_pages.clear();
+        m_ids.assign(ids.begin(), ids.end());
+        endResetModel();
+        qInfo() << "VirtualTrackModel:" << int(m_ids.size()) << "tracks";
+        emit idsLoaded(int(m_ids.size()));
+        return;
+    }
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    // Remember which track each persistent index points at; only those ids
+    // are looked up in the new order.
+    const QModelIndexList persistent = persistentIndexList();
+    QVector<long long> persistentIds;
+    persistentIds.reserve(persistent.size());
+    QHash<long long, int> newRow;
+    for (const QModelIndex& idx : persistent) {
+        persistentIds.append(m_ids[size_t(idx.row())]);
+        newRow.insert(persistentIds.last(), -1);
+    }
+
+    m_pages.clear();
+    m_ids.assign(ids.begin(), ids.end());
+
+    if (!newRow.isEmpty()) {
+        for (size_t r = 0; r < m_ids.size(); ++r) {
+            const auto it = newRow.find(m_ids[r]);
+            if (it != newRow.end())
+                it.value() = int(r);
+        }
+    }
+    QModelIndexList to;
+    to.reserve(persistent.size());
+    for (int i = 0; i < persistent.size(); ++i) {
+        const int row = newRow.value(persistentIds[i], -1);
+        to.append(row < 0 ? QModelIndex() : index(row, persistent[i].column()));
+    }
+    changePersistentIndexList(persistent, to);
+
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+    emit idsLoaded(int(m_ids.size()));
+}
+
+void VirtualTrackModel::sort(int column, Qt::SortOrder order)
+{
+    SongOrder::Field field;
+    if (column < 0 || !sortField(column, field)) {
+        setSortOrder({});
+        return;
+    }
+    setSortOrder({{field, order == Qt::DescendingOrder}});
+}
+
+void VirtualTrackModel::setSortOrder(const QVector<SongOrder>& order)
+{
+    m_order = order;
+    reloadIds(false);
+}
+
+int VirtualTrackModel::rowForId(long long id) const
+{
+    const auto it = std::find(m_ids.begin(), m_ids.end(), id);
+    return it == m_ids.end() ? -1 : int(it - m_ids.begin());
+}
+
+const TrackStore* VirtualTrackModel::page(int row) const
+{
+    const int pageIndex = row / kPageSize;
+    if (const TrackStore* cached = m_pages.object(pageIndex))
+        return cached;
+
+    const int first = pageIndex * kPageSize;
+    const int last  = qMin(first + kPageSize, int(m_ids.size()));
+    const QVector<long long> ids(m_ids.begin() + first, m_ids.begin() + last);
+    const QVector<Track> rows = m_db->loadSongsByIds(ids);
+
+    // Keep the page aligned with the id list: a track deleted since the ids
+    // were read becomes a blank row instead of shifting the rest up.
+    auto* store = new TrackStore;
+    store->reserve(ids.size());
+    int next = 0;
+    for (const long long id : ids) {
+        if (next < rows.size() && rows[next].id == id) {
+            store->append(rows[next++]);
+        } else {
+            Track missing;
+            missing.id = id;
+            store->append(missing);
+        }
+    }
+    m_pages.insert(pageIndex, store);
+    return store;
+}
+
+Track VirtualTrackModel::track(int row) const
+{
+    if (row < 0 || size_t(row) >= m_ids.size())
+        return Track();
+    return page(row)->track(row % kPageSize);
+}
+
+int VirtualTrackModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return int(m_ids.size());
+}
+
+int VirtualTrackModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return LibraryTableColumn::columnCount();
+}
+
+QVariant VirtualTrackModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || size_t(index.row()) >= m_ids.size())
+        return {};
+
+    if (role == TrackModel::TrackIdRole)   // answered from the id list, no page load
+        return static_cast<qlonglong>(m_ids[size_t(index.row())]);
+
+    if (role == Qt::TextAlignmentRole) {
+        switch (LibraryTableColumn::columnRole(index.column())) {
+        case LibraryTableColumn::Bpm:
+        case LibraryTableColumn::Key:
+        case LibraryTableColumn::Time:
+        case LibraryTableColumn::Format: return Qt::AlignCenter;
+        default:                         return QVariant();
+        }
+    }
+
+    const TrackRef t = (*page(index.row()))[index.row() % kPageSize];
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:                  return TrackModel::displayText(t, index.column());
+    case TrackModel::ExpandedRole:      return false;
+    case TrackModel::HasAiffRole:       return t.hasAiff();
+    case TrackModel::IsAnalyzingRole:   return false;
+    case TrackModel::ColorLabelRole:    return t.colorLabel();
+    case TrackModel::PreparedRole:      return t.isPrepared();
+    default:                            return {};
+    }
+}
+
+QVariant VirtualTrackModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal) return {};
+    if (role == Qt::DisplayRole && section >= 0 && section < LibraryTableColumn::columnCount())
+        return LibraryTableColumn::headerText(section);
+    return {};
+}
+
+Qt::ItemFlags VirtualTrackModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
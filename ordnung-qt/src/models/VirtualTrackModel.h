@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QString>
+#include <QVector>
+
+#include <vector>
+
+#include "core/TrackStore.h"
+#include "services/Database.h"
+#include "services/TrackQuery.h"
+
+// VirtualTrackModel — a read-only track table over SQLite that never holds
+// the whole result set.
+//
+// TrackModel materializes every row, which is right for a working library
+// but caps memory and load time on very large archives. This model keeps only
+// the ordered song ids of its query (8 bytes a row) and loads full rows a
+// page at a time when a view asks for them, keeping the most recently used
+// pages in an LRU cache. Filtering (setQuery) and sorting (sort) run in SQL
+// and re-fetch the id list, so opening or re-sorting a million-track archive
+// reads one indexed id column rather than every row. With a DatabasePool the
+// id list is read on a reader thread; the model keeps showing the previous
+// list until the new one lands, and a newer request supersedes a pending one.
+//
+// Exposes the same columns and TrackModel roles, so the library delegates can
+// paint it. Rows are not editable.
+class VirtualTrackModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit VirtualTrackModel(Database* db, QObject* parent = nullptr);
+
+    // Show the tracks matching query, optionally only those under folderPrefix
+    // (an empty query shows every track). Resets the model once the ids arrive.
+    void setQuery(const TrackQuery& query, const QString& folderPrefix = QString());
+
+    // Re-run the current query, e.g. after writes elsewhere; drops cached pages.
+    void refresh();
+
+    // QAbstractTableModel interface
+    int      rowCount(const QModelIndex& parent = {}) const override;
+    int      columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    // ORDER BY the column in SQL. Selections and other persistent indexes
+    // follow their tracks to the new rows.
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Several sort columns at once, highest priority first.
+    void setSortOrder(const QVector<SongOrder>& order);
+
+    long long idAt(int row) const { return m_ids[size_t(row)]; }
+    // Linear scan of the id list; -1 if absent.
+    int rowForId(long long id) const;
+    // Full row; loads its page if needed.
+    Track track(int row) const;
+
+    static constexpr int kPageSize = 256;
+    static constexpr int kMaxPages = 64;     // ~16k rows held at most
+
+signals:
+    // A new id list is in place (after setQuery, refresh or a sort).
+    void idsLoaded(int rows);
+
+private:
+    // Page holding row, loaded on a miss.
+    const TrackStore* page(int row) const;
+    // Starts reading the id list for the current query and order; reset
+    // says whether applying it resets the model or only re-sorts it.
+    void reloadIds(bool reset);
+    void onIdsRead();
+    void applyIds(const QVector<long long>& ids, bool reset);
+
+    Database*          m_db;
+    TrackQuery         m_query;
+    QString            m_folderPrefix;
+    QVector<SongOrder> m_order;
+
+    QFutureWatcher<QVector<long long>>* m_idsWatcher;
+    QString                            m_channel;        // DatabasePool read channel
+    bool                               m_resetPending = false;
+
+    std::vector<long long>             m_ids;
+    mutable QCache<int, TrackStore>    m_pages;   // page index -> rows; LRU
+};
@@ -47,8 +47,9 @@ public:
     void cancel();
 
 signals:
-    // Emitted after each individual file is analyzed with its updated metadata.
-    // Connect to TrackModel::updateTrackMetadata() for incremental row updates.
+    // Emitted after each individual file is analyzed with its updated metadata,
+    // from the worker thread. Connect to TrackUpdateCoalescer::post() (direct)
+    // to batch the row updates instead of applying each one.
     void trackAnalyzed(const Track& updated);
 
     // Emitted after each file is analyzed (progress indicator).
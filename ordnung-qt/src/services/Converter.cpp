@@ -7,9 +7,9 @@
 #include <QDebug>
 #include <QMutexLocker>
 
-ConversionWorker::ConversionWorker(Database* db, QObject* parent)
+ConversionWorker::ConversionWorker(DatabasePool* pool, QObject* parent)
     : QObject(parent)
-    , m_db(db)
+    , m_pool(pool)
 {}
 
 int ConversionWorker::queueSize() const
@@ -60,8 +60,10 @@ void ConversionWorker::processNext()
     const QFileInfo srcInfo(job.sourcePath);
     const double sizeMb = srcInfo.exists() ? static_cast<double>(srcInfo.size()) / (1024.0 * 1024.0) : 0.0;
 
-    long long convId = m_db->insertConversion(
-        job.downloadId, job.sourcePath, outputPath, sourceExt, sizeMb, now);
+    const long long convId = m_pool->write([&](Database& db) {
+        return db.insertConversion(job.downloadId, job.sourcePath, outputPath,
+                                   sourceExt, sizeMb, now);
+    });
 
     if (convId < 0) {
         emit logLine(QStringLiteral("[%1]  ERROR: DB insert failed for %2")
@@ -70,7 +72,9 @@ void ConversionWorker::processNext()
         return;
     }
 
-    m_db->updateConversionStatus(convId, QStringLiteral("converting"));
+    m_pool->post([convId](Database& db) {
+        db.updateConversionStatus(convId, QStringLiteral("converting"));
+    });
     emit conversionStarted(convId, job.downloadId);
 
     emit logLine(QStringLiteral("[%1]  Converting: %2")
@@ -97,7 +101,9 @@ void ConversionWorker::processNext()
     if (!started) {
         const QString errMsg = QStringLiteral("ffmpeg not found or could not start");
         const QString finAt  = QDateTime::currentDateTime().toString(Qt::ISODate);
-        m_db->updateConversionStatus(convId, QStringLiteral("failed"), errMsg, finAt);
+        m_pool->post([convId, errMsg, finAt](Database& db) {
+            db.updateConversionStatus(convId, QStringLiteral("failed"), errMsg, finAt);
+        });
 
         emit logLine(QStringLiteral("[%1]  ERROR: %2")
                      .arg(QDateTime::currentDateTime().toString(QStringLiteral("hh:mm:ss")))
@@ -121,9 +127,11 @@ void ConversionWorker::processNext()
             errMsg = errMsg.left(300) + QStringLiteral("...");
     }
 
-    m_db->updateConversionStatus(convId,
+    m_pool->post([convId, success, errMsg, finAt](Database& db) {
+        db.updateConversionStatus(convId,
                                   success ? QStringLiteral("done") : QStringLiteral("failed"),
                                   errMsg, finAt);
+    });
 
     if (success) {
         emit logLine(QStringLiteral("[%1]  Done: %2")
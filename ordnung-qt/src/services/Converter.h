@@ -7,16 +7,18 @@
 
 #include "core/ConversionJob.h"
 #include "services/Database.h"
+#include "services/DatabasePool.h"
 
 // ConversionWorker is a QObject that must be moved to a QThread.
 // Never subclass QThread — worker-object pattern only.
 //
 // Callers dispatch work via QMetaObject::invokeMethod with Qt::QueuedConnection.
+// Database writes go through the pool's writer connection, never the GUI one.
 class ConversionWorker : public QObject
 {
     Q_OBJECT
 public:
-    explicit ConversionWorker(Database* db, QObject* parent = nullptr);
+    explicit ConversionWorker(DatabasePool* pool, QObject* parent = nullptr);
 
     int queueSize() const;
 
@@ -44,7 +46,7 @@ private:
         QString   outputFolder;
     };
 
-    Database*         m_db;
+    DatabasePool*     m_pool;
     QQueue<QueuedJob> m_queue;
     QMutex            m_mutex;
     bool              m_busy = false;
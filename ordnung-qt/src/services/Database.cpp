@@ -1,15 +1,31 @@
 #include "Database.h"
+#include "DatabasePool.h"
+#include "TrackRowDecoder.h"
+#include "TrackQuery.h"
+#include "WriteBehindQueue.h"
+#include "StatementTracer.h"
 
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QSqlRecord>
+#include <QSqlDriver>
 #include <QStandardPaths>
 #include <QDir>
 #include <QDateTime>
 #include <QDebug>
 #include <QFileInfo>
-#include <QRegularExpression>
 #include <QUuid>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QThread>
+
+#include <iterator>
+
+#ifdef HAVE_SQLITE3_DIRECT
+#include <sqlite3.h>
+#endif
 
 static QString convStatusToString(ConversionStatus s)
 {
@@ -31,6 +47,47 @@ static ConversionStatus convStatusFromString(const QString& s)
     return ConversionStatus::None;
 }
 
+// How often the primary connection runs PRAGMA optimize.
+static constexpr int kOptimizeIntervalMs = 60 * 60 * 1000;
+
+// Releases a cached statement's cursor when the calling method returns, so a
+// partially-read SELECT does not keep the connection's read snapshot open.
+namespace {
+class StatementScope
+{
+public:
+    explicit StatementScope(QSqlQuery& q) : m_q(q) {}
+    ~StatementScope() { m_q.finish(); }
+private:
+    QSqlQuery& m_q;
+};
+
+#ifdef HAVE_SQLITE3_DIRECT
+void bindRaw(sqlite3_stmt* stmt, int index, const QVariant& v)
+{
+    if (v.isNull()) {
+        sqlite3_bind_null(stmt, index);
+        return;
+    }
+    switch (v.typeId()) {
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+    case QMetaType::Bool:
+        sqlite3_bind_int64(stmt, index, v.toLongLong());
+        break;
+    case QMetaType::Double:
+        sqlite3_bind_double(stmt, index, v.toDouble());
+        break;
+    default: {
+        const QByteArray utf8 = v.toString().toUtf8();
+        sqlite3_bind_text(stmt, index, utf8.constData(), utf8.size(), SQLITE_TRANSIENT);
+        break;
+    }
+    }
+}
+#endif
+}
+
 // ─────────────────────────────────────────────────────────────────────────────
 
 Database::Database(QObject* parent)
@@ -40,21 +97,190 @@ Database::Database(QObject* parent)
 
 Database::~Database()
 {
+    // Edits still held by the write-behind queue go out before the connection closes.
+    if (m_writeBehind) {
+        m_writeBehind->flush();
+        optimize();
+    }
+    qInfo() << "Database: statement cache" << m_stmtHits << "hits," << m_stmtMisses
+            << "misses," << m_stmtCache.size() << "statements";
+    if (m_tracer) {
+        m_tracer->dumpSummary();
+        delete m_tracer;
+        m_tracer = nullptr;
+    }
+    // Cached statements must be finalized before the connection goes away.
+    m_stmtCache.clear();
+#ifdef HAVE_SQLITE3_DIRECT
+    m_rawStmtCache.clear();
+#endif
     if (m_db.isOpen())
         m_db.close();
     QSqlDatabase::removeDatabase(m_connectionName);
 }
 
-bool Database::open()
+QSqlQuery& Database::cachedQuery(const QString& sql)
+{
+    if (QSqlQuery* q = m_stmtCache.object(sql)) {   // also marks it most recent
+        ++m_stmtHits;
+        q->finish();  // drop any cursor left over from the previous caller
+        return *q;
+    }
+
+    ++m_stmtMisses;
+    auto* q = new QSqlQuery(m_db);
+    q->setForwardOnly(true);
+    if (!q->prepare(sql))
+        qWarning() << "Database: prepare failed:" << q->lastError().text();
+    m_stmtCache.insert(sql, q);   // may delete the least recently used query
+    return *q;
+}
+
+bool Database::execCached(QSqlQuery& q)
+{
+    if (!m_tracer || m_tracer->hooksConnection())
+        return q.exec();
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = q.exec();
+    // QSQLITE steps to the first row inside exec(); the rest of a SELECT's
+    // rows are fetched by the caller and not counted here.
+    m_tracer->recordExec(q.lastQuery().toUtf8(), timer.nsecsElapsed(),
+                         q.isSelect() ? -1 : q.numRowsAffected());
+    return ok;
+}
+
+bool Database::beginImmediate()
+{
+    QSqlQuery q(m_db);
+    if (q.exec(QStringLiteral("BEGIN IMMEDIATE")))
+        return true;
+    m_error = q.lastError().text();
+    return false;
+}
+
+#ifdef HAVE_SQLITE3_DIRECT
+sqlite3_stmt* Database::cachedRawStatement(const QString& sql)
+{
+    if (const RawStatement* cached = m_rawStmtCache.object(sql)) {
+        ++m_stmtHits;
+        return cached->stmt;
+    }
+
+    ++m_stmtMisses;
+    const QByteArray utf8 = sql.toUtf8();
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(m_rawDb, utf8.constData(), utf8.size(),
+                           SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        qWarning() << "Database: prepare failed:" << sqlite3_errmsg(m_rawDb);
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    m_rawStmtCache.insert(sql, new RawStatement{stmt});
+    return stmt;
+}
+
+Database::RawStatement::~RawStatement()
+{
+    sqlite3_finalize(stmt);
+}
+#endif
+
+Database::StatementCacheStats Database::statementCacheStats() const
+{
+    StatementCacheStats stats;
+    stats.hits   = m_stmtHits;
+    stats.misses = m_stmtMisses;
+    stats.size   = m_stmtCache.size();
+#ifdef HAVE_SQLITE3_DIRECT
+    stats.size  += m_rawStmtCache.size();
+#endif
+    return stats;
+}
+
+QVector<Track> Database::queryTracks(const QString& sql, const QVariantList& binds,
+                                     const char* caller)
+{
+    if (m_writeBehind)
+        m_writeBehind->flush();   // read back what the UI already shows
+
+    QVector<Track> result;
+    QElapsedTimer timer;
+    if (m_tracer && !m_tracer->hooksConnection())
+        timer.start();
+#ifdef HAVE_SQLITE3_DIRECT
+    if (m_rawDb) {
+        sqlite3_stmt* stmt = cachedRawStatement(sql);
+        if (!stmt)
+            return result;
+        for (int i = 0; i < binds.size(); ++i)
+            bindRaw(stmt, i + 1, binds[i]);
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+            result.append(TrackRowDecoder::decode(stmt));
+        if (rc != SQLITE_DONE)
+            qWarning() << caller << "error:" << sqlite3_errmsg(m_rawDb);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return result;
+    }
+#endif
+    QSqlQuery& q = cachedQuery(sql);
+    for (const QVariant& v : binds)
+        q.addBindValue(v);
+    if (!q.exec()) {
+        qWarning() << caller << "error:" << q.lastError().text();
+        return result;
+    }
+    while (q.next())
+        result.append(TrackRowDecoder::decode(q));
+    // Loader SQL varies with its arguments; the caller names it better.
+    if (timer.isValid())
+        m_tracer->recordExec(QByteArray(caller), timer.nsecsElapsed(), result.size());
+    return result;
+}
+
+long long Database::songIdForMatchKey(const QString& matchKey)
+{
+    QSqlQuery& q = cachedQuery(QStringLiteral("SELECT id FROM songs WHERE match_key = ?"));
+    const StatementScope scope(q);
+    q.addBindValue(matchKey);
+    if (execCached(q) && q.next())
+        return q.value(0).toLongLong();
+    return -1;
+}
+
+void Database::flushWriteBehind()
+{
+    if (m_writeBehind)
+        m_writeBehind->flush();
+}
+
+QString Database::defaultPath()
 {
-    // Determine path
     const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    if (!QDir().mkpath(dataDir)) {
-        m_error = QStringLiteral("Cannot create app data directory: ") + dataDir;
+    if (!QDir().mkpath(dataDir))
+        return QString();
+    return dataDir + QStringLiteral("/eyebags.db");
+}
+
+bool Database::open()
+{
+    const QString dbPath = defaultPath();
+    if (dbPath.isEmpty()) {
+        m_error = QStringLiteral("Cannot create app data directory: ")
+                + QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
         return false;
     }
-    const QString dbPath = dataDir + QStringLiteral("/eyebags.db");
+    return open(dbPath);
+}
+
+bool Database::open(const QString& dbPath, Role role)
+{
+    QElapsedTimer timer;
+    timer.start();
 
+    m_role = role;
     m_db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connectionName);
     m_db.setDatabaseName(dbPath);
 
@@ -63,32 +289,220 @@ bool Database::open()
         qCritical() << "Database::open failed:" << m_error;
         return false;
     }
-    qInfo() << "Database opened:" << dbPath;
+    const qint64 connectMs = timer.restart();
+    if (role == Role::Primary)
+        qInfo() << "Database opened:" << dbPath;
 
-    // Enable WAL and foreign keys
     QSqlQuery q(m_db);
+    bool newDatabase = false;
+    if (q.exec(QStringLiteral("PRAGMA page_count")) && q.next())
+        newDatabase = q.value(0).toLongLong() == 0;
+    q.finish();
+
+    // page_size only takes effect before the first table is written, so it
+    // must precede the switch to WAL.
+    if (!m_profileOverride)
+        m_profile = newDatabase ? SqliteProfile() : readSqliteProfile();
+    applySqliteProfile(newDatabase);
+
+    // Enable WAL and foreign keys
     q.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
     q.exec(QStringLiteral("PRAGMA foreign_keys=ON"));
-
-    runMigrations();
+    // Several connections share the file; wait for a competing writer instead
+    // of failing with SQLITE_BUSY.
+    q.exec(QStringLiteral("PRAGMA busy_timeout=5000"));
+    if (role == Role::Reader)
+        q.exec(QStringLiteral("PRAGMA query_only=ON"));
+
+#ifdef HAVE_SQLITE3_DIRECT
+    // Track loaders talk to QSQLITE's sqlite3 handle directly. CMake only
+    // defines HAVE_SQLITE3_DIRECT when Qt's driver links the same system SQLite
+    // we do; the version comparison merely catches a different library being
+    // picked up at run time, and is no proof on its own.
+    const QVariant handle = m_db.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0
+        && q.exec(QStringLiteral("SELECT sqlite_version()")) && q.next()
+        && q.value(0).toString() == QLatin1String(sqlite3_libversion())) {
+        m_rawDb = *static_cast<sqlite3* const*>(handle.constData());
+    } else {
+        qInfo() << "Database: QSQLITE runs on another SQLite library; direct row decoding disabled";
+    }
+    q.finish();
+#endif
+
+    // Statement tracing: ORDNUNG_SQL_TRACE=<slow ms> wins over the config row.
+    bool traceOn = false;
+    int slowMs = qEnvironmentVariableIntValue("ORDNUNG_SQL_TRACE", &traceOn);
+    if (!traceOn && !newDatabase
+        && q.exec(QStringLiteral("SELECT value FROM config WHERE key = 'sql_trace_slow_ms'"))
+        && q.next()) {
+        slowMs = q.value(0).toInt(&traceOn);
+    }
+    q.finish();
+    if (traceOn && slowMs >= 0) {
+        static const char* const kRoleNames[] = { "primary", "reader", "writer" };
+        const QString label = role == Role::Reader
+            ? QStringLiteral("reader %1").arg(quintptr(QThread::currentThreadId()), 0, 16)
+            : QString::fromLatin1(kRoleNames[int(role)]);
+#ifdef HAVE_SQLITE3_DIRECT
+        if (m_rawDb)
+            m_tracer = new StatementTracer(m_rawDb, dbPath, label, slowMs);
+#endif
+        // No hook without the raw handle: time Database's own execs instead.
+        if (!m_tracer)
+            m_tracer = new StatementTracer(label, slowMs);
+    }
+
+    const qint64 setupMs = timer.restart();
+
+    if (role == Role::Primary) {
+        if (!runMigrations())
+            return false;
+        m_writeBehind = new WriteBehindQueue(this, this);
+
+        // Long-lived connection: let SQLite refresh planner statistics at
+        // start and then periodically, instead of a blocking ANALYZE.
+        q.exec(QStringLiteral("PRAGMA optimize=0x10002"));
+        auto* optimizeTimer = new QTimer(this);
+        optimizeTimer->setInterval(kOptimizeIntervalMs);
+        connect(optimizeTimer, &QTimer::timeout, this, &Database::optimize);
+        optimizeTimer->start();
+
+        qInfo() << "Database: profile" << m_profile.name << "- synchronous"
+                << m_profile.synchronous << "mmap" << m_profile.mmapSize
+                << "cache" << m_profile.cacheSizeKiB << "KiB";
+        qInfo() << "Database: startup connect" << connectMs << "ms, setup" << setupMs
+                << "ms, migrations" << timer.elapsed() << "ms (schema version"
+                << schemaVersion() << ")";
+    }
     return true;
 }
 
-void Database::runMigrations()
+// ── Performance profile ─────────────────────────────────────────────────────
+
+SqliteProfile Database::sqliteProfileNamed(const QString& name)
+{
+    SqliteProfile p;   // balanced
+    if (name == QLatin1String("safe")) {
+        // Stock SQLite behaviour: fsync every commit, no mmap, 2 MiB cache.
+        p.name         = name;
+        p.synchronous  = QStringLiteral("FULL");
+        p.mmapSize     = 0;
+        p.cacheSizeKiB = 2 * 1024;
+        p.tempInMemory = false;
+        p.pageSize     = 4096;
+    } else if (name == QLatin1String("fast")) {
+        // Large libraries with waveform BLOBs on a machine with RAM to spare.
+        p.name         = name;
+        p.mmapSize     = 1024LL * 1024 * 1024;
+        p.cacheSizeKiB = 128 * 1024;
+        p.pageSize     = 16384;
+    }
+    return p;
+}
+
+void Database::setSqliteProfile(const SqliteProfile& profile)
+{
+    m_profile = profile;
+    m_profileOverride = true;
+}
+
+SqliteProfile Database::readSqliteProfile()
+{
+    QSqlQuery q(m_db);
+    if (!q.exec(QStringLiteral("SELECT key, value FROM config WHERE key GLOB 'sqlite_*'")))
+        return SqliteProfile();   // no config table yet
+
+    QHash<QString, QString> cfg;
+    while (q.next())
+        cfg.insert(q.value(0).toString(), q.value(1).toString().trimmed());
+
+    SqliteProfile p = sqliteProfileNamed(cfg.value(QStringLiteral("sqlite_profile")));
+    bool ok = false;
+    const QString sync = cfg.value(QStringLiteral("sqlite_synchronous")).toUpper();
+    if (sync == QLatin1String("OFF") || sync == QLatin1String("NORMAL")
+        || sync == QLatin1String("FULL") || sync == QLatin1String("EXTRA"))
+        p.synchronous = sync;
+    const qint64 mmap = cfg.value(QStringLiteral("sqlite_mmap_size")).toLongLong(&ok);
+    if (ok && mmap >= 0) p.mmapSize = mmap;
+    const int cache = cfg.value(QStringLiteral("sqlite_cache_size_kib")).toInt(&ok);
+    if (ok && cache > 0) p.cacheSizeKiB = cache;
+    const QString temp = cfg.value(QStringLiteral("sqlite_temp_store")).toLower();
+    if (temp == QLatin1String("memory"))       p.tempInMemory = true;
+    else if (temp == QLatin1String("default")) p.tempInMemory = false;
+    const int page = cfg.value(QStringLiteral("sqlite_page_size")).toInt(&ok);
+    if (ok && page >= 512 && page <= 65536 && (page & (page - 1)) == 0)
+        p.pageSize = page;
+    return p;
+}
+
+void Database::applySqliteProfile(bool newDatabase)
+{
+    QSqlQuery q(m_db);
+    if (newDatabase)
+        q.exec(QStringLiteral("PRAGMA page_size=%1").arg(m_profile.pageSize));
+    q.exec(QStringLiteral("PRAGMA synchronous=%1").arg(m_profile.synchronous));
+    q.exec(QStringLiteral("PRAGMA mmap_size=%1").arg(m_profile.mmapSize));
+    q.exec(QStringLiteral("PRAGMA cache_size=-%1").arg(m_profile.cacheSizeKiB));
+    q.exec(m_profile.tempInMemory ? QStringLiteral("PRAGMA temp_store=MEMORY")
+                                  : QStringLiteral("PRAGMA temp_store=DEFAULT"));
+}
+
+void Database::optimize()
 {
+    QElapsedTimer timer;
+    timer.start();
     QSqlQuery q(m_db);
+    if (!q.exec(QStringLiteral("PRAGMA optimize")))
+        qWarning() << "Database::optimize:" << q.lastError().text();
+    qDebug() << "Database::optimize:" << timer.elapsed() << "ms";
+}
+
+// ── Schema migrations ───────────────────────────────────────────────────────
+//
+// Numbered steps; PRAGMA user_version records the last one applied, so a warm
+// start costs a single PRAGMA read. Append new steps at the end and never
+// edit a released one.
+//
+// Databases created before versioning report user_version 0 whatever their
+// actual shape, so steps 1-6 replay the old unconditional migrations and
+// must stay idempotent (IF NOT EXISTS, addColumn).
+
+namespace {
+
+bool execDdl(QSqlDatabase& db, const QString& sql)
+{
+    QSqlQuery q(db);
+    if (q.exec(sql))
+        return true;
+    qWarning() << "DB migration error:" << q.lastError().text();
+    return false;
+}
+
+// ALTER TABLE ... ADD COLUMN that accepts the column already being there.
+bool addColumn(QSqlDatabase& db, const QString& sql)
+{
+    QSqlQuery q(db);
+    if (q.exec(sql))
+        return true;
+    const QString err = q.lastError().text();
+    if (err.contains(QLatin1String("duplicate column name"), Qt::CaseInsensitive))
+        return true;
+    qWarning() << "DB migration ALTER error:" << err;
+    return false;
+}
 
-    // Playlists
-    q.exec(QStringLiteral(R"sql(
+// 1: core tables and the columns added to songs over time.
+bool migrateCoreTables(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS playlists (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             name        TEXT NOT NULL,
             imported_at TEXT NOT NULL
         )
-    )sql"));
-
-    // Songs (tracks)
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS songs (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             title       TEXT,
@@ -104,19 +518,15 @@ void Database::runMigrations()
             has_aiff    INTEGER DEFAULT 0,
             match_key   TEXT UNIQUE
         )
-    )sql"));
-
-    // Many-to-many
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS playlist_songs (
             playlist_id INTEGER NOT NULL REFERENCES playlists(id) ON DELETE CASCADE,
             song_id     INTEGER NOT NULL REFERENCES songs(id) ON DELETE CASCADE,
             PRIMARY KEY (playlist_id, song_id)
         )
-    )sql"));
-
-    // Downloads
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS downloads (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             filename    TEXT NOT NULL,
@@ -125,10 +535,8 @@ void Database::runMigrations()
             size_mb     REAL DEFAULT 0,
             detected_at TEXT NOT NULL
         )
-    )sql"));
-
-    // Conversions
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS conversions (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             download_id INTEGER REFERENCES downloads(id) ON DELETE CASCADE,
@@ -141,92 +549,40 @@ void Database::runMigrations()
             started_at  TEXT,
             finished_at TEXT
         )
-    )sql"));
-
-    // Config
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS config (
             key   TEXT PRIMARY KEY,
             value TEXT
         )
-    )sql"));
-
-    // Migration: add filepath column to songs if it doesn't exist yet.
-    {
-        bool hasFilepath = false;
-        QSqlQuery info(m_db);
-        if (info.exec(QStringLiteral("PRAGMA table_info(songs)"))) {
-            while (info.next()) {
-                if (info.value(1).toString() == QLatin1String("filepath")) {
-                    hasFilepath = true;
-                    break;
-                }
-            }
-        }
-        if (!hasFilepath) {
-            q.exec(QStringLiteral("ALTER TABLE songs ADD COLUMN filepath TEXT DEFAULT ''"));
-            qInfo() << "Database: migrated songs table — added filepath column";
-        }
-    }
-
-    // Migration: add Rekordbox-level metadata columns to songs (safe — ignores
-    // "duplicate column name" errors so it's idempotent on existing databases).
-    {
-        auto safeAlter = [&](const QString& sql) {
-            QSqlQuery aq(m_db);
-            if (!aq.exec(sql)) {
-                const QString err = aq.lastError().text();
-                if (!err.contains(QLatin1String("duplicate column name"),
-                                  Qt::CaseInsensitive)) {
-                    qWarning() << "DB migration ALTER warning:" << err;
-                }
-            }
-        };
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN color_label INTEGER DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN bitrate      INTEGER DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN comment      TEXT    DEFAULT ''"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN play_count   INTEGER DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN date_played  TEXT    DEFAULT ''"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN energy       INTEGER DEFAULT 0"));
-    }
-
-    // Migration: Essentia deep analysis columns on songs
-    {
-        auto safeAlter = [&](const QString& sql) {
-            QSqlQuery aq(m_db);
-            if (!aq.exec(sql)) {
-                const QString err = aq.lastError().text();
-                if (!err.contains(QLatin1String("duplicate column name"),
-                                  Qt::CaseInsensitive)) {
-                    qWarning() << "DB migration ALTER warning:" << err;
-                }
-            }
-        };
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN mood_tags          TEXT    DEFAULT ''"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN style_tags         TEXT    DEFAULT ''"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN danceability       REAL    DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN valence            REAL    DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN vocal_prob         REAL    DEFAULT 0"));
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN essentia_analyzed  INTEGER DEFAULT 0"));
-    }
-
-    // Migration: Preparation mode + waveform computed flag
-    {
-        auto safeAlter = [&](const QString& sql) {
-            QSqlQuery aq(m_db);
-            if (!aq.exec(sql)) {
-                const QString err = aq.lastError().text();
-                if (!err.contains(QLatin1String("duplicate column name"),
-                                  Qt::CaseInsensitive)) {
-                    qWarning() << "DB migration ALTER warning:" << err;
-                }
-            }
-        };
-        safeAlter(QStringLiteral("ALTER TABLE songs ADD COLUMN is_prepared INTEGER DEFAULT 0"));
-    }
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
+        CREATE TABLE IF NOT EXISTS schema_version (
+            version    INTEGER PRIMARY KEY,
+            applied_at TEXT DEFAULT (datetime('now'))
+        )
+    )sql"))
+    // Library, Rekordbox-level metadata, Essentia analysis, preparation mode
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN filepath     TEXT    DEFAULT ''"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN color_label  INTEGER DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN bitrate      INTEGER DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN comment      TEXT    DEFAULT ''"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN play_count   INTEGER DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN date_played  TEXT    DEFAULT ''"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN energy       INTEGER DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN mood_tags          TEXT    DEFAULT ''"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN style_tags         TEXT    DEFAULT ''"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN danceability       REAL    DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN valence            REAL    DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN vocal_prob         REAL    DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN essentia_analyzed  INTEGER DEFAULT 0"))
+    && addColumn(db, QStringLiteral("ALTER TABLE songs ADD COLUMN is_prepared INTEGER DEFAULT 0"));
+}
 
-    // Cue points table
-    q.exec(QStringLiteral(R"sql(
+// 2: cue points, waveform cache, smart playlists, play history.
+bool migrateSideTables(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS cue_points (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             song_id     INTEGER NOT NULL REFERENCES songs(id) ON DELETE CASCADE,
@@ -238,21 +594,17 @@ void Database::runMigrations()
             color       INTEGER DEFAULT 1,
             sort_order  INTEGER DEFAULT 0
         )
-    )sql"));
-    q.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS idx_cuepoints_song ON cue_points(song_id)"));
-
-    // Waveform overview cache
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_cuepoints_song ON cue_points(song_id)"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS waveform_cache (
             song_id      INTEGER PRIMARY KEY REFERENCES songs(id) ON DELETE CASCADE,
             peaks        BLOB NOT NULL,
             generated_at TEXT
         )
-    )sql"));
-
-    // Smart playlists
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS smart_playlists (
             id         INTEGER PRIMARY KEY AUTOINCREMENT,
             name       TEXT NOT NULL,
@@ -261,65 +613,58 @@ void Database::runMigrations()
             sort_dir   TEXT DEFAULT 'ASC',
             created_at TEXT DEFAULT (datetime('now'))
         )
-    )sql"));
-
+    )sql"))
     // Play history (for History node in the collection tree)
-    q.exec(QStringLiteral(R"sql(
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TABLE IF NOT EXISTS play_history (
             id          INTEGER PRIMARY KEY AUTOINCREMENT,
             song_id     INTEGER NOT NULL REFERENCES songs(id) ON DELETE CASCADE,
             played_at   TEXT NOT NULL,
             duration_ms INTEGER DEFAULT 0
         )
-    )sql"));
-    q.exec(QStringLiteral(
+    )sql"))
+    && execDdl(db, QStringLiteral(
         "CREATE INDEX IF NOT EXISTS idx_history_date ON play_history(played_at)"));
+}
 
-    // Schema version tracking
-    q.exec(QStringLiteral(R"sql(
-        CREATE TABLE IF NOT EXISTS schema_version (
-            version    INTEGER PRIMARY KEY,
-            applied_at TEXT DEFAULT (datetime('now'))
-        )
-    )sql"));
-
-    // ── FTS5 full-text search index on songs ─────────────────────────────────
-    q.exec(QStringLiteral(R"sql(
-        CREATE VIRTUAL TABLE IF NOT EXISTS songs_fts USING fts5(
-            title, artist, album, genre, comment,
-            content='songs', content_rowid='id'
-        )
-    )sql"));
+// 3: FTS5 full-text index on songs, kept in sync by triggers.
+bool migrateFullTextSearch(QSqlDatabase& db)
+{
+    if (!execDdl(db, QStringLiteral(R"sql(
+            CREATE VIRTUAL TABLE IF NOT EXISTS songs_fts USING fts5(
+                title, artist, album, genre, comment,
+                content='songs', content_rowid='id'
+            )
+        )sql")))
+        return false;
 
-    // Populate FTS5 index if empty (first run or after DB wipe).
-    {
-        QSqlQuery cnt(m_db);
-        if (cnt.exec(QStringLiteral("SELECT COUNT(*) FROM songs_fts")) && cnt.next()
-            && cnt.value(0).toInt() == 0) {
-            q.exec(QStringLiteral(R"sql(
+    // Populate if empty (new index over an existing library).
+    QSqlQuery cnt(db);
+    if (cnt.exec(QStringLiteral("SELECT COUNT(*) FROM songs_fts")) && cnt.next()
+        && cnt.value(0).toInt() == 0) {
+        cnt.finish();
+        if (!execDdl(db, QStringLiteral(R"sql(
                 INSERT INTO songs_fts(rowid, title, artist, album, genre, comment)
                     SELECT id, title, artist, album, genre, comment FROM songs
-            )sql"));
-            qInfo() << "Database: populated FTS5 index from existing songs";
-        }
+            )sql")))
+            return false;
+        qInfo() << "Database: populated FTS5 index from existing songs";
     }
+    cnt.finish();
 
-    // Triggers to keep FTS5 in sync with songs table.
-    q.exec(QStringLiteral(R"sql(
+    return execDdl(db, QStringLiteral(R"sql(
         CREATE TRIGGER IF NOT EXISTS songs_fts_insert AFTER INSERT ON songs BEGIN
             INSERT INTO songs_fts(rowid, title, artist, album, genre, comment)
             VALUES (new.id, new.title, new.artist, new.album, new.genre, new.comment);
         END
-    )sql"));
-
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TRIGGER IF NOT EXISTS songs_fts_delete AFTER DELETE ON songs BEGIN
             INSERT INTO songs_fts(songs_fts, rowid, title, artist, album, genre, comment)
             VALUES ('delete', old.id, old.title, old.artist, old.album, old.genre, old.comment);
         END
-    )sql"));
-
-    q.exec(QStringLiteral(R"sql(
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
         CREATE TRIGGER IF NOT EXISTS songs_fts_update AFTER UPDATE ON songs BEGIN
             INSERT INTO songs_fts(songs_fts, rowid, title, artist, album, genre, comment)
             VALUES ('delete', old.id, old.title, old.artist, old.album, old.genre, old.comment);
@@ -327,9 +672,183 @@ void Database::runMigrations()
             VALUES (new.id, new.title, new.artist, new.album, new.genre, new.comment);
         END
     )sql"));
+}
+
+// 4: normalized duplicate key. A virtual generated column, so it never goes
+// stale; the partial index stores it and serves the GROUP BY in
+// findDuplicateGroups.
+bool migrateDuplicateKey(QSqlDatabase& db)
+{
+    return addColumn(db, QStringLiteral(R"sql(
+        ALTER TABLE songs ADD COLUMN dup_key TEXT GENERATED ALWAYS AS (
+            CASE WHEN artist != '' AND title != ''
+                 THEN lower(artist) || '|||' || lower(title) END
+        ) VIRTUAL
+    )sql"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_dup_key ON songs(dup_key) "
+        "WHERE dup_key IS NOT NULL"));
+}
+
+// 5: folder-scoped loads select a filepath range (see loadLibrarySongs).
+bool migrateFilepathIndex(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_filepath ON songs(filepath)"));
+}
+
+// 6: keyset paging of playlists walks songs in (title, id) order; the rowid
+// is implicitly the index's last column (see loadTracksAfter). Row-value
+// comparisons never match NULL, so a NULL title would drop out of keyset
+// pages: store missing titles as '' instead.
+bool migrateTitleKeyset(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_title ON songs(title)"))
+    && execDdl(db, QStringLiteral("UPDATE songs SET title = '' WHERE title IS NULL"))
+    && execDdl(db, QStringLiteral(R"sql(
+        CREATE TRIGGER IF NOT EXISTS songs_title_not_null_insert
+        AFTER INSERT ON songs WHEN new.title IS NULL BEGIN
+            UPDATE songs SET title = '' WHERE id = new.id;
+        END
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
+        CREATE TRIGGER IF NOT EXISTS songs_title_not_null_update
+        AFTER UPDATE OF title ON songs WHEN new.title IS NULL BEGIN
+            UPDATE songs SET title = '' WHERE id = new.id;
+        END
+    )sql"));
+}
+
+// 7: TrackQuery filters (bpm:, key:, rating>=, energy:) become range or IN
+// predicates on these columns. key: compares case-insensitively, so its index
+// carries the same collation.
+bool migrateFilterIndexes(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_bpm ON songs(bpm)"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_key ON songs(key_sig COLLATE NOCASE)"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_rating ON songs(rating)"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_energy ON songs(energy)"));
+}
+
+// 8: smart playlists keep their membership in smart_playlist_songs. Triggers
+// queue every inserted song, and every song whose rule-visible columns are
+// written, in smart_playlist_pending; refreshSmartPlaylists re-tests only
+// those. Deleted songs leave through the cascade. The built-in views become
+// rows here, and every existing song starts out pending.
+bool migrateSmartPlaylistMembership(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(R"sql(
+        CREATE TABLE IF NOT EXISTS smart_playlist_songs (
+            smart_playlist_id INTEGER NOT NULL REFERENCES smart_playlists(id) ON DELETE CASCADE,
+            song_id           INTEGER NOT NULL REFERENCES songs(id) ON DELETE CASCADE,
+            PRIMARY KEY (smart_playlist_id, song_id)
+        ) WITHOUT ROWID
+    )sql"))
+    && execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_smart_playlist_songs_song ON smart_playlist_songs(song_id)"))
+    && execDdl(db, QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS smart_playlist_pending (song_id INTEGER PRIMARY KEY)"))
+    && execDdl(db, QStringLiteral(R"sql(
+        CREATE TRIGGER IF NOT EXISTS songs_smart_pending_insert
+        AFTER INSERT ON songs BEGIN
+            INSERT OR IGNORE INTO smart_playlist_pending (song_id) VALUES (new.id);
+        END
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
+        CREATE TRIGGER IF NOT EXISTS songs_smart_pending_update
+        AFTER UPDATE OF title, artist, album, genre, comment, bpm, rating, energy,
+                        bitrate, play_count, key_sig, format, has_aiff, is_prepared
+        ON songs BEGIN
+            INSERT OR IGNORE INTO smart_playlist_pending (song_id) VALUES (new.id);
+        END
+    )sql"))
+    && execDdl(db, QStringLiteral(R"sql(
+        INSERT INTO smart_playlists (name, rules_json, sort_field, sort_dir)
+        SELECT name, rules_json, 'title', 'ASC'
+        FROM (SELECT 1 AS pos, 'Prepared for Gig' AS name, '{"query":"prepared:yes"}' AS rules_json
+              UNION ALL SELECT 2, 'Needs AIFF',        '{"query":"aiff:no"}'
+              UNION ALL SELECT 3, 'High BPM (>140)',   '{"query":"bpm>140.0"}'
+              UNION ALL SELECT 4, 'Top Rated (★★★+)', '{"query":"rating>=3"}')
+        WHERE NOT EXISTS (SELECT 1 FROM smart_playlists)
+        ORDER BY pos
+    )sql"))
+    && execDdl(db, QStringLiteral(
+        "INSERT OR IGNORE INTO smart_playlist_pending (song_id) SELECT id FROM songs"));
+}
+
+// 9: sorting by title (findTrackIds, smart playlists) ignores case, which the
+// BINARY idx_songs_title cannot serve; keyset paging keeps using that one.
+bool migrateTitleNocase(QSqlDatabase& db)
+{
+    return execDdl(db, QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS idx_songs_title_nocase ON songs(title COLLATE NOCASE)"));
+}
+
+struct Migration
+{
+    int         version;
+    const char* name;
+    bool      (*apply)(QSqlDatabase&);
+};
+
+const Migration kMigrations[] = {
+    { 1, "core tables",        migrateCoreTables },
+    { 2, "side tables",        migrateSideTables },
+    { 3, "full-text search",   migrateFullTextSearch },
+    { 4, "duplicate key",      migrateDuplicateKey },
+    { 5, "filepath index",     migrateFilepathIndex },
+    { 6, "title keyset",       migrateTitleKeyset },
+    { 7, "filter indexes",     migrateFilterIndexes },
+    { 8, "smart playlists",    migrateSmartPlaylistMembership },
+    { 9, "title nocase",       migrateTitleNocase },
+};
+
+} // namespace
+
+int Database::schemaVersion()
+{
+    return kMigrations[std::size(kMigrations) - 1].version;
+}
+
+bool Database::runMigrations()
+{
+    QSqlQuery q(m_db);
+    int current = 0;
+    if (q.exec(QStringLiteral("PRAGMA user_version")) && q.next())
+        current = q.value(0).toInt();
+    q.finish();
+    if (current >= schemaVersion())
+        return true;
+
+    qInfo() << "Database: migrating schema from version" << current << "to" << schemaVersion();
+    for (const Migration& m : kMigrations) {
+        if (m.version <= current)
+            continue;
 
-    if (q.lastError().isValid())
-        qWarning() << "DB migration error:" << q.lastError().text();
+        QElapsedTimer timer;
+        timer.start();
+        // Each step commits together with its version bump, so an interrupted
+        // migration resumes at the step that failed.
+        m_db.transaction();
+        const bool ok = m.apply(m_db)
+            && execDdl(m_db, QStringLiteral("INSERT OR REPLACE INTO schema_version (version) VALUES (%1)")
+                                 .arg(m.version))
+            && execDdl(m_db, QStringLiteral("PRAGMA user_version = %1").arg(m.version));
+        if (!ok || !m_db.commit()) {
+            m_db.rollback();
+            m_error = QStringLiteral("Schema migration %1 (%2) failed").arg(m.version).arg(QLatin1String(m.name));
+            qWarning() << "Database:" << m_error;
+            return false;
+        }
+        qInfo() << "Database: migration" << m.version << m.name << "applied in"
+                << timer.elapsed() << "ms";
+    }
+    return true;
 }
 
 // ── Playlists ──────────────────────────────────────────────────────────────
@@ -337,49 +856,42 @@ void Database::runMigrations()
 QVector<Playlist> Database::loadPlaylists()
 {
     QVector<Playlist> result;
-    QSqlQuery q(m_db);
 
-    // Load playlists with track counts and format breakdown
-    q.prepare(QStringLiteral(R"sql(
-        SELECT p.id, p.name, p.imported_at,
-               COUNT(ps.song_id) as total
+    // Playlists with their format breakdown in one statement: one row per
+    // (playlist, format), or a single NULL-format row for an empty playlist.
+    // Rows of a playlist are contiguous thanks to the p.id tiebreak.
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
+        SELECT p.id, p.name, p.imported_at, f.format, f.cnt
         FROM playlists p
-        LEFT JOIN playlist_songs ps ON ps.playlist_id = p.id
-        GROUP BY p.id
-        ORDER BY p.imported_at DESC
+        LEFT JOIN (
+            SELECT ps.playlist_id, s.format, COUNT(*) AS cnt
+            FROM playlist_songs ps
+            JOIN songs s ON s.id = ps.song_id
+            GROUP BY ps.playlist_id, s.format
+        ) f ON f.playlist_id = p.id
+        ORDER BY p.imported_at DESC, p.id
     )sql"));
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "loadPlaylists error:" << q.lastError().text();
         return result;
     }
 
     while (q.next()) {
-        Playlist p;
-        p.id          = q.value(0).toLongLong();
-        p.name        = q.value(1).toString().toStdString();
-        p.imported_at = q.value(2).toString().toStdString();
-        p.total       = q.value(3).toInt();
-        result.append(p);
-    }
-
-    // Load format counts per playlist
-    for (auto& p : result) {
-        QSqlQuery fq(m_db);
-        fq.prepare(QStringLiteral(R"sql(
-            SELECT s.format, COUNT(*) as cnt
-            FROM songs s
-            JOIN playlist_songs ps ON ps.song_id = s.id
-            WHERE ps.playlist_id = ?
-            GROUP BY s.format
-        )sql"));
-        fq.addBindValue(static_cast<qlonglong>(p.id));
-        if (fq.exec()) {
-            while (fq.next()) {
-                const std::string fmt = fq.value(0).toString().toStdString();
-                p.format_counts[fmt] = fq.value(1).toInt();
-            }
+        const long long id = q.value(0).toLongLong();
+        if (result.isEmpty() || result.last().id != id) {
+            Playlist p;
+            p.id          = id;
+            p.name        = q.value(1).toString().toStdString();
+            p.imported_at = q.value(2).toString().toStdString();
+            result.append(p);
         }
+        if (q.value(4).isNull())
+            continue;
+        Playlist& p = result.last();
+        const int count = q.value(4).toInt();
+        p.format_counts[q.value(3).toString().toStdString()] = count;
+        p.total += count;
     }
 
     return result;
@@ -387,11 +899,10 @@ QVector<Playlist> Database::loadPlaylists()
 
 long long Database::insertPlaylist(const QString& name, const QString& importedAt)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("INSERT INTO playlists (name, imported_at) VALUES (?, ?)"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("INSERT INTO playlists (name, imported_at) VALUES (?, ?)"));
     q.addBindValue(name);
     q.addBindValue(importedAt);
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return -1;
     }
@@ -400,10 +911,9 @@ long long Database::insertPlaylist(const QString& name, const QString& importedA
 
 bool Database::deletePlaylist(long long id)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("DELETE FROM playlists WHERE id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM playlists WHERE id = ?"));
     q.addBindValue(static_cast<qlonglong>(id));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -412,143 +922,75 @@ bool Database::deletePlaylist(long long id)
 
 // ── Songs ──────────────────────────────────────────────────────────────────
 
-QVector<Track> Database::loadTracks(long long playlistId, int offset, int limit)
+// Playlist pages are ordered by (title, id) and addressed by the key of the
+// row on their edge rather than by OFFSET, so each page costs its own size:
+// the seek walks idx_songs_title from the key and probes playlist_songs by
+// primary key. The id tiebreak keeps the order total, and rows inserted
+// before the key later never shift the pages after it.
+QVector<Track> Database::loadTracksAfter(long long playlistId, const QString& title,
+                                         long long id, int limit)
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT s.id, s.title, s.artist, s.album, s.genre,
-               s.bpm, s.rating, s.time, s.key_sig, s.date_added,
-               s.format, s.has_aiff, s.match_key, s.filepath,
-               s.color_label, s.bitrate, s.comment, s.play_count, s.date_played, s.energy,
-               s.mood_tags, s.style_tags, s.danceability, s.valence, s.vocal_prob, s.essentia_analyzed,
-               s.is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs s
         JOIN playlist_songs ps ON ps.song_id = s.id
-        WHERE ps.playlist_id = ?
-        ORDER BY s.title ASC
-        LIMIT ? OFFSET ?
-    )sql"));
-    q.addBindValue(static_cast<qlonglong>(playlistId));
-    q.addBindValue(limit);
-    q.addBindValue(offset);
-
-    if (!q.exec()) {
-        qWarning() << "loadTracks error:" << q.lastError().text();
-        return result;
-    }
-
-    while (q.next()) {
-        Track t;
-        t.id          = q.value(0).toLongLong();
-        t.title       = q.value(1).toString().toStdString();
-        t.artist      = q.value(2).toString().toStdString();
-        t.album       = q.value(3).toString().toStdString();
-        t.genre       = q.value(4).toString().toStdString();
-        t.bpm         = q.value(5).toDouble();
-        t.rating      = q.value(6).toInt();
-        t.time        = q.value(7).toString().toStdString();
-        t.key_sig     = q.value(8).toString().toStdString();
-        t.date_added  = q.value(9).toString().toStdString();
-        t.format      = q.value(10).toString().toStdString();
-        t.has_aiff    = q.value(11).toInt() != 0;
-        t.match_key   = q.value(12).toString().toStdString();
-        t.filepath    = q.value(13).toString().toStdString();
-        t.color_label = q.value(14).toInt();
-        t.bitrate     = q.value(15).toInt();
-        t.comment     = q.value(16).toString().toStdString();
-        t.play_count  = q.value(17).toInt();
-        t.date_played = q.value(18).toString().toStdString();
-        t.energy      = q.value(19).toInt();
-        t.mood_tags          = q.value(20).toString().toStdString();
-        t.style_tags         = q.value(21).toString().toStdString();
-        t.danceability       = q.value(22).toFloat();
-        t.valence            = q.value(23).toFloat();
-        t.vocal_prob         = q.value(24).toFloat();
-        t.essentia_analyzed  = q.value(25).toInt() != 0;
-        t.is_prepared        = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+        WHERE ps.playlist_id = ? AND (s.title, s.id) > (?, ?)
+        ORDER BY s.title ASC, s.id ASC
+        LIMIT ?
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")));
+    // QSQLITE binds a null QString as NULL, and (title, id) > (NULL, 0)
+    // matches nothing: the first page's key must be an empty string.
+    const QString key = title.isNull() ? QStringLiteral("") : title;
+    return queryTracks(sql, {static_cast<qlonglong>(playlistId), key,
+                             static_cast<qlonglong>(id), limit}, "loadTracksAfter");
 }
 
 int Database::countTracks(long long playlistId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         SELECT COUNT(*) FROM playlist_songs WHERE playlist_id = ?
     )sql"));
+    const StatementScope scope(q);
     q.addBindValue(static_cast<qlonglong>(playlistId));
-    if (q.exec() && q.next())
+    if (execCached(q) && q.next())
         return q.value(0).toInt();
     return 0;
 }
 
 Track Database::loadSongById(long long id)
 {
-    Track t;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT id, title, artist, album, genre, bpm, rating, time, key_sig,
-               date_added, format, has_aiff, match_key, filepath,
-               color_label, bitrate, comment, play_count, date_played, energy,
-               mood_tags, style_tags, danceability, valence, vocal_prob, essentia_analyzed,
-               is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs WHERE id = ?
-    )sql"));
-    q.addBindValue(static_cast<qlonglong>(id));
-    if (!q.exec() || !q.next()) {
-        qWarning() << "Database::loadSongById: failed for id" << id << ":" << q.lastError().text();
-        return t;
-    }
-    t.id         = q.value(0).toLongLong();
-    t.title      = q.value(1).toString().toStdString();
-    t.artist     = q.value(2).toString().toStdString();
-    t.album      = q.value(3).toString().toStdString();
-    t.genre      = q.value(4).toString().toStdString();
-    t.bpm        = q.value(5).toDouble();
-    t.rating     = q.value(6).toInt();
-    t.time       = q.value(7).toString().toStdString();
-    t.key_sig    = q.value(8).toString().toStdString();
-    t.date_added = q.value(9).toString().toStdString();
-    t.format     = q.value(10).toString().toStdString();
-    t.has_aiff    = q.value(11).toInt() != 0;
-    t.match_key   = q.value(12).toString().toStdString();
-    t.filepath    = q.value(13).toString().toStdString();
-    t.color_label = q.value(14).toInt();
-    t.bitrate     = q.value(15).toInt();
-    t.comment     = q.value(16).toString().toStdString();
-    t.play_count  = q.value(17).toInt();
-    t.date_played = q.value(18).toString().toStdString();
-    t.energy      = q.value(19).toInt();
-    t.mood_tags          = q.value(20).toString().toStdString();
-    t.style_tags         = q.value(21).toString().toStdString();
-    t.danceability       = q.value(22).toFloat();
-    t.valence            = q.value(23).toFloat();
-    t.vocal_prob         = q.value(24).toFloat();
-    t.essentia_analyzed  = q.value(25).toInt() != 0;
-    t.is_prepared        = q.value(26).toInt() != 0;
-    return t;
+    )sql").arg(TrackRowDecoder::columns());
+    const QVector<Track> rows = queryTracks(sql, {static_cast<qlonglong>(id)}, "loadSongById");
+    if (rows.isEmpty()) {
+        qWarning() << "Database::loadSongById: failed for id" << id;
+        return Track();
+    }
+    return rows.first();
 }
 
+static const QString kInsertScannedSongSql = QStringLiteral(R"sql(
+    INSERT INTO songs
+        (title, artist, album, genre, bpm, rating, time, key_sig, date_added,
+         format, has_aiff, match_key, filepath)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+)sql");
+
 Track Database::syncFromDisk(const Track& scanTrack)
 {
-    QSqlQuery q(m_db);
-
     // If a row with this match_key already exists, return it with user-edited fields intact.
-    q.prepare(QStringLiteral("SELECT id FROM songs WHERE match_key = ?"));
-    q.addBindValue(QString::fromStdString(scanTrack.match_key));
-    if (q.exec() && q.next()) {
-        const long long existingId = q.value(0).toLongLong();
+    const long long existingId = songIdForMatchKey(QString::fromStdString(scanTrack.match_key));
+    if (existingId > 0) {
         Track dbTrack = loadSongById(existingId);
         if (dbTrack.id > 0) {
             dbTrack.filepath = scanTrack.filepath;  // always use current on-disk path
             // Persist updated filepath (handles file moves)
-            QSqlQuery uq(m_db);
-            uq.prepare(QStringLiteral("UPDATE songs SET filepath = ? WHERE id = ?"));
+            QSqlQuery& uq = cachedQuery(QStringLiteral("UPDATE songs SET filepath = ? WHERE id = ?"));
             uq.addBindValue(QString::fromStdString(scanTrack.filepath));
             uq.addBindValue(static_cast<qlonglong>(existingId));
-            uq.exec();
+            execCached(uq);
             qDebug() << "Database::syncFromDisk: loaded existing id=" << existingId
                      << "match_key=" << QString::fromStdString(scanTrack.match_key);
             return dbTrack;
@@ -561,12 +1003,7 @@ Track Database::syncFromDisk(const Track& scanTrack)
     }
 
     // New track — insert from scan data.
-    q.prepare(QStringLiteral(R"sql(
-        INSERT INTO songs
-            (title, artist, album, genre, bpm, rating, time, key_sig, date_added,
-             format, has_aiff, match_key, filepath)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )sql"));
+    QSqlQuery& q = cachedQuery(kInsertScannedSongSql);
     q.addBindValue(QString::fromStdString(scanTrack.title));
     q.addBindValue(QString::fromStdString(scanTrack.artist));
     q.addBindValue(QString::fromStdString(scanTrack.album));
@@ -581,7 +1018,7 @@ Track Database::syncFromDisk(const Track& scanTrack)
     q.addBindValue(QString::fromStdString(scanTrack.match_key));
     q.addBindValue(QString::fromStdString(scanTrack.filepath));
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         // Likely a UNIQUE constraint violation: another file already uses this match_key
         // (e.g. the same track exists in both FLAC and AIFF). Retry with a filepath-based key
         // so each file gets its own DB row.
@@ -590,31 +1027,21 @@ Track Database::syncFromDisk(const Track& scanTrack)
                    << fileKey << "error:" << q.lastError().text();
 
         // Check if a row with this file key already exists
-        QSqlQuery fq(m_db);
-        fq.prepare(QStringLiteral("SELECT id FROM songs WHERE match_key = ?"));
-        fq.addBindValue(fileKey);
-        if (fq.exec() && fq.next()) {
-            const long long existingId = fq.value(0).toLongLong();
-            Track dbTrack = loadSongById(existingId);
+        const long long fileKeyId = songIdForMatchKey(fileKey);
+        if (fileKeyId > 0) {
+            Track dbTrack = loadSongById(fileKeyId);
             if (dbTrack.id > 0) {
                 dbTrack.filepath = scanTrack.filepath;
-                QSqlQuery uq(m_db);
-                uq.prepare(QStringLiteral("UPDATE songs SET filepath = ? WHERE id = ?"));
+                QSqlQuery& uq = cachedQuery(QStringLiteral("UPDATE songs SET filepath = ? WHERE id = ?"));
                 uq.addBindValue(QString::fromStdString(scanTrack.filepath));
-                uq.addBindValue(static_cast<qlonglong>(existingId));
-                uq.exec();
+                uq.addBindValue(static_cast<qlonglong>(fileKeyId));
+                execCached(uq);
                 return dbTrack;
             }
         }
 
         // Insert with file-path key
-        QSqlQuery rq(m_db);
-        rq.prepare(QStringLiteral(R"sql(
-            INSERT INTO songs
-                (title, artist, album, genre, bpm, rating, time, key_sig, date_added,
-                 format, has_aiff, match_key, filepath)
-            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        )sql"));
+        QSqlQuery& rq = cachedQuery(kInsertScannedSongSql);
         rq.addBindValue(QString::fromStdString(scanTrack.title));
         rq.addBindValue(QString::fromStdString(scanTrack.artist));
         rq.addBindValue(QString::fromStdString(scanTrack.album));
@@ -628,7 +1055,7 @@ Track Database::syncFromDisk(const Track& scanTrack)
         rq.addBindValue(scanTrack.has_aiff ? 1 : 0);
         rq.addBindValue(fileKey);
         rq.addBindValue(QString::fromStdString(scanTrack.filepath));
-        if (!rq.exec()) {
+        if (!execCached(rq)) {
             qWarning() << "Database::syncFromDisk: file-key insert also failed:" << rq.lastError().text();
             Track failed = scanTrack;
             failed.id = -1;
@@ -648,62 +1075,205 @@ Track Database::syncFromDisk(const Track& scanTrack)
     return newTrack;
 }
 
-QVector<Track> Database::loadLibrarySongs(const QString& folderPrefix)
+QVector<Track> Database::syncFromDiskBatch(const QVector<Track>& scanTracks)
 {
     QVector<Track> result;
-    QSqlQuery q(m_db);
+    if (scanTracks.isEmpty())
+        return result;
 
-    // Normalise: strip trailing slash so the LIKE pattern is always "prefix/%"
-    const QString prefix = folderPrefix.endsWith(QLatin1Char('/'))
-                           ? folderPrefix.chopped(1) : folderPrefix;
+    // Every failure still answers with one row per scanned file, unstored.
+    const auto unstored = [&scanTracks] {
+        QVector<Track> failed = scanTracks;
+        for (Track& t : failed)
+            t.id = -1;
+        return failed;
+    };
 
-    q.prepare(QStringLiteral(R"sql(
-        SELECT id, title, artist, album, genre, bpm, rating, time, key_sig,
-               date_added, format, has_aiff, match_key, filepath,
-               color_label, bitrate, comment, play_count, date_played, energy,
-               mood_tags, style_tags, danceability, valence, vocal_prob, essentia_analyzed,
-               is_prepared
-        FROM songs
-        WHERE filepath LIKE ?
-        ORDER BY title ASC
-    )sql"));
-    q.addBindValue(prefix + QStringLiteral("/%"));
+    // Per-connection staging table for the scan. song_id is resolved in bulk
+    // against songs.match_key instead of one SELECT per file.
+    static const QString kStageDdl[] = {
+        QStringLiteral(R"sql(
+            CREATE TEMP TABLE IF NOT EXISTS scan_stage (
+                seq        INTEGER PRIMARY KEY,
+                title      TEXT, artist TEXT, album TEXT, genre TEXT,
+                bpm        REAL, rating INTEGER, time TEXT, key_sig TEXT,
+                date_added TEXT, format TEXT, has_aiff INTEGER,
+                match_key  TEXT, filepath TEXT,
+                song_id    INTEGER
+            )
+        )sql"),
+        QStringLiteral(
+            "CREATE INDEX IF NOT EXISTS temp.idx_scan_stage_key ON scan_stage(match_key)"),
+        QStringLiteral(
+            "CREATE INDEX IF NOT EXISTS temp.idx_scan_stage_song ON scan_stage(song_id)"),
+    };
+    QSqlQuery ddl(m_db);
+    for (const QString& sql : kStageDdl) {
+        if (ddl.exec(sql))
+            continue;
+        m_error = ddl.lastError().text();
+        qWarning() << "Database::syncFromDiskBatch: cannot create staging table:" << m_error;
+        return unstored();
+    }
 
-    if (!q.exec()) {
-        qWarning() << "loadLibrarySongs error:" << q.lastError().text();
-        return result;
+    // The batch resolves against songs before it writes them.
+    if (!beginImmediate()) {
+        qWarning() << "Database::syncFromDiskBatch: cannot begin transaction:" << m_error;
+        return unstored();
     }
-    while (q.next()) {
-        Track t;
-        t.id         = q.value(0).toLongLong();
-        t.title      = q.value(1).toString().toStdString();
-        t.artist     = q.value(2).toString().toStdString();
-        t.album      = q.value(3).toString().toStdString();
-        t.genre      = q.value(4).toString().toStdString();
-        t.bpm        = q.value(5).toDouble();
-        t.rating     = q.value(6).toInt();
-        t.time       = q.value(7).toString().toStdString();
-        t.key_sig    = q.value(8).toString().toStdString();
-        t.date_added = q.value(9).toString().toStdString();
-        t.format     = q.value(10).toString().toStdString();
-        t.has_aiff    = q.value(11).toInt() != 0;
-        t.match_key   = q.value(12).toString().toStdString();
-        t.filepath    = q.value(13).toString().toStdString();
-        t.color_label = q.value(14).toInt();
-        t.bitrate     = q.value(15).toInt();
-        t.comment     = q.value(16).toString().toStdString();
-        t.play_count  = q.value(17).toInt();
-        t.date_played = q.value(18).toString().toStdString();
-        t.energy      = q.value(19).toInt();
-        t.mood_tags          = q.value(20).toString().toStdString();
-        t.style_tags         = q.value(21).toString().toStdString();
-        t.danceability       = q.value(22).toFloat();
-        t.valence            = q.value(23).toFloat();
-        t.vocal_prob         = q.value(24).toFloat();
-        t.essentia_analyzed  = q.value(25).toInt() != 0;
-        t.is_prepared        = q.value(26).toInt() != 0;
+
+    auto fail = [&](const QSqlQuery& q, const char* step) -> QVector<Track> {
+        m_error = q.lastError().text();
+        qWarning() << "Database::syncFromDiskBatch:" << step << "failed:" << m_error;
+        m_db.rollback();
+        return unstored();
+    };
+
+    // 1. Stage every scanned file.
+    QSqlQuery& clear = cachedQuery(QStringLiteral("DELETE FROM scan_stage"));
+    if (!execCached(clear))
+        return fail(clear, "clear stage");
+
+    QSqlQuery& stage = cachedQuery(QStringLiteral(R"sql(
+        INSERT INTO scan_stage
+            (seq, title, artist, album, genre, bpm, rating, time, key_sig, date_added,
+             format, has_aiff, match_key, filepath)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )sql"));
+    for (int i = 0; i < scanTracks.size(); ++i) {
+        const Track& t = scanTracks[i];
+        stage.addBindValue(i);
+        stage.addBindValue(QString::fromStdString(t.title));
+        stage.addBindValue(QString::fromStdString(t.artist));
+        stage.addBindValue(QString::fromStdString(t.album));
+        stage.addBindValue(QString::fromStdString(t.genre));
+        stage.addBindValue(t.bpm);
+        stage.addBindValue(t.rating);
+        stage.addBindValue(QString::fromStdString(t.time));
+        stage.addBindValue(QString::fromStdString(t.key_sig));
+        stage.addBindValue(QString::fromStdString(t.date_added));
+        stage.addBindValue(QString::fromStdString(t.format.empty() ? "mp3" : t.format));
+        stage.addBindValue(t.has_aiff ? 1 : 0);
+        stage.addBindValue(QString::fromStdString(t.match_key));
+        stage.addBindValue(QString::fromStdString(t.filepath));
+        if (!execCached(stage))
+            return fail(stage, "stage insert");
+    }
+
+    // 2. Resolve rows that already exist in the library with one indexed join.
+    QSqlQuery& resolve = cachedQuery(QStringLiteral(R"sql(
+        UPDATE scan_stage
+        SET song_id = (SELECT s.id FROM songs s WHERE s.match_key = scan_stage.match_key)
+        WHERE song_id IS NULL
+    )sql"));
+    if (!execCached(resolve))
+        return fail(resolve, "resolve existing");
+
+    // 3. Insert everything still unresolved, then pick up the new ids. Files that
+    //    share a new match_key collapse onto the first one scanned, exactly like
+    //    consecutive syncFromDisk calls.
+    QSqlQuery& insert = cachedQuery(QStringLiteral(R"sql(
+        INSERT OR IGNORE INTO songs
+            (title, artist, album, genre, bpm, rating, time, key_sig, date_added,
+             format, has_aiff, match_key, filepath)
+        SELECT title, artist, album, genre, bpm, rating, time, key_sig, date_added,
+               format, has_aiff, match_key, filepath
+        FROM scan_stage
+        WHERE song_id IS NULL
+        ORDER BY seq
+    )sql"));
+    if (!execCached(insert))
+        return fail(insert, "insert new");
+    const int inserted = insert.numRowsAffected();
+    if (inserted > 0 && !execCached(resolve))
+        return fail(resolve, "resolve inserted");
+
+    // 4. Existing rows always take the current on-disk path (handles file moves).
+    //    When several files map to one row the last one scanned wins, matching
+    //    repeated syncFromDisk calls. Rows whose path is unchanged are left
+    //    alone: every songs UPDATE re-indexes the row in songs_fts, and a
+    //    rescan would otherwise rebuild the index for the whole library.
+    QSqlQuery& paths = cachedQuery(QStringLiteral(R"sql(
+        UPDATE songs
+        SET filepath = (SELECT st.filepath FROM scan_stage st
+                        WHERE st.song_id = songs.id
+                        ORDER BY st.seq DESC LIMIT 1)
+        WHERE id IN (SELECT song_id FROM scan_stage WHERE song_id IS NOT NULL)
+          AND filepath IS NOT (SELECT st.filepath FROM scan_stage st
+                               WHERE st.song_id = songs.id
+                               ORDER BY st.seq DESC LIMIT 1)
+    )sql"));
+    if (!execCached(paths))
+        return fail(paths, "update filepaths");
+
+    // 5. Read back the merged rows in scan order.
+    static const QString mergedSql = QStringLiteral(R"sql(
+        SELECT %1, st.filepath
+        FROM scan_stage st
+        LEFT JOIN songs s ON s.id = st.song_id
+        ORDER BY st.seq
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")));
+    QSqlQuery& merged = cachedQuery(mergedSql);
+    if (!execCached(merged))
+        return fail(merged, "read merged rows");
+
+    result.reserve(scanTracks.size());
+    int seq = 0;
+    while (merged.next()) {
+        if (merged.value(0).isNull()) {
+            qWarning() << "Database::syncFromDiskBatch: could not store"
+                       << QString::fromStdString(scanTracks[seq].filepath);
+            Track failed = scanTracks[seq++];
+            failed.id = -1;
+            result.append(failed);
+            continue;
+        }
+        Track t = TrackRowDecoder::decode(merged);
+        t.filepath = merged.value(TrackRowDecoder::columnCount()).toString().toStdString();
         result.append(t);
+        ++seq;
+    }
+
+    execCached(clear);
+    if (!m_db.commit()) {
+        m_error = m_db.lastError().text();
+        qWarning() << "Database::syncFromDiskBatch: commit failed:" << m_error;
+        m_db.rollback();
+        for (Track& t : result)
+            t.id = -1;
+        return result;
     }
+
+    qInfo() << "Database::syncFromDiskBatch:" << scanTracks.size() << "scanned,"
+            << inserted << "inserted";
+    return result;
+}
+
+namespace {
+
+// Bounds of the filepaths under folderPrefix: "prefix/" .. "prefix0" ('0' is
+// the character after '/'), with any trailing slash stripped first. A
+// half-open range on the raw filepath is served by idx_songs_filepath; LIKE
+// is case-insensitive and never uses an index under the default BINARY
+// collation.
+QVariantList folderRange(const QString& folderPrefix)
+{
+    const QString prefix = folderPrefix.endsWith(QLatin1Char('/'))
+                           ? folderPrefix.chopped(1) : folderPrefix;
+    return {prefix + QLatin1Char('/'), prefix + QLatin1Char('0')};
+}
+
+} // namespace
+
+QVector<Track> Database::loadLibrarySongs(const QString& folderPrefix)
+{
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
+        FROM songs
+        WHERE filepath >= ? AND filepath < ?
+        ORDER BY title ASC
+    )sql").arg(TrackRowDecoder::columns());
+    const QVector<Track> result = queryTracks(sql, folderRange(folderPrefix), "loadLibrarySongs");
     qInfo() << "Database::loadLibrarySongs:" << result.size()
             << "tracks for" << folderPrefix;
     return result;
@@ -711,16 +1281,13 @@ QVector<Track> Database::loadLibrarySongs(const QString& folderPrefix)
 
 long long Database::upsertSong(const Track& t)
 {
-    QSqlQuery q(m_db);
-
     // Try to find existing by match_key
-    q.prepare(QStringLiteral("SELECT id FROM songs WHERE match_key = ?"));
-    q.addBindValue(QString::fromStdString(t.match_key));
-    if (q.exec() && q.next())
-        return q.value(0).toLongLong();
+    const long long existingId = songIdForMatchKey(QString::fromStdString(t.match_key));
+    if (existingId > 0)
+        return existingId;
 
     // Insert new
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         INSERT INTO songs
             (title, artist, album, genre, bpm, rating, time, key_sig, date_added,
              format, has_aiff, match_key)
@@ -739,7 +1306,7 @@ long long Database::upsertSong(const Track& t)
     q.addBindValue(t.has_aiff ? 1 : 0);
     q.addBindValue(QString::fromStdString(t.match_key));
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return -1;
     }
@@ -748,12 +1315,11 @@ long long Database::upsertSong(const Track& t)
 
 bool Database::linkSongToPlaylist(long long songId, long long playlistId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "INSERT OR IGNORE INTO playlist_songs (playlist_id, song_id) VALUES (?, ?)"));
     q.addBindValue(static_cast<qlonglong>(playlistId));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -762,11 +1328,12 @@ bool Database::linkSongToPlaylist(long long songId, long long playlistId)
 
 bool Database::updateSongFormat(long long songId, const QString& format)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET format = ? WHERE id = ?"));
+    flushWriteBehind();
+
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET format = ? WHERE id = ?"));
     q.addBindValue(format);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -776,14 +1343,14 @@ bool Database::updateSongFormat(long long songId, const QString& format)
 bool Database::bulkUpdateFormat(const QString& format, const QVector<long long>& songIds)
 {
     if (songIds.isEmpty()) return true;
+    flushWriteBehind();
 
     m_db.transaction();
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET format = ? WHERE id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET format = ? WHERE id = ?"));
     for (long long id : songIds) {
         q.addBindValue(format);
         q.addBindValue(static_cast<qlonglong>(id));
-        if (!q.exec()) {
+        if (!execCached(q)) {
             m_db.rollback();
             m_error = q.lastError().text();
             return false;
@@ -795,11 +1362,12 @@ bool Database::bulkUpdateFormat(const QString& format, const QVector<long long>&
 
 bool Database::updateSongAiff(long long songId, bool hasAiff)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET has_aiff = ? WHERE id = ?"));
+    flushWriteBehind();
+
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET has_aiff = ? WHERE id = ?"));
     q.addBindValue(hasAiff ? 1 : 0);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -808,11 +1376,10 @@ bool Database::updateSongAiff(long long songId, bool hasAiff)
 
 bool Database::updateSongColorLabel(long long songId, int colorLabel)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET color_label = ? WHERE id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET color_label = ? WHERE id = ?"));
     q.addBindValue(colorLabel);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -827,8 +1394,7 @@ bool Database::updateSongMetadata(long long songId, const Track& t)
     const QString matchKey = QString::fromStdString(t.artist).toLower()
                           + QStringLiteral("|||")
                           + QString::fromStdString(t.title).toLower();
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         UPDATE songs SET
             title = ?, artist = ?, album = ?, genre = ?,
             bpm = ?, time = ?, key_sig = ?, format = ?, match_key = ?
@@ -844,7 +1410,7 @@ bool Database::updateSongMetadata(long long songId, const Track& t)
     q.addBindValue(QString::fromStdString(t.format.empty() ? "mp3" : t.format));
     q.addBindValue(matchKey);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "Database::updateSongMetadata failed for id" << songId << ":" << m_error;
         return false;
@@ -855,8 +1421,7 @@ bool Database::updateSongMetadata(long long songId, const Track& t)
 QVector<PlaylistMembership> Database::getSongPlaylists(long long songId)
 {
     QVector<PlaylistMembership> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         SELECT p.id, p.name,
                (SELECT COUNT(*) FROM playlist_songs
                 WHERE playlist_id = p.id AND song_id = ?) as member
@@ -864,7 +1429,7 @@ QVector<PlaylistMembership> Database::getSongPlaylists(long long songId)
         ORDER BY p.name
     )sql"));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (q.exec()) {
+    if (execCached(q)) {
         while (q.next()) {
             PlaylistMembership m;
             m.id     = q.value(0).toLongLong();
@@ -883,12 +1448,11 @@ bool Database::addSongToPlaylist(long long songId, long long playlistId)
 
 bool Database::removeSongFromPlaylist(long long songId, long long playlistId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "DELETE FROM playlist_songs WHERE playlist_id = ? AND song_id = ?"));
     q.addBindValue(static_cast<qlonglong>(playlistId));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -900,8 +1464,7 @@ bool Database::removeSongFromPlaylist(long long songId, long long playlistId)
 QVector<Download> Database::loadDownloads()
 {
     QVector<Download> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         SELECT d.id, d.filename, d.filepath, d.extension, d.size_mb, d.detected_at,
                c.id, c.status, c.error_msg
         FROM downloads d
@@ -909,7 +1472,7 @@ QVector<Download> Database::loadDownloads()
         ORDER BY d.detected_at DESC
     )sql"));
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "loadDownloads error:" << q.lastError().text();
         return result;
     }
@@ -938,8 +1501,7 @@ long long Database::insertDownload(const QString& filename, const QString& filep
                                    const QString& extension, double sizeMb,
                                    const QString& detectedAt)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         INSERT OR IGNORE INTO downloads (filename, filepath, extension, size_mb, detected_at)
         VALUES (?, ?, ?, ?, ?)
     )sql"));
@@ -949,16 +1511,16 @@ long long Database::insertDownload(const QString& filename, const QString& filep
     q.addBindValue(sizeMb);
     q.addBindValue(detectedAt);
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return -1;
     }
     // If already existed, find it
     if (q.numRowsAffected() == 0) {
-        QSqlQuery sq(m_db);
-        sq.prepare(QStringLiteral("SELECT id FROM downloads WHERE filepath = ?"));
+        QSqlQuery& sq = cachedQuery(QStringLiteral("SELECT id FROM downloads WHERE filepath = ?"));
+        const StatementScope scope(sq);
         sq.addBindValue(filepath);
-        if (sq.exec() && sq.next())
+        if (execCached(sq) && sq.next())
             return sq.value(0).toLongLong();
         return -1;
     }
@@ -967,10 +1529,9 @@ long long Database::insertDownload(const QString& filename, const QString& filep
 
 bool Database::deleteDownload(long long id)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("DELETE FROM downloads WHERE id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM downloads WHERE id = ?"));
     q.addBindValue(static_cast<qlonglong>(id));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -979,10 +1540,10 @@ bool Database::deleteDownload(long long id)
 
 bool Database::downloadExists(const QString& filepath)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("SELECT COUNT(*) FROM downloads WHERE filepath = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("SELECT COUNT(*) FROM downloads WHERE filepath = ?"));
+    const StatementScope scope(q);
     q.addBindValue(filepath);
-    if (q.exec() && q.next())
+    if (execCached(q) && q.next())
         return q.value(0).toInt() > 0;
     return false;
 }
@@ -993,8 +1554,7 @@ long long Database::insertConversion(long long downloadId, const QString& source
                                      const QString& outputPath, const QString& sourceExt,
                                      double sizeMb, const QString& startedAt)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         INSERT INTO conversions
             (download_id, source_path, output_path, source_ext, status, size_mb, started_at)
         VALUES (?, ?, ?, ?, 'pending', ?, ?)
@@ -1006,7 +1566,7 @@ long long Database::insertConversion(long long downloadId, const QString& source
     q.addBindValue(sizeMb);
     q.addBindValue(startedAt);
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return -1;
     }
@@ -1016,15 +1576,14 @@ long long Database::insertConversion(long long downloadId, const QString& source
 bool Database::updateConversionStatus(long long convId, const QString& status,
                                       const QString& errorMsg, const QString& finishedAt)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "UPDATE conversions SET status = ?, error_msg = ?, finished_at = ? WHERE id = ?"));
     q.addBindValue(status);
     q.addBindValue(errorMsg.isEmpty() ? QVariant() : errorMsg);
     q.addBindValue(finishedAt.isEmpty() ? QVariant() : finishedAt);
     q.addBindValue(static_cast<qlonglong>(convId));
 
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -1036,9 +1595,8 @@ bool Database::updateConversionStatus(long long convId, const QString& status,
 WatchConfig Database::loadWatchConfig()
 {
     WatchConfig cfg;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("SELECT key, value FROM config WHERE key IN ('watch_folder','output_folder','auto_convert')"));
-    if (q.exec()) {
+    QSqlQuery& q = cachedQuery(QStringLiteral("SELECT key, value FROM config WHERE key IN ('watch_folder','output_folder','auto_convert')"));
+    if (execCached(q)) {
         while (q.next()) {
             const QString key = q.value(0).toString();
             const QString val = q.value(1).toString();
@@ -1057,13 +1615,12 @@ bool Database::saveWatchConfig(const WatchConfig& cfg)
         "ON CONFLICT(key) DO UPDATE SET value = excluded.value");
 
     m_db.transaction();
-    QSqlQuery q(m_db);
+    QSqlQuery& q = cachedQuery(upsert);
 
     auto doUpsert = [&](const QString& key, const QString& value) -> bool {
-        q.prepare(upsert);
         q.addBindValue(key);
         q.addBindValue(value);
-        return q.exec();
+        return execCached(q);
     };
 
     if (!doUpsert(QStringLiteral("watch_folder"),  cfg.watchFolder) ||
@@ -1080,21 +1637,20 @@ bool Database::saveWatchConfig(const WatchConfig& cfg)
 
 QString Database::loadLibraryFolder()
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("SELECT value FROM config WHERE key = 'library_folder'"));
-    if (q.exec() && q.next())
+    QSqlQuery& q = cachedQuery(QStringLiteral("SELECT value FROM config WHERE key = 'library_folder'"));
+    const StatementScope scope(q);
+    if (execCached(q) && q.next())
         return q.value(0).toString();
     return {};
 }
 
 bool Database::saveLibraryFolder(const QString& folder)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "INSERT INTO config (key, value) VALUES ('library_folder', ?) "
         "ON CONFLICT(key) DO UPDATE SET value = excluded.value"));
     q.addBindValue(folder);
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         return false;
     }
@@ -1103,106 +1659,554 @@ bool Database::saveLibraryFolder(const QString& folder)
 
 // ── FTS5 Search ────────────────────────────────────────────────────────────
 
-QVector<Track> Database::searchTracks(const QString& query)
+namespace {
+
+// "SELECT <what> FROM songs s ..." for a compiled query, plus its binds.
+QString searchSql(const QString& what, const TrackQuery::Sql& compiled,
+                  const QString& folderPrefix, QVariantList& binds)
+{
+    binds = compiled.binds;
+    QString where = compiled.where;
+    if (!folderPrefix.isEmpty()) {
+        where += QStringLiteral(" AND s.filepath >= ? AND s.filepath < ?");
+        binds += folderRange(folderPrefix);
+    }
+    return QStringLiteral("SELECT %1 FROM songs s %2 WHERE %3")
+        .arg(what, compiled.join, where);
+}
+
+} // namespace
+
+QVector<Track> Database::searchTracks(const QString& query, int limit, int offset)
+{
+    const TrackQuery parsed = TrackQuery::parse(query);
+    if (!parsed.isValid()) {
+        m_error = parsed.errorString();
+        qWarning() << "Database::searchTracks:" << m_error;
+        return {};
+    }
+    if (parsed.isEmpty())
+        return {};
+
+    const QVector<Track> result = findTracks(parsed, QString(), limit, offset);
+    qInfo() << "Database::searchTracks:" << result.size() << "results for" << query.trimmed()
+            << "from" << offset;
+    return result;
+}
+
+int Database::countSearchMatches(const QString& query)
+{
+    const TrackQuery parsed = TrackQuery::parse(query);
+    if (!parsed.isValid() || parsed.isEmpty())
+        return 0;
+    return countMatches(parsed);
+}
+
+QVector<Track> Database::findTracks(const TrackQuery& query, const QString& folderPrefix,
+                                    int limit, int offset)
+{
+    // The SQL text depends only on the query's shape (values are bound), so
+    // the statement cache holds one entry per shape, not per search.
+    const TrackQuery::Sql compiled = query.compile();
+    QVariantList binds;
+    const QString sql = searchSql(TrackRowDecoder::columns(QStringLiteral("s")),
+                                  compiled, folderPrefix, binds)
+        + QStringLiteral(" ORDER BY %1 LIMIT ? OFFSET ?").arg(compiled.orderBy);
+    // LIMIT -1 is SQLite's "no limit".
+    binds << (limit < 0 ? -1 : limit) << offset;
+    return queryTracks(sql, binds, "findTracks");
+}
+
+int Database::countMatches(const TrackQuery& query, const QString& folderPrefix)
+{
+    QVariantList binds;
+    QSqlQuery& q = cachedQuery(searchSql(QStringLiteral("COUNT(*)"), query.compile(),
+                                         folderPrefix, binds));
+    const StatementScope scope(q);
+    for (const QVariant& v : binds)
+        q.addBindValue(v);
+    if (execCached(q) && q.next())
+        return q.value(0).toInt();
+    return 0;
+}
+
+// ── Windowed access ────────────────────────────────────────────────────────
+
+namespace {
+
+// Text sorts ignore case; time ("M:SS") sorts by its seconds; an empty
+// format sorts as the "mp3" the table shows for it.
+QString orderExpression(SongOrder::Field field)
 {
-    const QString trimmed = query.trimmed();
-    if (trimmed.isEmpty())
-        return loadAllSongs();
+    switch (field) {
+    case SongOrder::Title:      return QStringLiteral("s.title COLLATE NOCASE");
+    case SongOrder::Artist:     return QStringLiteral("s.artist COLLATE NOCASE");
+    case SongOrder::Bpm:        return QStringLiteral("s.bpm");
+    case SongOrder::KeySig:     return QStringLiteral("s.key_sig COLLATE NOCASE");
+    case SongOrder::Duration:
+        return QStringLiteral("(CAST(substr(s.time, 1, instr(s.time, ':') - 1) AS INTEGER) * 60"
+                              " + CAST(substr(s.time, instr(s.time, ':') + 1) AS INTEGER))");
+    case SongOrder::Format:     return QStringLiteral("IFNULL(NULLIF(s.format, ''), 'mp3') COLLATE NOCASE");
+    case SongOrder::ColorLabel: return QStringLiteral("s.color_label");
+    case SongOrder::Prepared:   return QStringLiteral("s.is_prepared");
+    case SongOrder::Bitrate:    return QStringLiteral("s.bitrate");
+    case SongOrder::Comment:    return QStringLiteral("s.comment COLLATE NOCASE");
+    }
+    return QStringLiteral("s.id");
+}
+
+} // namespace
 
-    // Sanitize for FTS5: wrap each token in double quotes and append * for prefix matching.
-    QStringList tokens = trimmed.split(QRegularExpression(QStringLiteral("\\s+")),
-                                       Qt::SkipEmptyParts);
-    QStringList ftsTerms;
-    for (const QString& tok : tokens) {
-        QString escaped = tok;
-        escaped.replace(QLatin1Char('"'), QLatin1String("\"\""));
-        ftsTerms.append(QStringLiteral("\"%1\"*").arg(escaped));
+QVector<long long> Database::findTrackIds(const TrackQuery& query, const QString& folderPrefix,
+                                          const QVector<SongOrder>& order)
+{
+    const TrackQuery::Sql compiled = query.compile();
+    QString orderBy = compiled.orderBy;
+    if (!order.isEmpty()) {
+        QStringList terms;
+        for (const SongOrder& o : order)
+            terms << orderExpression(o.field)
+                     + (o.descending ? QStringLiteral(" DESC") : QStringLiteral(" ASC"));
+        terms << QStringLiteral("s.id");
+        orderBy = terms.join(QStringLiteral(", "));
+    }
+    QVariantList binds;
+    const QString sql = searchSql(QStringLiteral("s.id"), compiled, folderPrefix, binds)
+        + QStringLiteral(" ORDER BY ") + orderBy;
+
+    if (m_writeBehind)
+        m_writeBehind->flush();
+
+    QVector<long long> ids;
+#ifdef HAVE_SQLITE3_DIRECT
+    if (m_rawDb) {
+        sqlite3_stmt* stmt = cachedRawStatement(sql);
+        if (!stmt)
+            return ids;
+        for (int i = 0; i < binds.size(); ++i)
+            bindRaw(stmt, i + 1, binds[i]);
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+            ids.append(sqlite3_column_int64(stmt, 0));
+        if (rc != SQLITE_DONE)
+            qWarning() << "findTrackIds error:" << sqlite3_errmsg(m_rawDb);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return ids;
+    }
+#endif
+    QSqlQuery& q = cachedQuery(sql);
+    const StatementScope scope(q);
+    for (const QVariant& v : binds)
+        q.addBindValue(v);
+    if (!execCached(q)) {
+        m_error = q.lastError().text();
+        qWarning() << "findTrackIds error:" << m_error;
+        return ids;
     }
-    const QString ftsQuery = ftsTerms.join(QStringLiteral(" "));
+    while (q.next())
+        ids.append(q.value(0).toLongLong());
+    return ids;
+}
+
+QVector<Track> Database::loadSongsByIds(const QVector<long long>& ids)
+{
+    if (ids.isEmpty())
+        return {};
 
+    // The list is padded with NULLs (which match nothing) to a power of two,
+    // so any page length reuses one of a few cached statements.
+    int slots = 16;
+    while (slots < ids.size())
+        slots *= 2;
+    QVariantList binds;
+    binds.reserve(slots);
+    for (const long long id : ids)
+        binds << static_cast<qlonglong>(id);
+    while (binds.size() < slots)
+        binds << QVariant();
+    QStringList marks;
+    marks.fill(QStringLiteral("?"), slots);
+    const QString sql = QStringLiteral("SELECT %1 FROM songs WHERE id IN (%2)")
+        .arg(TrackRowDecoder::columns(), marks.join(QLatin1Char(',')));
+    const QVector<Track> rows = queryTracks(sql, binds, "loadSongsByIds");
+
+    QHash<long long, int> rowOf;
+    rowOf.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i)
+        rowOf.insert(rows[i].id, i);
     QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT s.id, s.title, s.artist, s.album, s.genre,
-               s.bpm, s.rating, s.time, s.key_sig, s.date_added,
-               s.format, s.has_aiff, s.match_key, s.filepath,
-               s.color_label, s.bitrate, s.comment, s.play_count, s.date_played, s.energy,
-               s.mood_tags, s.style_tags, s.danceability, s.valence, s.vocal_prob, s.essentia_analyzed,
-               s.is_prepared
-        FROM songs s
-        JOIN songs_fts ON s.id = songs_fts.rowid
-        WHERE songs_fts MATCH ?
-        ORDER BY rank
-    )sql"));
-    q.addBindValue(ftsQuery);
+    result.reserve(rows.size());
+    for (const long long id : ids) {
+        const int i = rowOf.value(id, -1);
+        if (i >= 0)
+            result.append(rows[i]);
+    }
+    return result;
+}
 
-    if (!q.exec()) {
-        qWarning() << "searchTracks FTS5 error:" << q.lastError().text()
-                   << "query:" << ftsQuery;
+// ── Smart Playlists ────────────────────────────────────────────────────────
+
+namespace {
+
+// rules_json holds {"query": "<TrackQuery text>"}.
+QString queryFromRules(const QString& rulesJson)
+{
+    return QJsonDocument::fromJson(rulesJson.toUtf8()).object()
+        .value(QLatin1String("query")).toString();
+}
+
+QString rulesFromQuery(const QString& query)
+{
+    const QJsonObject rules{{QStringLiteral("query"), query}};
+    return QString::fromUtf8(QJsonDocument(rules).toJson(QJsonDocument::Compact));
+}
+
+// smart_playlists.sort_field; unknown names sort by title.
+SongOrder::Field sortFieldNamed(const QString& name)
+{
+    static const QHash<QString, SongOrder::Field> kFields = {
+        { QStringLiteral("title"),    SongOrder::Title },
+        { QStringLiteral("artist"),   SongOrder::Artist },
+        { QStringLiteral("bpm"),      SongOrder::Bpm },
+        { QStringLiteral("key"),      SongOrder::KeySig },
+        { QStringLiteral("time"),     SongOrder::Duration },
+        { QStringLiteral("format"),   SongOrder::Format },
+        { QStringLiteral("color"),    SongOrder::ColorLabel },
+        { QStringLiteral("prepared"), SongOrder::Prepared },
+        { QStringLiteral("bitrate"),  SongOrder::Bitrate },
+        { QStringLiteral("comment"),  SongOrder::Comment },
+    };
+    return kFields.value(name.toLower(), SongOrder::Title);
+}
+
+// "INSERT INTO smart_playlist_songs SELECT ?, s.id ..." for a compiled rule,
+// over every song or only the queued ones. Binds: the playlist id, then the
+// rule's. Over the queue every join is a CROSS JOIN, which pins the join
+// order: otherwise SQLite prefers to drive a full-text rule from its MATCH,
+// scanning every match in the library instead of probing the few queued
+// rows by rowid.
+QString membershipInsertSql(const TrackQuery::Sql& compiled, bool queuedOnly)
+{
+    QString from = QStringLiteral("songs s");
+    QString join = compiled.join;
+    if (queuedOnly) {
+        from = QStringLiteral("smart_playlist_pending p CROSS JOIN songs s ON s.id = p.song_id");
+        if (join.startsWith(QLatin1String("JOIN ")))
+            join.prepend(QLatin1String("CROSS "));
+    }
+    return QStringLiteral(
+        "INSERT INTO smart_playlist_songs (smart_playlist_id, song_id) "
+        "SELECT ?, s.id FROM %1 %2 WHERE %3").arg(from, join, compiled.where);
+}
+
+} // namespace
+
+QVector<SmartPlaylist> Database::loadSmartPlaylists(const QString& folderPrefix)
+{
+    QVector<SmartPlaylist> result;
+    syncSmartPlaylists();
+
+    // The count walks the membership primary key, probing songs by id only
+    // when it has to match loadSmartPlaylistTracks' folder filter.
+    static const QString kAll = QStringLiteral(R"sql(
+        SELECT p.id, p.name, p.rules_json, p.sort_field, p.sort_dir,
+               (SELECT COUNT(*) FROM smart_playlist_songs sp
+                WHERE sp.smart_playlist_id = p.id)
+        FROM smart_playlists p
+        ORDER BY p.id
+    )sql");
+    static const QString kInFolder = QStringLiteral(R"sql(
+        SELECT p.id, p.name, p.rules_json, p.sort_field, p.sort_dir,
+               (SELECT COUNT(*) FROM smart_playlist_songs sp
+                JOIN songs s ON s.id = sp.song_id
+                WHERE sp.smart_playlist_id = p.id
+                  AND s.filepath >= ? AND s.filepath < ?)
+        FROM smart_playlists p
+        ORDER BY p.id
+    )sql");
+    QSqlQuery& q = cachedQuery(folderPrefix.isEmpty() ? kAll : kInFolder);
+    if (!folderPrefix.isEmpty()) {
+        const QVariantList range = folderRange(folderPrefix);
+        q.addBindValue(range[0]);
+        q.addBindValue(range[1]);
+    }
+    const StatementScope scope(q);
+    if (!execCached(q)) {
+        qWarning() << "loadSmartPlaylists error:" << q.lastError().text();
         return result;
     }
-
     while (q.next()) {
-        Track t;
-        t.id          = q.value(0).toLongLong();
-        t.title       = q.value(1).toString().toStdString();
-        t.artist      = q.value(2).toString().toStdString();
-        t.album       = q.value(3).toString().toStdString();
-        t.genre       = q.value(4).toString().toStdString();
-        t.bpm         = q.value(5).toDouble();
-        t.rating      = q.value(6).toInt();
-        t.time        = q.value(7).toString().toStdString();
-        t.key_sig     = q.value(8).toString().toStdString();
-        t.date_added  = q.value(9).toString().toStdString();
-        t.format      = q.value(10).toString().toStdString();
-        t.has_aiff    = q.value(11).toInt() != 0;
-        t.match_key   = q.value(12).toString().toStdString();
-        t.filepath    = q.value(13).toString().toStdString();
-        t.color_label = q.value(14).toInt();
-        t.bitrate     = q.value(15).toInt();
-        t.comment     = q.value(16).toString().toStdString();
-        t.play_count  = q.value(17).toInt();
-        t.date_played = q.value(18).toString().toStdString();
-        t.energy      = q.value(19).toInt();
-        t.mood_tags          = q.value(20).toString().toStdString();
-        t.style_tags         = q.value(21).toString().toStdString();
-        t.danceability       = q.value(22).toFloat();
-        t.valence            = q.value(23).toFloat();
-        t.vocal_prob         = q.value(24).toFloat();
-        t.essentia_analyzed  = q.value(25).toInt() != 0;
-        t.is_prepared        = q.value(26).toInt() != 0;
-        result.append(t);
+        SmartPlaylist p;
+        p.id         = q.value(0).toLongLong();
+        p.name       = q.value(1).toString().toStdString();
+        p.query      = queryFromRules(q.value(2).toString()).toStdString();
+        p.sort_field = q.value(3).toString().toStdString();
+        p.descending = q.value(4).toString().compare(QLatin1String("DESC"), Qt::CaseInsensitive) == 0;
+        p.total      = q.value(5).toInt();
+        result.append(p);
     }
-    qInfo() << "Database::searchTracks:" << result.size() << "results for" << trimmed;
     return result;
 }
 
-// ── Missing File Relocator ─────────────────────────────────────────────────
+QVector<Track> Database::loadSmartPlaylistTracks(long long id, const QString& folderPrefix)
+{
+    syncSmartPlaylists();
+
+    SongOrder order;
+    {
+        QSqlQuery& q = cachedQuery(QStringLiteral(
+            "SELECT sort_field, sort_dir FROM smart_playlists WHERE id = ?"));
+        const StatementScope scope(q);
+        q.addBindValue(static_cast<qlonglong>(id));
+        if (!execCached(q) || !q.next()) {
+            qWarning() << "Database::loadSmartPlaylistTracks: no smart playlist" << id;
+            return {};
+        }
+        order.field      = sortFieldNamed(q.value(0).toString());
+        order.descending = q.value(1).toString().compare(QLatin1String("DESC"), Qt::CaseInsensitive) == 0;
+    }
+
+    // Same shape as a static playlist load: the membership key selects the
+    // rows, songs is probed by primary key.
+    QVariantList binds{static_cast<qlonglong>(id)};
+    QString where = QStringLiteral("sp.smart_playlist_id = ?");
+    if (!folderPrefix.isEmpty()) {
+        where += QStringLiteral(" AND s.filepath >= ? AND s.filepath < ?");
+        binds += folderRange(folderPrefix);
+    }
+    const QString sql = QStringLiteral(R"sql(
+        SELECT %1
+        FROM smart_playlist_songs sp
+        JOIN songs s ON s.id = sp.song_id
+        WHERE %2
+        ORDER BY %3 %4, s.id
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")), where,
+               orderExpression(order.field),
+               order.descending ? QStringLiteral("DESC") : QStringLiteral("ASC"));
+    return queryTracks(sql, binds, "loadSmartPlaylistTracks");
+}
 
-QVector<Track> Database::findMissingTracks()
+long long Database::insertSmartPlaylist(const QString& name, const QString& query,
+                                        const QString& sortField, bool descending)
 {
-    const QVector<Track> all = loadAllSongs();
-    QVector<Track> missing;
-    for (const Track& t : all) {
-        if (t.filepath.empty())
-            continue;
-        if (!QFileInfo::exists(QString::fromStdString(t.filepath)))
-            missing.append(t);
+    const TrackQuery parsed = TrackQuery::parse(query);
+    if (!parsed.isValid()) {
+        m_error = parsed.errorString();
+        qWarning() << "Database::insertSmartPlaylist:" << m_error;
+        return -1;
+    }
+
+    m_db.transaction();
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
+        INSERT INTO smart_playlists (name, rules_json, sort_field, sort_dir)
+        VALUES (?, ?, ?, ?)
+    )sql"));
+    q.addBindValue(name);
+    q.addBindValue(rulesFromQuery(query));
+    q.addBindValue(sortField);
+    q.addBindValue(descending ? QStringLiteral("DESC") : QStringLiteral("ASC"));
+    if (!execCached(q)) {
+        m_error = q.lastError().text();
+        m_db.rollback();
+        return -1;
+    }
+    const long long id = q.lastInsertId().toLongLong();
+    if (!materializeSmartPlaylist(id, parsed) || !m_db.commit()) {
+        m_db.rollback();
+        return -1;
+    }
+    return id;
+}
+
+bool Database::updateSmartPlaylistQuery(long long id, const QString& query)
+{
+    const TrackQuery parsed = TrackQuery::parse(query);
+    if (!parsed.isValid()) {
+        m_error = parsed.errorString();
+        qWarning() << "Database::updateSmartPlaylistQuery:" << m_error;
+        return false;
+    }
+
+    m_db.transaction();
+    QSqlQuery& q = cachedQuery(QStringLiteral(
+        "UPDATE smart_playlists SET rules_json = ? WHERE id = ?"));
+    q.addBindValue(rulesFromQuery(query));
+    q.addBindValue(static_cast<qlonglong>(id));
+    if (!execCached(q)) {
+        m_error = q.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    if (!materializeSmartPlaylist(id, parsed) || !m_db.commit()) {
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool Database::deleteSmartPlaylist(long long id)
+{
+    // Members go with it (ON DELETE CASCADE).
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM smart_playlists WHERE id = ?"));
+    q.addBindValue(static_cast<qlonglong>(id));
+    if (!execCached(q)) {
+        m_error = q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool Database::materializeSmartPlaylist(long long id, const TrackQuery& query)
+{
+    QSqlQuery& clear = cachedQuery(QStringLiteral(
+        "DELETE FROM smart_playlist_songs WHERE smart_playlist_id = ?"));
+    clear.addBindValue(static_cast<qlonglong>(id));
+    if (!execCached(clear)) {
+        m_error = clear.lastError().text();
+        qWarning() << "Database::materializeSmartPlaylist: clear failed:" << m_error;
+        return false;
+    }
+
+    const TrackQuery::Sql compiled = query.compile();
+    QSqlQuery& fill = cachedQuery(membershipInsertSql(compiled, false));
+    fill.addBindValue(static_cast<qlonglong>(id));
+    for (const QVariant& v : compiled.binds)
+        fill.addBindValue(v);
+    if (!execCached(fill)) {
+        m_error = fill.lastError().text();
+        qWarning() << "Database::materializeSmartPlaylist: fill failed:" << m_error;
+        return false;
+    }
+    return true;
+}
+
+bool Database::syncSmartPlaylists()
+{
+    if (m_role == Role::Reader && m_pool) {
+        // The primary's held-back edits must reach songs before the writer
+        // re-tests the queue; pool reads have flushed already, other callers
+        // have not.
+        m_pool->flushWriteBehind();
+        return m_pool->write([](Database& writer) { return writer.refreshSmartPlaylists(); });
+    }
+    // Held-back edits must reach songs (and so the queue) first.
+    if (m_writeBehind)
+        m_writeBehind->flush();
+    return refreshSmartPlaylists();
+}
+
+// Each playlist costs two statements bounded by the queue, not by the
+// library: the queued songs' old memberships are dropped by primary key, and
+// the rule is evaluated over the queue joined to songs. A quiet library
+// costs one EXISTS probe.
+bool Database::refreshSmartPlaylists()
+{
+    {
+        QSqlQuery& q = cachedQuery(QStringLiteral(
+            "SELECT EXISTS (SELECT 1 FROM smart_playlist_pending)"));
+        const StatementScope scope(q);
+        if (!execCached(q) || !q.next()) {
+            m_error = q.lastError().text();
+            qWarning() << "Database::refreshSmartPlaylists:" << m_error;
+            return false;
+        }
+        if (!q.value(0).toBool())
+            return true;
+    }
+
+    // Each membership insert reads songs and the queue before it writes. The
+    // rules are read inside the same transaction, so a concurrent
+    // updateSmartPlaylistQuery (which rebuilds its playlist in full) is
+    // either entirely before this refresh or entirely after it.
+    if (!beginImmediate()) {
+        qWarning() << "Database::refreshSmartPlaylists: cannot begin transaction:" << m_error;
+        return false;
+    }
+    auto fail = [&](const QSqlQuery& q, const char* step) {
+        m_error = q.lastError().text();
+        qWarning() << "Database::refreshSmartPlaylists:" << step << "failed:" << m_error;
+        m_db.rollback();
+        return false;
+    };
+
+    // A playlist whose rules no longer parse cannot re-test the queue, and
+    // the queue is cleared below; rather than keep members that may be
+    // stale, it is emptied until updateSmartPlaylistQuery gives it new rules.
+    QVector<QPair<long long, TrackQuery>> rules;
+    QVector<long long> invalid;
+    {
+        QSqlQuery& q = cachedQuery(QStringLiteral("SELECT id, rules_json FROM smart_playlists"));
+        const StatementScope scope(q);
+        if (!execCached(q))
+            return fail(q, "read rules");
+        while (q.next()) {
+            const long long id = q.value(0).toLongLong();
+            const TrackQuery query = TrackQuery::parse(queryFromRules(q.value(1).toString()));
+            if (!query.isValid()) {
+                qWarning() << "Database::refreshSmartPlaylists: smart playlist" << id
+                           << "has invalid rules:" << query.errorString() << "- emptied";
+                invalid.append(id);
+                continue;
+            }
+            rules.append({id, query});
+        }
     }
-    qInfo() << "Database::findMissingTracks:" << missing.size()
-            << "missing out of" << all.size() << "total";
-    return missing;
+
+    QSqlQuery& clear = cachedQuery(QStringLiteral(
+        "DELETE FROM smart_playlist_songs WHERE smart_playlist_id = ?"));
+    for (const long long id : std::as_const(invalid)) {
+        clear.addBindValue(static_cast<qlonglong>(id));
+        if (!execCached(clear))
+            return fail(clear, "empty invalid playlist");
+    }
+
+    QSqlQuery& drop = cachedQuery(QStringLiteral(R"sql(
+        DELETE FROM smart_playlist_songs
+        WHERE smart_playlist_id = ?
+          AND song_id IN (SELECT song_id FROM smart_playlist_pending)
+    )sql"));
+    for (const auto& [id, query] : std::as_const(rules)) {
+        drop.addBindValue(static_cast<qlonglong>(id));
+        if (!execCached(drop))
+            return fail(drop, "drop stale members");
+
+        const TrackQuery::Sql compiled = query.compile();
+        QSqlQuery& add = cachedQuery(membershipInsertSql(compiled, true));
+        add.addBindValue(static_cast<qlonglong>(id));
+        for (const QVariant& v : compiled.binds)
+            add.addBindValue(v);
+        if (!execCached(add))
+            return fail(add, "add members");
+    }
+
+    QSqlQuery& done = cachedQuery(QStringLiteral("DELETE FROM smart_playlist_pending"));
+    if (!execCached(done))
+        return fail(done, "clear queue");
+    const int songs = done.numRowsAffected();
+    if (!m_db.commit()) {
+        m_error = m_db.lastError().text();
+        qWarning() << "Database::refreshSmartPlaylists: commit failed:" << m_error;
+        m_db.rollback();
+        return false;
+    }
+    qDebug() << "Database::refreshSmartPlaylists:" << songs << "songs re-tested against"
+             << rules.size() << "smart playlists";
+    return true;
 }
 
+// ── Missing File Relocator ─────────────────────────────────────────────────
+
 bool Database::updateTrackFilepath(long long songId, const QString& newPath)
 {
+    flushWriteBehind();
+
     const QString format = QFileInfo(newPath).suffix().toLower();
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET filepath = ?, format = ? WHERE id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET filepath = ?, format = ? WHERE id = ?"));
     q.addBindValue(newPath);
     q.addBindValue(format);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "updateTrackFilepath failed for id" << songId << ":" << m_error;
         return false;
@@ -1212,23 +2216,24 @@ bool Database::updateTrackFilepath(long long songId, const QString& newPath)
 
 bool Database::deleteTrack(long long songId)
 {
+    flushWriteBehind();
+
     m_db.transaction();
-    QSqlQuery q(m_db);
 
-    q.prepare(QStringLiteral("DELETE FROM playlist_songs WHERE song_id = ?"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM playlist_songs WHERE song_id = ?"));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_db.rollback();
         m_error = q.lastError().text();
         qWarning() << "deleteTrack: playlist_songs delete failed:" << m_error;
         return false;
     }
 
-    q.prepare(QStringLiteral("DELETE FROM songs WHERE id = ?"));
-    q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    QSqlQuery& dq = cachedQuery(QStringLiteral("DELETE FROM songs WHERE id = ?"));
+    dq.addBindValue(static_cast<qlonglong>(songId));
+    if (!execCached(dq)) {
         m_db.rollback();
-        m_error = q.lastError().text();
+        m_error = dq.lastError().text();
         qWarning() << "deleteTrack: songs delete failed:" << m_error;
         return false;
     }
@@ -1241,123 +2246,39 @@ bool Database::deleteTrack(long long songId)
 
 QVector<Track> Database::loadAllSongs()
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT id, title, artist, album, genre, bpm, rating, time, key_sig,
-               date_added, format, has_aiff, match_key, filepath,
-               color_label, bitrate, comment, play_count, date_played, energy,
-               mood_tags, style_tags, danceability, valence, vocal_prob, essentia_analyzed,
-               is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs
         ORDER BY title ASC
-    )sql"));
-    if (!q.exec()) {
-        qWarning() << "loadAllSongs error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id          = q.value(0).toLongLong();
-        t.title       = q.value(1).toString().toStdString();
-        t.artist      = q.value(2).toString().toStdString();
-        t.album       = q.value(3).toString().toStdString();
-        t.genre       = q.value(4).toString().toStdString();
-        t.bpm         = q.value(5).toDouble();
-        t.rating      = q.value(6).toInt();
-        t.time        = q.value(7).toString().toStdString();
-        t.key_sig     = q.value(8).toString().toStdString();
-        t.date_added  = q.value(9).toString().toStdString();
-        t.format      = q.value(10).toString().toStdString();
-        t.has_aiff    = q.value(11).toInt() != 0;
-        t.match_key   = q.value(12).toString().toStdString();
-        t.filepath    = q.value(13).toString().toStdString();
-        t.color_label = q.value(14).toInt();
-        t.bitrate     = q.value(15).toInt();
-        t.comment     = q.value(16).toString().toStdString();
-        t.play_count  = q.value(17).toInt();
-        t.date_played = q.value(18).toString().toStdString();
-        t.energy      = q.value(19).toInt();
-        t.mood_tags          = q.value(20).toString().toStdString();
-        t.style_tags         = q.value(21).toString().toStdString();
-        t.danceability       = q.value(22).toFloat();
-        t.valence            = q.value(23).toFloat();
-        t.vocal_prob         = q.value(24).toFloat();
-        t.essentia_analyzed  = q.value(25).toInt() != 0;
-        t.is_prepared        = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    qInfo() << "Database::loadAllSongs:" << result.size() << "tracks";
-    return result;
+    )sql").arg(TrackRowDecoder::columns());
+    return queryTracks(sql, {}, "loadAllSongs");
 }
 
 QVector<Track> Database::loadPlaylistSongs(long long playlistId)
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT s.id, s.title, s.artist, s.album, s.genre,
-               s.bpm, s.rating, s.time, s.key_sig, s.date_added,
-               s.format, s.has_aiff, s.match_key, s.filepath,
-               s.color_label, s.bitrate, s.comment, s.play_count, s.date_played, s.energy,
-               s.mood_tags, s.style_tags, s.danceability, s.valence, s.vocal_prob, s.essentia_analyzed,
-               s.is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs s
         JOIN playlist_songs ps ON ps.song_id = s.id
         WHERE ps.playlist_id = ?
         ORDER BY s.title ASC
-    )sql"));
-    q.addBindValue(static_cast<qlonglong>(playlistId));
-    if (!q.exec()) {
-        qWarning() << "loadPlaylistSongs error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id          = q.value(0).toLongLong();
-        t.title       = q.value(1).toString().toStdString();
-        t.artist      = q.value(2).toString().toStdString();
-        t.album       = q.value(3).toString().toStdString();
-        t.genre       = q.value(4).toString().toStdString();
-        t.bpm         = q.value(5).toDouble();
-        t.rating      = q.value(6).toInt();
-        t.time        = q.value(7).toString().toStdString();
-        t.key_sig     = q.value(8).toString().toStdString();
-        t.date_added  = q.value(9).toString().toStdString();
-        t.format      = q.value(10).toString().toStdString();
-        t.has_aiff    = q.value(11).toInt() != 0;
-        t.match_key   = q.value(12).toString().toStdString();
-        t.filepath    = q.value(13).toString().toStdString();
-        t.color_label = q.value(14).toInt();
-        t.bitrate     = q.value(15).toInt();
-        t.comment     = q.value(16).toString().toStdString();
-        t.play_count  = q.value(17).toInt();
-        t.date_played = q.value(18).toString().toStdString();
-        t.energy      = q.value(19).toInt();
-        t.mood_tags          = q.value(20).toString().toStdString();
-        t.style_tags         = q.value(21).toString().toStdString();
-        t.danceability       = q.value(22).toFloat();
-        t.valence            = q.value(23).toFloat();
-        t.vocal_prob         = q.value(24).toFloat();
-        t.essentia_analyzed  = q.value(25).toInt() != 0;
-        t.is_prepared        = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")));
+    return queryTracks(sql, {static_cast<qlonglong>(playlistId)}, "loadPlaylistSongs");
 }
 
 bool Database::updateSongAnalysis(long long songId, double bpm, const QString& key,
                                   int bitrate, const QString& duration)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    flushWriteBehind();
+
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "UPDATE songs SET bpm = ?, key_sig = ?, bitrate = ?, time = ? WHERE id = ?"));
     q.addBindValue(bpm);
     q.addBindValue(key);
     q.addBindValue(bitrate);
     q.addBindValue(duration);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "updateSongAnalysis failed for id" << songId << ":" << m_error;
         return false;
@@ -1369,11 +2290,12 @@ bool Database::updateSongAnalysis(long long songId, double bpm, const QString& k
 
 bool Database::updateSongPrepared(long long songId, bool prepared)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("UPDATE songs SET is_prepared = ? WHERE id = ?"));
+    flushWriteBehind();
+
+    QSqlQuery& q = cachedQuery(QStringLiteral("UPDATE songs SET is_prepared = ? WHERE id = ?"));
     q.addBindValue(prepared ? 1 : 0);
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "updateSongPrepared failed for id" << songId << ":" << m_error;
         return false;
@@ -1383,134 +2305,92 @@ bool Database::updateSongPrepared(long long songId, bool prepared)
 
 QVector<Track> Database::loadPreparedTracks()
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT id, title, artist, album, genre, bpm, rating, time, key_sig,
-               date_added, format, has_aiff, match_key, filepath,
-               color_label, bitrate, comment, play_count, date_played, energy,
-               mood_tags, style_tags, danceability, valence, vocal_prob, essentia_analyzed,
-               is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs WHERE is_prepared = 1 ORDER BY title ASC
-    )sql"));
-    if (!q.exec()) {
-        qWarning() << "loadPreparedTracks error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id               = q.value(0).toLongLong();
-        t.title            = q.value(1).toString().toStdString();
-        t.artist           = q.value(2).toString().toStdString();
-        t.album            = q.value(3).toString().toStdString();
-        t.genre            = q.value(4).toString().toStdString();
-        t.bpm              = q.value(5).toDouble();
-        t.rating           = q.value(6).toInt();
-        t.time             = q.value(7).toString().toStdString();
-        t.key_sig          = q.value(8).toString().toStdString();
-        t.date_added       = q.value(9).toString().toStdString();
-        t.format           = q.value(10).toString().toStdString();
-        t.has_aiff         = q.value(11).toInt() != 0;
-        t.match_key        = q.value(12).toString().toStdString();
-        t.filepath         = q.value(13).toString().toStdString();
-        t.color_label      = q.value(14).toInt();
-        t.bitrate          = q.value(15).toInt();
-        t.comment          = q.value(16).toString().toStdString();
-        t.play_count       = q.value(17).toInt();
-        t.date_played      = q.value(18).toString().toStdString();
-        t.energy           = q.value(19).toInt();
-        t.mood_tags        = q.value(20).toString().toStdString();
-        t.style_tags       = q.value(21).toString().toStdString();
-        t.danceability     = q.value(22).toFloat();
-        t.valence          = q.value(23).toFloat();
-        t.vocal_prob       = q.value(24).toFloat();
-        t.essentia_analyzed= q.value(25).toInt() != 0;
-        t.is_prepared      = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+    )sql").arg(TrackRowDecoder::columns());
+    return queryTracks(sql, {}, "loadPreparedTracks");
 }
 
 // ── Duplicate Detector ────────────────────────────────────────────────────────
 
-QVector<Database::DuplicatePair> Database::findDuplicateTracks()
+QVector<Database::DuplicateGroup> Database::findDuplicateGroups()
 {
-    QVector<DuplicatePair> result;
+    QVector<DuplicateGroup> result;
 
-    // Find tracks sharing the same artist+title (match_key) but different IDs.
-    // We normalise match_key to lower(artist)|||lower(title) on insert,
-    // so two rows with the same match_key are effectively the same song.
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT a.id, b.id
-        FROM songs a
-        JOIN songs b ON (
-            a.id < b.id AND (
-                (a.match_key = b.match_key AND a.match_key NOT LIKE 'file:%')
-                OR (
-                    lower(a.title) = lower(b.title)
-                    AND lower(a.artist) = lower(b.artist)
-                    AND a.title != ''
-                    AND a.artist != ''
-                )
-            )
+    // One pass over idx_songs_dup_key finds the keys used more than once; the
+    // member rows then come back in a single batch, ordered so each group is
+    // contiguous.
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1, dup_key
+        FROM songs
+        WHERE dup_key IN (
+            SELECT dup_key FROM songs
+            WHERE dup_key IS NOT NULL
+            GROUP BY dup_key
+            HAVING COUNT(*) > 1
         )
-        ORDER BY a.id
-    )sql"));
+        ORDER BY dup_key, id
+    )sql").arg(TrackRowDecoder::columns());
+    QSqlQuery& q = cachedQuery(sql);
 
-    if (!q.exec()) {
-        qWarning() << "findDuplicateTracks error:" << q.lastError().text();
+    if (!execCached(q)) {
+        qWarning() << "findDuplicateGroups error:" << q.lastError().text();
         return result;
     }
 
+    const int keyColumn = TrackRowDecoder::columnCount();
+    QString currentKey;
     while (q.next()) {
-        const long long idA = q.value(0).toLongLong();
-        const long long idB = q.value(1).toLongLong();
-        Track a = loadSongById(idA);
-        Track b = loadSongById(idB);
-        if (a.id > 0 && b.id > 0)
-            result.append({a, b});
+        const QString key = q.value(keyColumn).toString();
+        if (result.isEmpty() || key != currentKey) {
+            result.append(DuplicateGroup());
+            currentKey = key;
+        }
+        result.last().append(TrackRowDecoder::decode(q));
     }
 
-    qInfo() << "findDuplicateTracks:" << result.size() << "pairs";
+    qInfo() << "findDuplicateGroups:" << result.size() << "groups";
     return result;
 }
 
 // ── Play History ────────────────────────────────────────────────────────────
 
-bool Database::recordPlay(long long songId)
+bool Database::recordPlay(long long songId, const QDateTime& playedAt)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
-        "INSERT INTO play_history (song_id, played_at) VALUES (?, datetime('now','localtime'))"));
+    // Same text form as datetime('now','localtime').
+    const QString when = (playedAt.isValid() ? playedAt : QDateTime::currentDateTime())
+                             .toString(QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+    QSqlQuery& q = cachedQuery(QStringLiteral(
+        "INSERT INTO play_history (song_id, played_at) VALUES (?, ?)"));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    q.addBindValue(when);
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "recordPlay failed for id" << songId << ":" << m_error;
         return false;
     }
     // Also bump the songs.play_count and date_played
-    QSqlQuery uq(m_db);
-    uq.prepare(QStringLiteral(
+    QSqlQuery& uq = cachedQuery(QStringLiteral(
         "UPDATE songs SET play_count = play_count + 1, "
-        "date_played = datetime('now','localtime') WHERE id = ?"));
+        "date_played = ? WHERE id = ?"));
+    uq.addBindValue(when);
     uq.addBindValue(static_cast<qlonglong>(songId));
-    uq.exec();
+    execCached(uq);
     return true;
 }
 
 QStringList Database::loadHistoryDates(int limit)
 {
     QStringList dates;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         SELECT DISTINCT date(played_at) as d
         FROM play_history
         ORDER BY d DESC
         LIMIT ?
     )sql"));
     q.addBindValue(limit);
-    if (q.exec()) {
+    if (execCached(q)) {
         while (q.next())
             dates.append(q.value(0).toString());
     }
@@ -1519,173 +2399,46 @@ QStringList Database::loadHistoryDates(int limit)
 
 QVector<Track> Database::loadTracksPlayedOn(const QString& date)
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT DISTINCT s.id, s.title, s.artist, s.album, s.genre,
-               s.bpm, s.rating, s.time, s.key_sig, s.date_added,
-               s.format, s.has_aiff, s.match_key, s.filepath,
-               s.color_label, s.bitrate, s.comment, s.play_count, s.date_played, s.energy,
-               s.mood_tags, s.style_tags, s.danceability, s.valence, s.vocal_prob,
-               s.essentia_analyzed, s.is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT DISTINCT %1
         FROM songs s
         JOIN play_history ph ON ph.song_id = s.id
         WHERE date(ph.played_at) = ?
         ORDER BY ph.played_at DESC
-    )sql"));
-    q.addBindValue(date);
-    if (!q.exec()) {
-        qWarning() << "loadTracksPlayedOn error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id               = q.value(0).toLongLong();
-        t.title            = q.value(1).toString().toStdString();
-        t.artist           = q.value(2).toString().toStdString();
-        t.album            = q.value(3).toString().toStdString();
-        t.genre            = q.value(4).toString().toStdString();
-        t.bpm              = q.value(5).toDouble();
-        t.rating           = q.value(6).toInt();
-        t.time             = q.value(7).toString().toStdString();
-        t.key_sig          = q.value(8).toString().toStdString();
-        t.date_added       = q.value(9).toString().toStdString();
-        t.format           = q.value(10).toString().toStdString();
-        t.has_aiff         = q.value(11).toInt() != 0;
-        t.match_key        = q.value(12).toString().toStdString();
-        t.filepath         = q.value(13).toString().toStdString();
-        t.color_label      = q.value(14).toInt();
-        t.bitrate          = q.value(15).toInt();
-        t.comment          = q.value(16).toString().toStdString();
-        t.play_count       = q.value(17).toInt();
-        t.date_played      = q.value(18).toString().toStdString();
-        t.energy           = q.value(19).toInt();
-        t.mood_tags        = q.value(20).toString().toStdString();
-        t.style_tags       = q.value(21).toString().toStdString();
-        t.danceability     = q.value(22).toFloat();
-        t.valence          = q.value(23).toFloat();
-        t.vocal_prob       = q.value(24).toFloat();
-        t.essentia_analyzed= q.value(25).toInt() != 0;
-        t.is_prepared      = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")));
+    return queryTracks(sql, {date}, "loadTracksPlayedOn");
 }
 
 QVector<Track> Database::loadRecentlyPlayed(int limit)
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT DISTINCT s.id, s.title, s.artist, s.album, s.genre,
-               s.bpm, s.rating, s.time, s.key_sig, s.date_added,
-               s.format, s.has_aiff, s.match_key, s.filepath,
-               s.color_label, s.bitrate, s.comment, s.play_count, s.date_played, s.energy,
-               s.mood_tags, s.style_tags, s.danceability, s.valence, s.vocal_prob,
-               s.essentia_analyzed, s.is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT DISTINCT %1
         FROM songs s
         JOIN play_history ph ON ph.song_id = s.id
         ORDER BY ph.played_at DESC
         LIMIT ?
-    )sql"));
-    q.addBindValue(limit);
-    if (!q.exec()) {
-        qWarning() << "loadRecentlyPlayed error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id               = q.value(0).toLongLong();
-        t.title            = q.value(1).toString().toStdString();
-        t.artist           = q.value(2).toString().toStdString();
-        t.album            = q.value(3).toString().toStdString();
-        t.genre            = q.value(4).toString().toStdString();
-        t.bpm              = q.value(5).toDouble();
-        t.rating           = q.value(6).toInt();
-        t.time             = q.value(7).toString().toStdString();
-        t.key_sig          = q.value(8).toString().toStdString();
-        t.date_added       = q.value(9).toString().toStdString();
-        t.format           = q.value(10).toString().toStdString();
-        t.has_aiff         = q.value(11).toInt() != 0;
-        t.match_key        = q.value(12).toString().toStdString();
-        t.filepath         = q.value(13).toString().toStdString();
-        t.color_label      = q.value(14).toInt();
-        t.bitrate          = q.value(15).toInt();
-        t.comment          = q.value(16).toString().toStdString();
-        t.play_count       = q.value(17).toInt();
-        t.date_played      = q.value(18).toString().toStdString();
-        t.energy           = q.value(19).toInt();
-        t.mood_tags        = q.value(20).toString().toStdString();
-        t.style_tags       = q.value(21).toString().toStdString();
-        t.danceability     = q.value(22).toFloat();
-        t.valence          = q.value(23).toFloat();
-        t.vocal_prob       = q.value(24).toFloat();
-        t.essentia_analyzed= q.value(25).toInt() != 0;
-        t.is_prepared      = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+    )sql").arg(TrackRowDecoder::columns(QStringLiteral("s")));
+    return queryTracks(sql, {limit}, "loadRecentlyPlayed");
 }
 
 QVector<Track> Database::loadRecentlyAdded(int days)
 {
-    QVector<Track> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
-        SELECT id, title, artist, album, genre, bpm, rating, time, key_sig,
-               date_added, format, has_aiff, match_key, filepath,
-               color_label, bitrate, comment, play_count, date_played, energy,
-               mood_tags, style_tags, danceability, valence, vocal_prob,
-               essentia_analyzed, is_prepared
+    static const QString sql = QStringLiteral(R"sql(
+        SELECT %1
         FROM songs
         WHERE date_added >= date('now', ?)
         ORDER BY date_added DESC
-    )sql"));
-    q.addBindValue(QStringLiteral("-%1 days").arg(days));
-    if (!q.exec()) {
-        qWarning() << "loadRecentlyAdded error:" << q.lastError().text();
-        return result;
-    }
-    while (q.next()) {
-        Track t;
-        t.id               = q.value(0).toLongLong();
-        t.title            = q.value(1).toString().toStdString();
-        t.artist           = q.value(2).toString().toStdString();
-        t.album            = q.value(3).toString().toStdString();
-        t.genre            = q.value(4).toString().toStdString();
-        t.bpm              = q.value(5).toDouble();
-        t.rating           = q.value(6).toInt();
-        t.time             = q.value(7).toString().toStdString();
-        t.key_sig          = q.value(8).toString().toStdString();
-        t.date_added       = q.value(9).toString().toStdString();
-        t.format           = q.value(10).toString().toStdString();
-        t.has_aiff         = q.value(11).toInt() != 0;
-        t.match_key        = q.value(12).toString().toStdString();
-        t.filepath         = q.value(13).toString().toStdString();
-        t.color_label      = q.value(14).toInt();
-        t.bitrate          = q.value(15).toInt();
-        t.comment          = q.value(16).toString().toStdString();
-        t.play_count       = q.value(17).toInt();
-        t.date_played      = q.value(18).toString().toStdString();
-        t.energy           = q.value(19).toInt();
-        t.mood_tags        = q.value(20).toString().toStdString();
-        t.style_tags       = q.value(21).toString().toStdString();
-        t.danceability     = q.value(22).toFloat();
-        t.valence          = q.value(23).toFloat();
-        t.vocal_prob       = q.value(24).toFloat();
-        t.essentia_analyzed= q.value(25).toInt() != 0;
-        t.is_prepared      = q.value(26).toInt() != 0;
-        result.append(t);
-    }
-    return result;
+    )sql").arg(TrackRowDecoder::columns());
+    return queryTracks(sql, {QStringLiteral("-%1 days").arg(days)}, "loadRecentlyAdded");
 }
 
 bool Database::updateSongEssentiaAnalysis(long long songId, const QString& moodTags,
                                            const QString& styleTags, float danceability,
                                            float valence, float vocalProb)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(R"sql(
+    flushWriteBehind();
+
+    QSqlQuery& q = cachedQuery(QStringLiteral(R"sql(
         UPDATE songs SET mood_tags = ?, style_tags = ?, danceability = ?,
                          valence = ?, vocal_prob = ?, essentia_analyzed = 1
         WHERE id = ?
@@ -1696,7 +2449,7 @@ bool Database::updateSongEssentiaAnalysis(long long songId, const QString& moodT
     q.addBindValue(static_cast<double>(valence));
     q.addBindValue(static_cast<double>(vocalProb));
     q.addBindValue(static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         m_error = q.lastError().text();
         qWarning() << "updateSongEssentiaAnalysis failed for id" << songId << ":" << m_error;
         return false;
@@ -1724,13 +2477,15 @@ static CueType cueTypeFromString(const QString& s)
 
 QVector<CuePoint> Database::loadCuePoints(long long songId)
 {
+    if (m_writeBehind)
+        m_writeBehind->flush();
+
     QVector<CuePoint> result;
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "SELECT id, song_id, cue_type, slot, position_ms, end_ms, name, color, sort_order "
         "FROM cue_points WHERE song_id = :sid ORDER BY sort_order, position_ms"));
     q.bindValue(QStringLiteral(":sid"), static_cast<qlonglong>(songId));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "loadCuePoints error:" << q.lastError().text();
         return result;
     }
@@ -1752,8 +2507,7 @@ QVector<CuePoint> Database::loadCuePoints(long long songId)
 
 bool Database::insertCuePoint(CuePoint& cue)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "INSERT INTO cue_points "
         "(song_id, cue_type, slot, position_ms, end_ms, name, color, sort_order) "
         "VALUES (:sid, :type, :slot, :pos, :end, :name, :color, :ord)"));
@@ -1765,7 +2519,7 @@ bool Database::insertCuePoint(CuePoint& cue)
     q.bindValue(QStringLiteral(":name"),  QString::fromStdString(cue.name));
     q.bindValue(QStringLiteral(":color"), cue.color);
     q.bindValue(QStringLiteral(":ord"),   cue.sort_order);
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "insertCuePoint error:" << q.lastError().text();
         return false;
     }
@@ -1775,8 +2529,7 @@ bool Database::insertCuePoint(CuePoint& cue)
 
 bool Database::updateCuePoint(const CuePoint& cue)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "UPDATE cue_points SET slot=:slot, position_ms=:pos, end_ms=:end, "
         "name=:name, color=:color, sort_order=:ord WHERE id=:id"));
     q.bindValue(QStringLiteral(":slot"),  cue.slot);
@@ -1786,7 +2539,7 @@ bool Database::updateCuePoint(const CuePoint& cue)
     q.bindValue(QStringLiteral(":color"), cue.color);
     q.bindValue(QStringLiteral(":ord"),   cue.sort_order);
     q.bindValue(QStringLiteral(":id"),    static_cast<qlonglong>(cue.id));
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "updateCuePoint error:" << q.lastError().text();
         return false;
     }
@@ -1795,41 +2548,38 @@ bool Database::updateCuePoint(const CuePoint& cue)
 
 bool Database::deleteCuePoint(long long cueId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("DELETE FROM cue_points WHERE id=:id"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM cue_points WHERE id=:id"));
     q.bindValue(QStringLiteral(":id"), static_cast<qlonglong>(cueId));
-    return q.exec();
+    return execCached(q);
 }
 
 bool Database::deleteAllCuePoints(long long songId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("DELETE FROM cue_points WHERE song_id=:sid"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("DELETE FROM cue_points WHERE song_id=:sid"));
     q.bindValue(QStringLiteral(":sid"), static_cast<qlonglong>(songId));
-    return q.exec();
+    return execCached(q);
 }
 
 // ── Waveform Cache ──────────────────────────────────────────────────────────
 
 QByteArray Database::loadWaveformOverview(long long songId)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral("SELECT peaks FROM waveform_cache WHERE song_id=:sid"));
+    QSqlQuery& q = cachedQuery(QStringLiteral("SELECT peaks FROM waveform_cache WHERE song_id=:sid"));
+    const StatementScope scope(q);
     q.bindValue(QStringLiteral(":sid"), static_cast<qlonglong>(songId));
-    if (!q.exec() || !q.next())
+    if (!execCached(q) || !q.next())
         return {};
     return q.value(0).toByteArray();
 }
 
 bool Database::saveWaveformOverview(long long songId, const QByteArray& peaks)
 {
-    QSqlQuery q(m_db);
-    q.prepare(QStringLiteral(
+    QSqlQuery& q = cachedQuery(QStringLiteral(
         "INSERT OR REPLACE INTO waveform_cache (song_id, peaks, generated_at) "
         "VALUES (:sid, :peaks, datetime('now'))"));
     q.bindValue(QStringLiteral(":sid"),   static_cast<qlonglong>(songId));
     q.bindValue(QStringLiteral(":peaks"), peaks);
-    if (!q.exec()) {
+    if (!execCached(q)) {
         qWarning() << "saveWaveformOverview error:" << q.lastError().text();
         return false;
     }
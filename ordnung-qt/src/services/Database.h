@@ -5,12 +5,27 @@
 #include <QString>
 #include <QVector>
 #include <QMap>
+#include <QHash>
+#include <QCache>
+#include <QVariant>
+#include <QDateTime>
 
 #include "core/Track.h"
 #include "core/Playlist.h"
 #include "core/ConversionJob.h"
 #include "core/CuePoint.h"
 
+class QSqlQuery;
+class DatabasePool;
+class WriteBehindQueue;
+class TrackQuery;
+class StatementTracer;
+
+#ifdef HAVE_SQLITE3_DIRECT
+struct sqlite3;
+struct sqlite3_stmt;
+#endif
+
 // WatchConfig mirrors the config table rows we care about.
 struct WatchConfig {
     QString watchFolder;
@@ -18,6 +33,26 @@ struct WatchConfig {
     bool    autoConvert   = true;
 };
 
+// SqliteProfile: per-connection performance pragmas. Chosen by the config
+// row 'sqlite_profile' (safe | balanced | fast); 'sqlite_synchronous',
+// 'sqlite_mmap_size', 'sqlite_cache_size_kib', 'sqlite_temp_store' and
+// 'sqlite_page_size' override single values. Changes apply on next launch.
+struct SqliteProfile {
+    QString name         = QStringLiteral("balanced");
+    QString synchronous  = QStringLiteral("NORMAL");   // durable under WAL except on power loss
+    qint64  mmapSize     = 256LL * 1024 * 1024;
+    int     cacheSizeKiB = 32 * 1024;                  // per connection
+    bool    tempInMemory = true;
+    int     pageSize     = 8192;                       // new databases only
+};
+
+// SongOrder: one ORDER BY term for Database::findTrackIds.
+struct SongOrder {
+    enum Field { Title, Artist, Bpm, KeySig, Duration, Format, ColorLabel, Prepared, Bitrate, Comment };
+    Field field      = Title;
+    bool  descending = false;
+};
+
 // PlaylistMembership: used by TrackDetailPanel to show/toggle playlist chips.
 struct PlaylistMembership {
     long long   id;
@@ -32,11 +67,37 @@ public:
     explicit Database(QObject* parent = nullptr);
     ~Database() override;
 
+    // Primary runs the schema migrations; Reader connections are query-only;
+    // Writer is the pool's serialized write connection (see DatabasePool).
+    enum class Role { Primary, Reader, Writer };
+
     // Opens (or creates) the DB at the standard app data path.
     // Returns false on failure; errorString() populated.
     bool open();
+    bool open(const QString& path, Role role = Role::Primary);
     QString errorString() const { return m_error; }
 
+    // The profile this connection was opened with. setSqliteProfile() before
+    // open() overrides the config table (used by the benchmark).
+    const SqliteProfile& sqliteProfile() const { return m_profile; }
+    void setSqliteProfile(const SqliteProfile& profile);
+    // Built-in profile by name; unknown names give "balanced".
+    static SqliteProfile sqliteProfileNamed(const QString& name);
+
+    // Runs PRAGMA optimize, which re-ANALYZEs tables whose statistics have
+    // gone stale. The primary connection also does this hourly and on close.
+    void optimize();
+
+    // <app data>/eyebags.db; creates the directory. Empty on failure.
+    static QString defaultPath();
+
+    // The pool this connection belongs to, or nullptr for a standalone Database.
+    DatabasePool* pool() const { return m_pool; }
+
+    // Batched, coalesced writes for interactive edits (see WriteBehindQueue).
+    // Only the primary connection has one; nullptr for readers and the writer.
+    WriteBehindQueue* writeBehind() const { return m_writeBehind; }
+
     // ── Playlists ──────────────────────────────────────────────────────────────
     QVector<Playlist> loadPlaylists();
     // Returns the new playlist id, or -1 on failure.
@@ -44,8 +105,11 @@ public:
     bool deletePlaylist(long long id);
 
     // ── Songs ──────────────────────────────────────────────────────────────────
-    // Load all tracks for a playlist (paginated for canFetchMore support).
-    QVector<Track> loadTracks(long long playlistId, int offset, int limit);
+    // Load a page of a playlist in (title, id) order, seeking from the row
+    // with that key (exclusive). Pass an empty (or null) title and id 0 for
+    // the first page.
+    QVector<Track> loadTracksAfter(long long playlistId, const QString& title,
+                                   long long id, int limit);
     int            countTracks(long long playlistId);
 
     // Dedup-aware insert: returns song_id (existing or new), -1 on error.
@@ -61,6 +125,12 @@ public:
     // Always returns a Track with id > 0 on success, id == -1 on DB error.
     Track syncFromDisk(const Track& scanTrack);
 
+    // Batched syncFromDisk for a whole scan: stages the files in a temp table,
+    // resolves existing match_keys with one join and inserts/updates everything
+    // in a single transaction. Returns the merged rows in scan order; entries
+    // that could not be stored have id == -1.
+    QVector<Track> syncFromDiskBatch(const QVector<Track>& scanTracks);
+
     // Load a full song row by its primary key. Returns a default-constructed Track on failure.
     Track loadSongById(long long id);
 
@@ -115,13 +185,56 @@ public:
     bool deleteAllCuePoints(long long songId);
 
     // ── FTS5 Search ─────────────────────────────────────────────────────────
-    // Full-text search across title/artist/album/genre/comment using FTS5 BM25 ranking.
-    // Returns matching tracks ordered by relevance. Empty query returns all tracks.
-    QVector<Track> searchTracks(const QString& query);
+    // Search with the TrackQuery language: free text runs through FTS5 (BM25
+    // ranking), field filters such as bpm:122-128 or key:8A,9A through the
+    // songs indexes. Returns limit rows from offset (limit < 0: every match).
+    // An empty or invalid query matches nothing; errorString() explains the latter.
+    QVector<Track> searchTracks(const QString& query, int limit = -1, int offset = 0);
+
+    // Number of tracks searchTracks(query) would return, without loading them.
+    int countSearchMatches(const QString& query);
+
+    // Parsed-query forms of the above, optionally limited to tracks under
+    // folderPrefix (same range as loadLibrarySongs).
+    QVector<Track> findTracks(const TrackQuery& query, const QString& folderPrefix = QString(),
+                              int limit = -1, int offset = 0);
+    int countMatches(const TrackQuery& query, const QString& folderPrefix = QString());
+
+    // ── Windowed access ─────────────────────────────────────────────────────
+    // Ids of the tracks findTracks would return, ordered by order (then id)
+    // or, with no order, as findTracks orders them. Ids only: a million rows
+    // cost 8 MB, and rows are loaded a page at a time with loadSongsByIds.
+    QVector<long long> findTrackIds(const TrackQuery& query, const QString& folderPrefix = QString(),
+                                    const QVector<SongOrder>& order = {});
+    // Rows for ids, in the order given; ids with no row are skipped.
+    QVector<Track> loadSongsByIds(const QVector<long long>& ids);
+
+    // ── Smart Playlists ─────────────────────────────────────────────────────
+    // A smart playlist is a TrackQuery plus a sort. Its members are stored in
+    // smart_playlist_songs, so opening one is a join on that table rather
+    // than a search. Song writes queue the songs they touch; the loaders
+    // below first apply that queue (refreshSmartPlaylists), re-testing only
+    // the queued songs against each playlist's rules. total counts the members
+    // under folderPrefix, as loadSmartPlaylistTracks returns them.
+    QVector<SmartPlaylist> loadSmartPlaylists(const QString& folderPrefix = QString());
+    // Members of a smart playlist in its sort order, optionally limited to
+    // tracks under folderPrefix (same range as loadLibrarySongs).
+    QVector<Track> loadSmartPlaylistTracks(long long id, const QString& folderPrefix = QString());
+    // Returns the new id, or -1 if query does not parse (errorString() says
+    // why) or the insert failed. Membership is built before returning.
+    long long insertSmartPlaylist(const QString& name, const QString& query,
+                                  const QString& sortField = QStringLiteral("title"),
+                                  bool descending = false);
+    // Replaces the rules and rebuilds the membership from scratch.
+    bool updateSmartPlaylistQuery(long long id, const QString& query);
+    bool deleteSmartPlaylist(long long id);
+    // Re-tests the queued songs against every smart playlist; one whose
+    // rules do not parse is emptied. Needs a writable connection; on a
+    // reader the loaders hand it to the pool's writer instead.
+    bool refreshSmartPlaylists();
 
     // ── Missing File Relocator ──────────────────────────────────────────────
-    // Returns all tracks whose filepath does not exist on disk.
-    QVector<Track> findMissingTracks();
+    // Detection lives in MissingFileScanner, which checks paths off the GUI thread.
 
     // Update the filepath for a track (after user relocates the file).
     bool updateTrackFilepath(long long songId, const QString& newPath);
@@ -153,14 +266,14 @@ public:
     QVector<Track> loadPreparedTracks();
 
     // ── Duplicate Detector ──────────────────────────────────────────────────────
-    // Returns pairs of tracks sharing the same match_key (different filepaths) or
-    // same artist+title but different IDs. Each inner pair is {keepCandidate, duplicate}.
-    struct DuplicatePair { Track a; Track b; };
-    QVector<DuplicatePair> findDuplicateTracks();
+    // Returns clusters of tracks sharing the same case-folded artist + title
+    // (songs.dup_key). Every group holds two or more tracks, ordered by id.
+    using DuplicateGroup = QVector<Track>;
+    QVector<DuplicateGroup> findDuplicateGroups();
 
     // ── Play History ───────────────────────────────────────────────────────────
-    // Record that a track was played now.
-    bool recordPlay(long long songId);
+    // Record that a track was played at playedAt (now if invalid).
+    bool recordPlay(long long songId, const QDateTime& playedAt = QDateTime());
     // Load recent play history ordered by played_at DESC.
     // Returns distinct date strings (YYYY-MM-DD) that have history entries.
     QStringList loadHistoryDates(int limit = 30);
@@ -175,9 +288,85 @@ public:
     // Check whether a filepath is already tracked in downloads.
     bool downloadExists(const QString& filepath);
 
+    // Prepared-statement cache counters (hits = reused, misses = freshly prepared).
+    struct StatementCacheStats { int hits = 0; int misses = 0; int size = 0; };
+    StatementCacheStats statementCacheStats() const;
+
 private:
-    void runMigrations();
+    friend class DatabasePool;
+    friend class WriteBehindQueue;
+
+    // Brings the schema up to schemaVersion(); see the migration list in the .cpp.
+    bool runMigrations();
+    SqliteProfile readSqliteProfile();
+    void applySqliteProfile(bool newDatabase);
+    static int schemaVersion();
+
+    // refreshSmartPlaylists on this connection, or on the pool's writer
+    // when this one is query-only.
+    bool syncSmartPlaylists();
+    // Drops and re-selects one playlist's members; inside a transaction.
+    bool materializeSmartPlaylist(long long id, const TrackQuery& query);
+
+    // Returns the cached prepared statement for sql, preparing it on first use.
+    // The query is reset but keeps its previous bindings; rebind every
+    // placeholder before exec(). The least recently used statement is
+    // finalized once kMaxCachedStatements are cached, so a reference stays
+    // valid only while fewer than that many other statements are fetched.
+    QSqlQuery& cachedQuery(const QString& sql);
+    // q.exec(), timed by the tracer when it cannot hook the connection itself.
+    // Use it for queries from cachedQuery().
+    bool execCached(QSqlQuery& q);
+    // Opens a transaction that takes the write lock at once. Under WAL a
+    // deferred transaction that reads before it writes cannot upgrade once
+    // another connection has committed (SQLITE_BUSY_SNAPSHOT, which
+    // busy_timeout does not retry); use this for read-then-write work.
+    // End it with m_db.commit()/rollback() as usual.
+    bool beginImmediate();
+
+    // Writes the write-behind queue's held-back edits. Every direct writer
+    // of songs calls it first, so a queued row (which carries every edited
+    // column) never lands on top of a newer direct write.
+    void flushWriteBehind();
+
+    // Returns the id of the song with this match_key, or -1 if none.
+    long long songIdForMatchKey(const QString& matchKey);
+
+    // Runs a SELECT whose columns are TrackRowDecoder::columns() and decodes
+    // every row. binds are positional; caller names the loader for warnings.
+    QVector<Track> queryTracks(const QString& sql, const QVariantList& binds,
+                               const char* caller);
+
     QSqlDatabase m_db;
     QString      m_error;
     QString      m_connectionName;
+    DatabasePool* m_pool = nullptr;
+    WriteBehindQueue* m_writeBehind = nullptr;
+    SqliteProfile m_profile;
+    bool          m_profileOverride = false;
+    Role          m_role = Role::Primary;
+
+    // Generated SQL (IN lists, search shapes) is unbounded; keep the hot set.
+    static constexpr int kMaxCachedStatements = 256;
+
+    QCache<QString, QSqlQuery> m_stmtCache{kMaxCachedStatements};
+    int                        m_stmtHits   = 0;
+    int                        m_stmtMisses = 0;
+
+    // Opt-in statement timing and slow-query log (see StatementTracer).
+    StatementTracer*           m_tracer = nullptr;
+
+#ifdef HAVE_SQLITE3_DIRECT
+    // Raw statement cache used by queryTracks. m_rawDb is QSQLITE's own
+    // connection handle, set only when it runs on the SQLite we link against.
+    sqlite3_stmt* cachedRawStatement(const QString& sql);
+
+    struct RawStatement {
+        sqlite3_stmt* stmt = nullptr;
+        ~RawStatement();   // finalizes, also on eviction
+    };
+
+    sqlite3*                           m_rawDb = nullptr;
+    QCache<QString, RawStatement>      m_rawStmtCache{kMaxCachedStatements};
+#endif
 };
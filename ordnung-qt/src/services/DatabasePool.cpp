@@ -0,0 +1,156 @@
+#include "DatabasePool.h"
+#include "Database.h"
+#include "WriteBehindQueue.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QDebug>
+
+#include <memory>
+
+// ─────────────────────────────────────────────────────────────────────────────
+
+DatabasePool::DatabasePool(QObject* parent)
+    : QObject(parent)
+    , m_primary(new Database(this))
+{
+    // Exists even if open() fails, so callers always hold a live (if
+    // closed) Database, as they did before the pool.
+    m_primary->m_pool = this;
+
+    // Keep reader threads (and their connections) alive between requests.
+    m_readThreads.setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 4));
+    m_readThreads.setExpiryTimeout(-1);
+}
+
+DatabasePool::~DatabasePool()
+{
+    m_closing = true;
+    for (QFuture<void>& f : m_channels)
+        f.cancel();
+    m_readThreads.waitForDone();
+
+    if (m_writerThread) {
+        // Drain queued writes, then stop; the writer connection is deleted on
+        // its own thread via the finished() -> deleteLater hookup.
+        flush();
+        m_writerThread->quit();
+        m_writerThread->wait();
+        m_writer = nullptr;
+    }
+    qInfo() << "DatabasePool: closing," << m_readerCount.load() << "reader connections opened";
+    // Reader connections belong to their threads and close when those exit.
+}
+
+bool DatabasePool::open()
+{
+    const QString dbPath = Database::defaultPath();
+    if (dbPath.isEmpty()) {
+        m_error = QStringLiteral("Cannot create app data directory");
+        return false;
+    }
+    return open(dbPath);
+}
+
+bool DatabasePool::open(const QString& path)
+{
+    m_path = path;
+
+    if (!m_primary->open(path, Database::Role::Primary)) {
+        m_error = m_primary->errorString();
+        return false;
+    }
+
+    m_writerThread = new QThread(this);
+    m_writerThread->setObjectName(QStringLiteral("DatabaseWriter"));
+    m_writer = new Database;
+    m_writer->m_pool = this;
+    m_writer->moveToThread(m_writerThread);
+    connect(m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+    m_writerThread->start();
+
+    bool ok = false;
+    QMetaObject::invokeMethod(m_writer, [this, &ok] {
+        ok = m_writer->open(m_path, Database::Role::Writer);
+    }, Qt::BlockingQueuedConnection);
+    if (!ok) {
+        m_error = m_writer->errorString();
+        qWarning() << "DatabasePool: writer connection failed:" << m_error;
+        return false;
+    }
+    return true;
+}
+
+Database* DatabasePool::reader()
+{
+    if (QThread::currentThread() == thread())
+        return m_primary;
+    if (QThread::currentThread() == m_writerThread)
+        return m_writer;
+
+    if (!m_readers.hasLocalData()) {
+        auto* db = new Database;  // owned by this thread's storage
+        db->m_pool = this;
+        if (!db->open(m_path, Database::Role::Reader))
+            qWarning() << "DatabasePool: reader connection failed:" << db->errorString();
+        m_readers.setLocalData(db);
+        ++m_readerCount;
+    }
+    return m_readers.localData();
+}
+
+void DatabasePool::post(std::function<void(Database&)> fn)
+{
+    runOnWriter([this, fn = std::move(fn)] { fn(*m_writer); }, false);
+}
+
+void DatabasePool::flush()
+{
+    // Queued calls run in order, so an empty blocking call is a barrier.
+    runOnWriter([] {}, true);
+}
+
+void DatabasePool::flushWriteBehind()
+{
+    if (!m_primary || !m_primary->writeBehind())
+        return;
+    if (QThread::currentThread() == thread()) {
+        m_primary->writeBehind()->flush();
+        return;
+    }
+
+    // Not BlockingQueuedConnection: the destructor waits for reader threads
+    // on the GUI thread, and would never get to run the flush.
+    auto done = std::make_shared<QSemaphore>();
+    QMetaObject::invokeMethod(m_primary, [this, done] {
+        m_primary->writeBehind()->flush();
+        done->release();
+    }, Qt::QueuedConnection);
+    while (!done->tryAcquire(1, 50)) {
+        if (m_closing)
+            return;
+    }
+}
+
+void DatabasePool::cancelReads(const QString& channel)
+{
+    const auto it = m_channels.find(channel);
+    if (it != m_channels.end()) {
+        it->cancel();
+        m_channels.erase(it);
+    }
+}
+
+void DatabasePool::runOnWriter(const std::function<void()>& fn, bool wait)
+{
+    if (!m_writer) {
+        qWarning() << "DatabasePool: write submitted without an open writer";
+        return;
+    }
+    if (QThread::currentThread() == m_writerThread) {
+        fn();
+        return;
+    }
+    QMetaObject::invokeMethod(m_writer, fn,
+        wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+}
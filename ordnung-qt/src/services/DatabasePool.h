@@ -0,0 +1,137 @@
+#pragma once
+
+#include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <functional>
+#include <type_traits>
+
+class Database;
+class QThread;
+
+// DatabasePool — one SQLite connection per thread.
+//
+// A QSqlDatabase connection may only be used from the thread that opened it,
+// so nothing outside the GUI thread may touch primary(). Instead:
+//   - read() runs a function on a query-only reader connection owned by one
+//     of the pool's own threads, opened on first use. WAL lets these read in
+//     parallel with each other and with the writer. Readers are only ever
+//     opened on those threads: the pool waits for them when it closes, which
+//     it could not do for QtConcurrent's global pool or a caller's own.
+//   - write()/post() run a function on the single writer connection, which
+//     lives on its own thread and executes submissions one at a time in
+//     arrival order.
+//
+// Not every write goes through the writer yet: the GUI thread keeps writing
+// through primary() (directly, or batched by its WriteBehindQueue), because
+// many of those callers need the result at once (new ids, row counts).
+// busy_timeout on every connection makes the two wait for each other rather
+// than fail. Worker threads must use write()/post(), never primary().
+//
+// read() is the asynchronous side for the GUI: it runs a query on a reader
+// connection in the pool's own thread pool and returns a QFuture. Reads are
+// grouped into channels (one per view slot that shows the result); starting
+// a read cancels the previous one on the same channel, so the latest request
+// wins and a slow, superseded load never overwrites a newer one.
+class DatabasePool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DatabasePool(QObject* parent = nullptr);
+    ~DatabasePool() override;
+
+    // Opens the primary connection (running migrations) and the writer.
+    // Returns false on failure; errorString() populated.
+    bool open();
+    bool open(const QString& path);
+    QString errorString() const { return m_error; }
+    QString path() const { return m_path; }
+
+    // GUI-thread connection. Never use from another thread. Never null: if
+    // open() failed it is a closed Database whose calls fail.
+    Database* primary() const { return m_primary; }
+
+    // Runs fn(writer) on the writer thread and waits for its result.
+    template<typename Fn>
+    auto write(Fn fn) -> std::invoke_result_t<Fn, Database&>;
+
+    // Queues fn(writer) on the writer thread and returns immediately.
+    void post(std::function<void(Database&)> fn);
+
+    // Blocks until every write submitted so far has run.
+    void flush();
+
+    // Runs fn(reader) on a worker thread. A cancelled read skips the query if
+    // it has not started yet and never reports a result. GUI thread only.
+    // Pending write-behind edits are flushed first, so the read sees them.
+    template<typename T>
+    QFuture<T> read(const QString& channel, std::function<T(Database&)> fn);
+
+    // Cancels whatever is in flight on channel.
+    void cancelReads(const QString& channel);
+
+    // Writes the primary connection's held-back edits so a read sees them.
+    // From another thread it runs on the GUI thread and waits for it, giving
+    // up if the pool starts closing meanwhile (the GUI thread may be waiting
+    // for this very reader).
+    void flushWriteBehind();
+
+private:
+    // The calling thread's connection (primary on the GUI thread, the writer
+    // on the writer thread, else a reader); opened lazily, closed when the
+    // thread exits. Only read() calls it off the GUI thread.
+    Database* reader();
+
+    void runOnWriter(const std::function<void()>& fn, bool wait);
+
+    QString    m_path;
+    QString    m_error;
+    Database*  m_primary      = nullptr;
+    Database*  m_writer       = nullptr;
+    QThread*   m_writerThread = nullptr;
+
+    QThreadStorage<Database*> m_readers;
+    std::atomic<int>          m_readerCount{0};
+    std::atomic<bool>         m_closing{false};
+
+    // Declared after m_readers: its threads (and their reader connections)
+    // must finish before the thread storage goes away.
+    QThreadPool                   m_readThreads;
+    QHash<QString, QFuture<void>> m_channels;
+};
+
+template<typename Fn>
+auto DatabasePool::write(Fn fn) -> std::invoke_result_t<Fn, Database&>
+{
+    using Result = std::invoke_result_t<Fn, Database&>;
+    if constexpr (std::is_void_v<Result>) {
+        runOnWriter([&] { fn(*m_writer); }, true);
+    } else {
+        Result result{};
+        runOnWriter([&] { result = fn(*m_writer); }, true);
+        return result;
+    }
+}
+
+template<typename T>
+QFuture<T> DatabasePool::read(const QString& channel, std::function<T(Database&)> fn)
+{
+    cancelReads(channel);
+    flushWriteBehind();
+    QFuture<T> future = QtConcurrent::run(&m_readThreads,
+        [this, fn = std::move(fn)](QPromise<T>& promise) {
+            if (promise.isCanceled())
+                return;
+            T result = fn(*reader());
+            if (!promise.isCanceled())
+                promise.addResult(std::move(result));
+        });
+    m_channels.insert(channel, QFuture<void>(future));
+    return future;
+}
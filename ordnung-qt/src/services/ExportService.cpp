@@ -1,11 +1,14 @@
 #include "ExportService.h"
 #include "Database.h"
+#include "DatabasePool.h"
 #include "PdbWriter.h"
+#include "WriteBehindQueue.h"
 
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QMap>
+#include <QPromise>
 #include <QXmlStreamWriter>
 #include <QtConcurrent>
 #include <QDebug>
@@ -19,51 +22,92 @@ ExportService::ExportService(Database* db, QObject* parent)
 
 // ── Public API ──────────────────────────────────────────────────────────────
 
-void ExportService::startExport(const ExportOptions& opts)
-{
-    m_cancelled.store(false);
+namespace {
 
-    // Capture a pointer for the lambda (ExportService must outlive the future).
-    (void)QtConcurrent::run([this, opts]() {
-        // 1. Gather playlists
-        QVector<Playlist> playlists = m_db->loadPlaylists();
-        if (!opts.playlistIds.isEmpty()) {
-            QVector<Playlist> filtered;
-            for (const auto& p : playlists) {
-                if (opts.playlistIds.contains(p.id))
-                    filtered.append(p);
-            }
-            playlists = filtered;
+// Everything an export writes, read in one go.
+struct ExportData {
+    QVector<Playlist>                  playlists;
+    QMap<long long, QVector<Track>>    playlistTracks;
+    QVector<Track>                     allTracks;   // de-duplicated
+    QMap<long long, QVector<CuePoint>> cueMap;
+};
+
+ExportData gatherExport(Database& db, const QVector<long long>& playlistIds)
+{
+    ExportData data;
+
+    // 1. Gather playlists
+    data.playlists = db.loadPlaylists();
+    if (!playlistIds.isEmpty()) {
+        QVector<Playlist> filtered;
+        for (const auto& p : std::as_const(data.playlists)) {
+            if (playlistIds.contains(p.id))
+                filtered.append(p);
         }
+        data.playlists = filtered;
+    }
+
+    // 2. Gather tracks per playlist and build a de-duplicated master list
+    QMap<long long, Track> seenTracks;  // id -> Track
+    for (const auto& pl : std::as_const(data.playlists)) {
+        QVector<Track> tracks = db.loadPlaylistSongs(pl.id);
+        data.playlistTracks[pl.id] = tracks;
+        for (const auto& t : tracks)
+            seenTracks.insert(t.id, t);
+    }
+    data.allTracks.reserve(seenTracks.size());
+    for (auto it = seenTracks.cbegin(); it != seenTracks.cend(); ++it)
+        data.allTracks.append(it.value());
+
+    // 3. Load cue points for every track
+    for (const auto& t : std::as_const(data.allTracks))
+        data.cueMap[t.id] = db.loadCuePoints(t.id);
+    return data;
+}
 
-        // 2. Gather tracks per playlist and build a de-duplicated master list
-        QMap<long long, QVector<Track>> playlistTracks;
-        QMap<long long, Track> seenTracks;  // id -> Track
+} // namespace
 
-        for (const auto& pl : playlists) {
-            QVector<Track> tracks = m_db->loadPlaylistSongs(pl.id);
-            playlistTracks[pl.id] = tracks;
-            for (const auto& t : tracks)
-                seenTracks.insert(t.id, t);
-        }
+void ExportService::startExport(const ExportOptions& opts)
+{
+    m_cancelled.store(false);
 
-        QVector<Track> allTracks;
-        allTracks.reserve(seenTracks.size());
-        for (auto it = seenTracks.cbegin(); it != seenTracks.cend(); ++it)
-            allTracks.append(it.value());
+    // The export reads through another connection: write out held-back edits
+    // (and anything queued on the pool writer) first.
+    if (m_db->writeBehind())
+        m_db->writeBehind()->flush();
+
+    // Reads go through the pool, whose reader threads it owns and waits for;
+    // a thread of the global pool must not open a pool connection. Without a
+    // pool the data is read here, on m_db's own thread.
+    QFuture<ExportData> data;
+    if (DatabasePool* pool = m_db->pool()) {
+        pool->flush();
+        data = pool->read<ExportData>(QStringLiteral("export"),
+            [ids = opts.playlistIds](Database& db) { return gatherExport(db, ids); });
+    } else {
+        QPromise<ExportData> ready;
+        data = ready.future();
+        ready.start();
+        ready.addResult(gatherExport(*m_db, opts.playlistIds));
+        ready.finish();
+    }
 
-        // 3. Load cue points for every track
-        QMap<long long, QVector<CuePoint>> cueMap;
-        for (const auto& t : allTracks)
-            cueMap[t.id] = m_db->loadCuePoints(t.id);
+    // Capture a pointer for the lambda (ExportService must outlive the future).
+    (void)QtConcurrent::run([this, opts, data]() mutable {
+        data.waitForFinished();
+        if (data.isCanceled() || data.resultCount() == 0) {
+            emit finished(false, QStringLiteral("Export cancelled: library read was interrupted"));
+            return;
+        }
+        const ExportData d = data.result();
 
         // 4. Dispatch to the appropriate writer
         QString err;
         if (opts.target == ExportOptions::RekordboxXml) {
-            err = writeRekordboxXml(opts.outputPath, playlists, playlistTracks,
-                                    allTracks, cueMap);
+            err = writeRekordboxXml(opts.outputPath, d.playlists, d.playlistTracks,
+                                    d.allTracks, d.cueMap);
         } else {
-            err = writeCdjUsb(opts, playlists, playlistTracks, allTracks, cueMap);
+            err = writeCdjUsb(opts, d.playlists, d.playlistTracks, d.allTracks, d.cueMap);
         }
 
         emit finished(err.isEmpty(), err);
@@ -0,0 +1,162 @@
+#include "MissingFileScanner.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QStorageInfo>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <algorithm>
+#include <memory>
+
+// Concurrent directory checks per volume. High enough to hide network latency
+// on a NAS, low enough not to thrash a single spinning disk.
+static constexpr int kLanesPerVolume = 4;
+
+namespace {
+
+struct DirectoryJob {
+    QString        dir;
+    QVector<Track> tracks;
+};
+
+// Returns the tracks in job whose file is missing. One stat for the
+// directory itself, then one listing instead of a stat per file.
+//
+// A name that matches a listed file only up to case is stat'ed after all:
+// on case-insensitive volumes (the macOS and Windows defaults) that file
+// opens fine under the stored spelling, on case-sensitive ones it does not.
+QVector<Track> checkDirectory(const DirectoryJob& job)
+{
+    if (!QFileInfo::exists(job.dir))
+        return job.tracks;
+
+    const QStringList entries = QDir(job.dir).entryList(
+        QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    const QSet<QString> present(entries.begin(), entries.end());
+    QSet<QString> folded;
+    folded.reserve(entries.size());
+    for (const QString& e : entries)
+        folded.insert(e.toCaseFolded());
+
+    QVector<Track> missing;
+    for (const Track& t : job.tracks) {
+        const QString path = QString::fromStdString(t.filepath);
+        const QString name = QFileInfo(path).fileName();
+        if (present.contains(name))
+            continue;
+        if (folded.contains(name.toCaseFolded()) && QFileInfo::exists(path))
+            continue;
+        missing.append(t);
+    }
+    return missing;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+
+MissingFileScanner::MissingFileScanner(QObject* parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(qMax(4, QThread::idealThreadCount()));
+}
+
+MissingFileScanner::~MissingFileScanner()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void MissingFileScanner::cancel()
+{
+    ++m_generation;
+    m_running.store(false);
+}
+
+int MissingFileScanner::start(std::function<QVector<Track>()> loadTracks)
+{
+    const int generation = ++m_generation;
+    m_running.store(true);
+
+    (void)QtConcurrent::run(&m_pool, [this, generation, loadTracks]() {
+        auto live = [this, generation] { return m_generation.load() == generation; };
+
+        const QVector<Track> tracks = loadTracks();
+        if (!live())
+            return;
+
+        // 1. Group tracks by directory.
+        QHash<QString, DirectoryJob> byDir;
+        int checked = 0;
+        for (const Track& t : tracks) {
+            if (t.filepath.empty())
+                continue;
+            const QString dir = QFileInfo(QString::fromStdString(t.filepath)).absolutePath();
+            DirectoryJob& job = byDir[dir];
+            job.dir = dir;
+            job.tracks.append(t);
+            ++checked;
+        }
+
+        // 2. Group directories by volume. Mount points are matched by path
+        //    prefix, so this costs no extra stat per directory.
+        QList<QStorageInfo> volumes = QStorageInfo::mountedVolumes();
+        std::sort(volumes.begin(), volumes.end(), [](const QStorageInfo& a, const QStorageInfo& b) {
+            return a.rootPath().size() > b.rootPath().size();
+        });
+        QHash<QByteArray, QVector<DirectoryJob>> byVolume;
+        for (auto it = byDir.begin(); it != byDir.end(); ++it) {
+            QByteArray volume;
+            for (const QStorageInfo& v : volumes) {
+                if (it.key().startsWith(v.rootPath())) {
+                    volume = v.device();
+                    break;
+                }
+            }
+            byVolume[volume].append(std::move(it.value()));
+        }
+
+        // 3. A few lanes per volume; the last lane to finish reports.
+        int laneCount = 0;
+        for (const QVector<DirectoryJob>& jobs : std::as_const(byVolume))
+            laneCount += qMin(kLanesPerVolume, jobs.size());
+
+        qInfo() << "MissingFileScanner: checking" << checked << "files in" << byDir.size()
+                << "directories on" << byVolume.size() << "volumes";
+        if (laneCount == 0) {
+            m_running.store(false);
+            emit finished(generation, checked, 0);
+            return;
+        }
+
+        auto pending      = std::make_shared<std::atomic<int>>(laneCount);
+        auto missingTotal = std::make_shared<std::atomic<int>>(0);
+
+        for (auto it = byVolume.cbegin(); it != byVolume.cend(); ++it) {
+            auto jobs = std::make_shared<const QVector<DirectoryJob>>(it.value());
+            const int lanes = qMin(kLanesPerVolume, jobs->size());
+            for (int lane = 0; lane < lanes; ++lane) {
+                (void)QtConcurrent::run(&m_pool,
+                    [this, live, generation, jobs, lane, lanes, pending, missingTotal, checked]() {
+                        for (int i = lane; i < jobs->size() && live(); i += lanes) {
+                            const QVector<Track> missing = checkDirectory(jobs->at(i));
+                            if (!missing.isEmpty() && live()) {
+                                *missingTotal += missing.size();
+                                emit missingFound(generation, missing);
+                            }
+                        }
+                        if (--*pending == 0 && live()) {
+                            m_running.store(false);
+                            qInfo() << "MissingFileScanner:" << missingTotal->load()
+                                    << "missing out of" << checked;
+                            emit finished(generation, checked, missingTotal->load());
+                        }
+                    });
+            }
+        }
+    });
+    return generation;
+}
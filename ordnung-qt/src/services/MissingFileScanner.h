@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <functional>
+
+#include "core/Track.h"
+
+// MissingFileScanner — finds library tracks whose file is gone, off the GUI thread.
+//
+// Paths are grouped by directory: each directory is checked once (one stat,
+// then one listing), so a missing folder costs a single failed stat no matter
+// how many tracks it held. Directories are then grouped by the volume they
+// live on and spread over a few lanes per volume, so a slow NAS mount cannot
+// occupy every worker while local disks wait. Results stream out per
+// directory through missingFound() as soon as they are known.
+class MissingFileScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MissingFileScanner(QObject* parent = nullptr);
+    ~MissingFileScanner() override;
+
+    // Starts a scan, cancelling any scan still running, and returns its
+    // generation. loadTracks runs on a worker thread and supplies the tracks
+    // to check.
+    int start(std::function<QVector<Track>()> loadTracks);
+
+    // Request cancellation. A cancelled scan emits nothing further, but
+    // signals it already emitted may still be queued to the receiver.
+    void cancel();
+
+    bool isRunning() const { return m_running.load(); }
+
+    // True while generation is the latest scan and was not cancelled. Slots
+    // check it on arrival and drop results of a superseded scan.
+    bool isCurrent(int generation) const { return m_generation.load() == generation; }
+
+signals:
+    // A batch of tracks (all from one directory) whose file does not exist.
+    void missingFound(int generation, const QVector<Track>& tracks);
+
+    // Emitted once when every path has been checked.
+    void finished(int generation, int checked, int missing);
+
+private:
+    QThreadPool        m_pool;
+    std::atomic<int>   m_generation{0};
+    std::atomic<bool>  m_running{false};
+};
@@ -0,0 +1,188 @@
+#include "StatementTracer.h"
+
+#include <QDebug>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef HAVE_SQLITE3_DIRECT
+#include <sqlite3.h>
+#endif
+
+StatementTracer::StatementTracer(const QString& label, int slowMs)
+    : m_label(label)
+    , m_slowNs(qint64(slowMs) * 1000 * 1000)
+{
+    qInfo() << "StatementTracer:" << m_label << "timing Database execs, slow threshold"
+            << slowMs << "ms";
+}
+
+#ifdef HAVE_SQLITE3_DIRECT
+
+StatementTracer::StatementTracer(sqlite3* db, const QString& dbPath,
+                                 const QString& label, int slowMs)
+    : m_db(db)
+    , m_label(label)
+    , m_slowNs(qint64(slowMs) * 1000 * 1000)
+{
+    const QByteArray path = dbPath.toUtf8();
+    if (sqlite3_open_v2(path.constData(), &m_explainDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(m_explainDb);
+        m_explainDb = nullptr;
+    }
+    sqlite3_trace_v2(m_db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, &StatementTracer::onTrace, this);
+    qInfo() << "StatementTracer:" << m_label << "tracing, slow threshold" << slowMs << "ms";
+}
+
+#endif
+
+StatementTracer::~StatementTracer()
+{
+#ifdef HAVE_SQLITE3_DIRECT
+    if (m_db)
+        sqlite3_trace_v2(m_db, 0, nullptr, nullptr);
+    if (m_explainDb)
+        sqlite3_close(m_explainDb);
+#endif
+}
+
+StatementTracer::Stats& StatementTracer::statsFor(const QByteArray& sql)
+{
+    // Generated SQL (IN lists of varying length) must not grow the table
+    // without bound; past the cap everything new lands in one bucket.
+    if (m_stats.size() >= kMaxStatements && !m_stats.contains(sql))
+        return m_stats[QByteArrayLiteral("(other statements)")];
+    return m_stats[sql];
+}
+
+void StatementTracer::recordExec(const QByteArray& key, qint64 ns, qint64 rows)
+{
+    Stats& s = statsFor(key);
+    ++s.count;
+    s.totalNs += ns;
+    s.maxNs = std::max(s.maxNs, ns);
+    s.rows += std::max<qint64>(rows, 0);
+    ++s.histogram[bucketFor(ns)];
+
+    if (ns >= m_slowNs) {
+        qWarning().noquote() << "Slow SQL" << QStringLiteral("[%1]").arg(m_label)
+                             << QString::number(ns / 1.0e6, 'f', 1) + QStringLiteral(" ms:")
+                             << QString::fromUtf8(key).simplified();
+    }
+}
+
+#ifdef HAVE_SQLITE3_DIRECT
+
+int StatementTracer::onTrace(unsigned type, void* ctx, void* p, void* x)
+{
+    auto* self = static_cast<StatementTracer*>(ctx);
+    auto* stmt = static_cast<sqlite3_stmt*>(p);
+    if (type == SQLITE_TRACE_ROW) {
+        ++self->m_rowsInFlight[stmt];
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        self->record(stmt, qint64(*static_cast<sqlite3_int64*>(x)));
+    }
+    return 0;
+}
+
+void StatementTracer::record(sqlite3_stmt* stmt, qint64 ns)
+{
+    const char* sql = sqlite3_sql(stmt);
+    if (!sql)
+        return;
+
+    Stats& s = statsFor(QByteArray(sql));
+    ++s.count;
+    s.totalNs += ns;
+    s.maxNs = std::max(s.maxNs, ns);
+    s.rows += m_rowsInFlight.take(stmt);
+    ++s.histogram[bucketFor(ns)];
+
+    if (ns >= m_slowNs)
+        logSlow(stmt, ns);
+}
+
+void StatementTracer::logSlow(sqlite3_stmt* stmt, qint64 ns)
+{
+    char* expanded = sqlite3_expanded_sql(stmt);
+    qWarning().noquote() << "Slow SQL" << QStringLiteral("[%1]").arg(m_label)
+                         << QString::number(ns / 1.0e6, 'f', 1) + QStringLiteral(" ms:")
+                         << QString::fromUtf8(expanded ? expanded : sqlite3_sql(stmt)).simplified();
+    sqlite3_free(expanded);
+
+    if (!m_explainDb)
+        return;
+    const QByteArray explain = QByteArray("EXPLAIN QUERY PLAN ") + sqlite3_sql(stmt);
+    sqlite3_stmt* plan = nullptr;
+    if (sqlite3_prepare_v2(m_explainDb, explain.constData(), -1, &plan, nullptr) != SQLITE_OK) {
+        // Temp tables (scan_stage) and writes on a read-only handle end up here.
+        qWarning().noquote() << "  (no plan:" << sqlite3_errmsg(m_explainDb) << ")";
+        sqlite3_finalize(plan);
+        return;
+    }
+    // Placeholders stay unbound: the plan does not depend on their values.
+    while (sqlite3_step(plan) == SQLITE_ROW) {
+        qWarning().noquote() << "  plan:" << QString::fromUtf8(
+            reinterpret_cast<const char*>(sqlite3_column_text(plan, 3)));
+    }
+    sqlite3_finalize(plan);
+}
+
+#endif // HAVE_SQLITE3_DIRECT
+
+// ── Histogram ───────────────────────────────────────────────────────────────
+
+int StatementTracer::bucketFor(qint64 ns)
+{
+    const double us = std::max<double>(ns / 1000.0, 1.0);
+    return std::clamp(int(std::ceil(std::log2(us) * 4.0)), 0, kBuckets - 1);
+}
+
+double StatementTracer::bucketUpperMs(int bucket)
+{
+    return std::exp2(bucket / 4.0) / 1000.0;
+}
+
+double StatementTracer::percentileMs(const Stats& s, double q)
+{
+    const qint64 rank = std::max<qint64>(1, qint64(std::ceil(q * s.count)));
+    qint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += s.histogram[i];
+        if (seen >= rank)
+            return std::min(bucketUpperMs(i), s.maxNs / 1.0e6);
+    }
+    return s.maxNs / 1.0e6;
+}
+
+void StatementTracer::dumpSummary() const
+{
+    if (m_stats.isEmpty())
+        return;
+
+    QVector<QHash<QByteArray, Stats>::const_iterator> order;
+    for (auto it = m_stats.cbegin(); it != m_stats.cend(); ++it)
+        order.append(it);
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.value().totalNs > b.value().totalNs;
+    });
+
+    qInfo().noquote() << QStringLiteral("SQL summary [%1]: %2 statements")
+                             .arg(m_label).arg(m_stats.size());
+    qInfo().noquote() << QStringLiteral("  %1 %2 %3 %4 %5 %6  sql")
+                             .arg(QStringLiteral("count"), 8).arg(QStringLiteral("total ms"), 10)
+                             .arg(QStringLiteral("p50 ms"), 8).arg(QStringLiteral("p99 ms"), 8)
+                             .arg(QStringLiteral("max ms"), 8).arg(QStringLiteral("rows"), 9);
+    for (const auto& it : order) {
+        const Stats& s = it.value();
+        qInfo().noquote() << QStringLiteral("  %1 %2 %3 %4 %5 %6  %7")
+            .arg(s.count, 8)
+            .arg(s.totalNs / 1.0e6, 10, 'f', 1)
+            .arg(percentileMs(s, 0.50), 8, 'f', 2)
+            .arg(percentileMs(s, 0.99), 8, 'f', 2)
+            .arg(s.maxNs / 1.0e6, 8, 'f', 2)
+            .arg(s.rows, 9)
+            .arg(QString::fromUtf8(it.key()).simplified().left(100));
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <array>
+#include <cstdint>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// StatementTracer — opt-in per-statement timing for one SQLite connection.
+//
+// Hooks sqlite3_trace_v2 on the connection, so every statement is covered
+// whichever Database method (or QSqlQuery) ran it. For each distinct SQL text
+// it keeps a count, total time, rows and a fixed log-scale latency histogram
+// (p50/p99 without storing samples), so it can stay on in production.
+// Statements slower than the threshold are logged with their bound values and
+// EXPLAIN QUERY PLAN, taken on a private read-only connection so the traced
+// connection is never re-entered from its own callback.
+//
+// Without the direct sqlite3 handle (no HAVE_SQLITE3_DIRECT, or QSQLITE on
+// another SQLite) the tracer is built without a connection and Database
+// reports its own execs through recordExec(): queryTracks per caller and
+// cachedQuery statements per SQL text. That covers less (uncached QSqlQuery
+// runs are not seen) and a slow statement is logged without values or plan.
+//
+// Enabled by ORDNUNG_SQL_TRACE=<slow ms> in the environment or the config row
+// 'sql_trace_slow_ms'.
+class StatementTracer
+{
+public:
+    // Hooks db; only available with HAVE_SQLITE3_DIRECT.
+    StatementTracer(sqlite3* db, const QString& dbPath, const QString& label, int slowMs);
+    // Hooks nothing; the owner calls recordExec() itself.
+    StatementTracer(const QString& label, int slowMs);
+    ~StatementTracer();
+
+    StatementTracer(const StatementTracer&) = delete;
+    StatementTracer& operator=(const StatementTracer&) = delete;
+
+    // True when the tracer sees every statement through the sqlite3 hook, so
+    // recordExec() must not be called.
+    bool hooksConnection() const { return m_db != nullptr; }
+
+    // Accounts one exec timed by the caller; key is a caller name or SQL text.
+    // rows is -1 when unknown.
+    void recordExec(const QByteArray& key, qint64 ns, qint64 rows);
+
+    // Logs count/total/p50/p99/max/rows per statement, slowest total first.
+    void dumpSummary() const;
+
+private:
+    static constexpr int kBuckets = 96;      // 2^(i/4) µs, up to ~14 s
+    static constexpr int kMaxStatements = 512; // distinct SQL texts tracked
+
+    struct Stats
+    {
+        qint64 count   = 0;
+        qint64 rows    = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs   = 0;
+        std::array<quint32, kBuckets> histogram{};
+    };
+
+    static int onTrace(unsigned type, void* ctx, void* p, void* x);
+    void record(sqlite3_stmt* stmt, qint64 ns);
+    Stats& statsFor(const QByteArray& sql);
+    void logSlow(sqlite3_stmt* stmt, qint64 ns);
+    static int bucketFor(qint64 ns);
+    static double bucketUpperMs(int bucket);
+    static double percentileMs(const Stats& s, double q);
+
+    sqlite3*  m_db = nullptr;
+    sqlite3*  m_explainDb = nullptr;
+    QString   m_label;
+    qint64    m_slowNs;
+
+    QHash<QByteArray, Stats>    m_stats;       // keyed by unexpanded SQL
+    QHash<sqlite3_stmt*, qint64> m_rowsInFlight;
+};
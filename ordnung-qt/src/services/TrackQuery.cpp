@@ -0,0 +1,380 @@
+#include "TrackQuery.h"
+
+#include <QRegularExpression>
+
+#include <cmath>
+
+// ── Fields ───────────────────────────────────────────────────────────────────
+
+namespace {
+
+using Clause = TrackQuery::Clause;
+
+struct Field
+{
+    const char*  name;
+    const char*  column;
+    Clause::Kind kind;
+    bool         wholeNumbers = false;  // shown truncated: "128" covers 128.0–128.99
+};
+
+const Field kFields[] = {
+    { "title",    "title",       Clause::FullText },
+    { "artist",   "artist",      Clause::FullText },
+    { "album",    "album",       Clause::FullText },
+    { "genre",    "genre",       Clause::FullText },
+    { "comment",  "comment",     Clause::FullText },
+    { "bpm",      "bpm",         Clause::Numeric, true },
+    { "rating",   "rating",      Clause::Numeric },
+    { "energy",   "energy",      Clause::Numeric },
+    { "bitrate",  "bitrate",     Clause::Numeric },
+    { "plays",    "play_count",  Clause::Numeric },
+    { "key",      "key_sig",     Clause::Exact },
+    { "format",   "format",      Clause::Exact },
+    { "aiff",     "has_aiff",    Clause::Flag },
+    { "prepared", "is_prepared", Clause::Flag },
+};
+
+const Field* findField(const QString& name)
+{
+    for (const Field& f : kFields)
+        if (name.compare(QLatin1String(f.name), Qt::CaseInsensitive) == 0)
+            return &f;
+    return nullptr;
+}
+
+// ── Lexing ───────────────────────────────────────────────────────────────────
+
+struct Token
+{
+    QString raw;            // quotes kept, so values can tell phrases apart
+    bool    negated = false;
+};
+
+// Splits on whitespace outside double quotes. A '-' that starts a token (and
+// is not the whole token) negates it.
+QVector<Token> tokenize(const QString& text)
+{
+    QVector<Token> tokens;
+    int i = 0;
+    const int n = text.size();
+    while (i < n) {
+        if (text[i].isSpace()) { ++i; continue; }
+
+        Token tok;
+        if (text[i] == QLatin1Char('-') && i + 1 < n && !text[i + 1].isSpace()) {
+            tok.negated = true;
+            ++i;
+        }
+        bool inQuotes = false;
+        while (i < n && (inQuotes || !text[i].isSpace())) {
+            if (text[i] == QLatin1Char('"'))
+                inQuotes = !inQuotes;
+            tok.raw.append(text[i++]);
+        }
+        tokens.append(tok);
+    }
+    return tokens;
+}
+
+struct Value
+{
+    QString text;
+    bool    quoted     = false;
+    bool    terminated = true;  // closing quote present
+};
+
+// "a,\"b c\",d" -> a | b c | d. Empty items are dropped.
+QVector<Value> splitValues(const QString& raw)
+{
+    QVector<Value> values;
+    Value cur;
+    bool inQuotes = false;
+    auto flush = [&] {
+        cur.terminated = !inQuotes;
+        if (!cur.text.trimmed().isEmpty())
+            values.append(cur);
+        cur = Value();
+    };
+    for (const QChar ch : raw) {
+        if (ch == QLatin1Char('"')) {
+            inQuotes = !inQuotes;
+            cur.quoted = true;
+        } else if (ch == QLatin1Char(',') && !inQuotes) {
+            flush();
+        } else {
+            cur.text.append(ch);
+        }
+    }
+    flush();
+    return values;
+}
+
+// ── Values ───────────────────────────────────────────────────────────────────
+
+// Exact phrase, or prefix match while the word may still be being typed.
+QString ftsTerm(const QString& text, bool prefix)
+{
+    QString escaped = text;
+    escaped.replace(QLatin1Char('"'), QLatin1String("\"\""));
+    return prefix ? QStringLiteral("\"%1\"*").arg(escaped)
+                  : QStringLiteral("\"%1\"").arg(escaped);
+}
+
+// "140" but not "140.0": a bound written with a fraction is taken literally.
+bool isWholeLiteral(const QString& text, double v)
+{
+    return std::floor(v) == v && !text.contains(QLatin1Char('.'))
+        && !text.contains(QLatin1Char('e'), Qt::CaseInsensitive);
+}
+
+// One comparison against the value as the table shows it. When whole, an
+// integer bound n stands for [n, n+1) (wholeNumbers fields, see isWholeLiteral).
+TrackQuery::Range compare(const QString& op, double v, bool whole)
+{
+    TrackQuery::Range r;
+    if (op == QLatin1String(">=")) {
+        r.hasLo = true; r.lo = v;
+    } else if (op == QLatin1String(">")) {
+        r.hasLo = true; r.lo = whole ? v + 1 : v; r.loInclusive = whole;
+    } else if (op == QLatin1String("<=")) {
+        r.hasHi = true; r.hi = whole ? v + 1 : v; r.hiInclusive = !whole;
+    } else if (op == QLatin1String("<")) {
+        r.hasHi = true; r.hi = v; r.hiInclusive = false;
+    } else {  // ':' or '='
+        r.hasLo = r.hasHi = true;
+        r.lo = v;
+        r.hi = whole ? v + 1 : v;
+        r.hiInclusive = !whole;
+    }
+    return r;
+}
+
+bool parseNumber(const QString& text, double& out)
+{
+    bool ok = false;
+    out = text.trimmed().toDouble(&ok);
+    return ok && std::isfinite(out);
+}
+
+// "122-128", "122-", "-128" or "125".
+bool parseRange(const QString& text, bool wholeNumbers, TrackQuery::Range& out)
+{
+    const int dash = text.indexOf(QLatin1Char('-'));
+    if (dash < 0) {
+        double v;
+        if (!parseNumber(text, v)) return false;
+        out = compare(QStringLiteral(":"), v, wholeNumbers && isWholeLiteral(text, v));
+        return true;
+    }
+
+    const QString loText = text.left(dash).trimmed();
+    const QString hiText = text.mid(dash + 1).trimmed();
+    if (loText.isEmpty() && hiText.isEmpty()) return false;
+
+    TrackQuery::Range r;
+    double v;
+    if (!loText.isEmpty()) {
+        if (!parseNumber(loText, v)) return false;
+        r.hasLo = true;
+        r.lo    = v;
+    }
+    if (!hiText.isEmpty()) {
+        if (!parseNumber(hiText, v)) return false;
+        const TrackQuery::Range hi = compare(QStringLiteral("<="), v,
+                                             wholeNumbers && isWholeLiteral(hiText, v));
+        r.hasHi       = true;
+        r.hi          = hi.hi;
+        r.hiInclusive = hi.hiInclusive;
+    }
+    out = r;
+    return true;
+}
+
+bool parseFlag(const QString& text, bool& out)
+{
+    const QString v = text.trimmed().toLower();
+    if (v == QLatin1String("yes") || v == QLatin1String("true") || v == QLatin1String("1")) {
+        out = true;
+        return true;
+    }
+    if (v == QLatin1String("no") || v == QLatin1String("false") || v == QLatin1String("0")) {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ── Parsing ──────────────────────────────────────────────────────────────────
+
+TrackQuery TrackQuery::parse(const QString& text)
+{
+    static const QRegularExpression fieldRe(
+        QStringLiteral("^([A-Za-z]+)(>=|<=|:|>|<|=)(.*)$"),
+        QRegularExpression::DotMatchesEverythingOption);
+
+    TrackQuery query;
+    for (const Token& tok : tokenize(text)) {
+        Clause clause;
+        clause.negated = tok.negated;
+
+        const QRegularExpressionMatch m = fieldRe.match(tok.raw);
+        const Field* field = m.hasMatch() ? findField(m.captured(1)) : nullptr;
+
+        if (!field) {
+            // Free text: a word (prefix match) or a "phrase" over every FTS5 column.
+            const bool quoted = tok.raw.startsWith(QLatin1Char('"'));
+            const bool closed = quoted && tok.raw.size() > 1 && tok.raw.endsWith(QLatin1Char('"'));
+            const QString words = QString(tok.raw).remove(QLatin1Char('"'));
+            if (words.trimmed().isEmpty())
+                continue;
+            clause.terms.append(ftsTerm(words, !closed));
+            query.m_clauses.append(clause);
+            continue;
+        }
+
+        const QString op = m.captured(2);
+        const QVector<Value> values = splitValues(m.captured(3));
+        if (values.isEmpty())
+            continue;  // "bpm:" — still being typed
+
+        const QString name = QLatin1String(field->name);
+        clause.kind   = field->kind;
+        clause.column = QLatin1String(field->column);
+
+        const bool comparison = op != QLatin1String(":") && op != QLatin1String("=");
+        if (comparison && (field->kind != Clause::Numeric || values.size() != 1)) {
+            query.m_error = QStringLiteral("%1%2 needs a single number").arg(name, op);
+            continue;
+        }
+
+        switch (field->kind) {
+        case Clause::FullText:
+            for (const Value& v : values)
+                clause.terms.append(ftsTerm(v.text, !v.quoted || !v.terminated));
+            break;
+        case Clause::Exact:
+            for (const Value& v : values)
+                clause.terms.append(v.text.trimmed());
+            break;
+        case Clause::Numeric:
+            for (const Value& v : values) {
+                Range r;
+                double number;
+                const bool ok = comparison
+                    ? parseNumber(v.text, number)
+                    : parseRange(v.text, field->wholeNumbers, r);
+                if (!ok) {
+                    query.m_error = QStringLiteral("%1: \"%2\" is not a number or range")
+                                        .arg(name, v.text);
+                    break;
+                }
+                clause.ranges.append(comparison
+                    ? compare(op, number, field->wholeNumbers && isWholeLiteral(v.text, number))
+                    : r);
+            }
+            break;
+        case Clause::Flag:
+            if (values.size() != 1 || !parseFlag(values.first().text, clause.flag))
+                query.m_error = QStringLiteral("%1: expected yes or no").arg(name);
+            break;
+        }
+
+        if (clause.terms.isEmpty() && clause.ranges.isEmpty() && field->kind != Clause::Flag)
+            continue;
+        query.m_clauses.append(clause);
+    }
+    return query;
+}
+
+bool TrackQuery::ranksByRelevance() const
+{
+    for (const Clause& c : m_clauses)
+        if (c.kind == Clause::FullText && !c.negated)
+            return true;
+    return false;
+}
+
+// ── Compilation ──────────────────────────────────────────────────────────────
+
+TrackQuery::Sql TrackQuery::compile() const
+{
+    Sql sql;
+    QStringList matches;     // positive full-text clauses, one MATCH for all
+    QStringList predicates;
+
+    for (const Clause& c : m_clauses) {
+        QString expr;
+        switch (c.kind) {
+        case Clause::FullText: {
+            QString fts = c.terms.join(QStringLiteral(" OR "));
+            if (c.terms.size() > 1)
+                fts = QLatin1Char('(') + fts + QLatin1Char(')');
+            if (!c.column.isEmpty())
+                fts = QStringLiteral("{%1} : %2").arg(c.column, fts);
+            if (!c.negated) {
+                matches.append(fts);
+                continue;
+            }
+            predicates.append(QStringLiteral(
+                "s.id NOT IN (SELECT rowid FROM songs_fts WHERE songs_fts MATCH ?)"));
+            sql.binds.append(fts);
+            continue;
+        }
+        case Clause::Numeric: {
+            QStringList alternatives;
+            for (const Range& r : c.ranges) {
+                QStringList bounds;
+                if (r.hasLo) {
+                    bounds.append(QStringLiteral("s.%1 %2 ?")
+                                      .arg(c.column, QLatin1String(r.loInclusive ? ">=" : ">")));
+                    sql.binds.append(r.lo);
+                }
+                if (r.hasHi) {
+                    bounds.append(QStringLiteral("s.%1 %2 ?")
+                                      .arg(c.column, QLatin1String(r.hiInclusive ? "<=" : "<")));
+                    sql.binds.append(r.hi);
+                }
+                alternatives.append(bounds.join(QStringLiteral(" AND ")));
+            }
+            expr = alternatives.size() == 1
+                ? alternatives.first()
+                : QLatin1Char('(') + alternatives.join(QStringLiteral(") OR (")) + QLatin1Char(')');
+            break;
+        }
+        case Clause::Exact: {
+            // Matches idx_songs_key's NOCASE collation, so "8a" finds "8A".
+            QStringList marks;
+            for (const QString& v : c.terms) {
+                marks.append(QStringLiteral("?"));
+                sql.binds.append(v);
+            }
+            expr = QStringLiteral("s.%1 COLLATE NOCASE IN (%2)")
+                       .arg(c.column, marks.join(QStringLiteral(", ")));
+            break;
+        }
+        case Clause::Flag:
+            predicates.append(QStringLiteral("s.%1 = ?").arg(c.column));
+            sql.binds.append((c.flag != c.negated) ? 1 : 0);
+            continue;
+        }
+        // A negated predicate also keeps rows where the column is NULL.
+        predicates.append(c.negated ? QStringLiteral("NOT IFNULL((%1), 0)").arg(expr)
+                                    : QLatin1Char('(') + expr + QLatin1Char(')'));
+    }
+
+    if (!matches.isEmpty()) {
+        sql.join    = QStringLiteral("JOIN songs_fts ON songs_fts.rowid = s.id");
+        // Equal ranks are common (same term, same field); the id tie-breaker
+        // keeps OFFSET paging from repeating or skipping rows between pages.
+        sql.orderBy = QStringLiteral("rank, s.id");
+        predicates.prepend(QStringLiteral("songs_fts MATCH ?"));
+        sql.binds.prepend(matches.join(QStringLiteral(" AND ")));
+    } else {
+        sql.orderBy = QStringLiteral("s.title, s.id");
+    }
+    sql.where = predicates.isEmpty() ? QStringLiteral("1") : predicates.join(QStringLiteral(" AND "));
+    return sql;
+}
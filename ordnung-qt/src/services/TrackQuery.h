@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+// TrackQuery — the library search language, parsed into clauses and compiled
+// to SQL over songs (alias s).
+//
+//   bpm:122-128 key:8A,9A genre:techno rating>=3 "acid" -vocal aiff:no
+//
+// Every clause must hold (AND); comma-separated values within one clause are
+// alternatives (OR); a leading '-' negates a clause. Bare words are prefix
+// matches and quoted text an exact phrase, both over the FTS5 index. Text
+// fields (title, artist, album, genre, comment) become FTS5 column filters;
+// numeric fields (bpm, rating, energy, bitrate, plays), key/format and the
+// aiff/prepared flags become predicates on indexed songs columns.
+//
+// BPM is shown truncated, so a whole bpm bound means what the table shows:
+// "bpm:128" covers 128.0-128.99 and "bpm>140" starts at 141. A bound written
+// with a fraction is exact: "bpm>140.0" keeps 140.5.
+//
+// A word whose prefix is not a known field ("re:mix") is plain text. A known
+// field with no value yet ("bpm:") is ignored, so a query being typed stays
+// valid; a value that does not parse ("bpm:fast") makes the query invalid.
+class TrackQuery
+{
+public:
+    struct Range {
+        double lo = 0.0, hi = 0.0;
+        bool   hasLo = false, hasHi = false;
+        bool   loInclusive = true, hiInclusive = true;
+    };
+
+    struct Clause {
+        enum Kind { FullText, Numeric, Exact, Flag };
+
+        Kind           kind    = FullText;
+        QString        column;           // songs / songs_fts column; empty = any FTS column
+        bool           negated = false;
+        QStringList    terms;            // FullText: FTS5 terms; Exact: values
+        QVector<Range> ranges;           // Numeric
+        bool           flag    = false;  // Flag
+    };
+
+    // SQL fragments for "SELECT ... FROM songs s <join> WHERE <where> ORDER BY <orderBy>".
+    struct Sql {
+        QString      join;
+        QString      where;
+        QString      orderBy;
+        QVariantList binds;              // for the placeholders in join + where, in order
+    };
+
+    static TrackQuery parse(const QString& text);
+
+    bool isEmpty() const { return m_clauses.isEmpty(); }
+    bool isValid() const { return m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+    const QVector<Clause>& clauses() const { return m_clauses; }
+
+    // True when the query has a positive full-text clause; results are then
+    // ordered by FTS5 rank instead of title.
+    bool ranksByRelevance() const;
+
+    Sql compile() const;
+
+private:
+    QVector<Clause> m_clauses;
+    QString         m_error;
+};
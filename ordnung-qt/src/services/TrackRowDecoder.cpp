@@ -0,0 +1,128 @@
+#include "TrackRowDecoder.h"
+
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+#ifdef HAVE_SQLITE3_DIRECT
+#include <sqlite3.h>
+#endif
+
+// ── Column table ─────────────────────────────────────────────────────────────
+
+namespace {
+
+struct TrackColumn
+{
+    enum Kind { Int64, Int, Bool, Real, Float, Text };
+
+    const char* name;
+    Kind        kind;
+    long long   Track::* i64  = nullptr;
+    int         Track::* i32  = nullptr;
+    bool        Track::* flag = nullptr;
+    double      Track::* real = nullptr;
+    float       Track::* flt  = nullptr;
+    std::string Track::* text = nullptr;
+
+    TrackColumn(const char* n, long long Track::* m)   : name(n), kind(Int64), i64(m) {}
+    TrackColumn(const char* n, int Track::* m)         : name(n), kind(Int),   i32(m) {}
+    TrackColumn(const char* n, bool Track::* m)        : name(n), kind(Bool),  flag(m) {}
+    TrackColumn(const char* n, double Track::* m)      : name(n), kind(Real),  real(m) {}
+    TrackColumn(const char* n, float Track::* m)       : name(n), kind(Float), flt(m) {}
+    TrackColumn(const char* n, std::string Track::* m) : name(n), kind(Text),  text(m) {}
+};
+
+const TrackColumn kColumns[] = {
+    { "id",                &Track::id },
+    { "title",             &Track::title },
+    { "artist",            &Track::artist },
+    { "album",             &Track::album },
+    { "genre",             &Track::genre },
+    { "bpm",               &Track::bpm },
+    { "rating",            &Track::rating },
+    { "time",              &Track::time },
+    { "key_sig",           &Track::key_sig },
+    { "date_added",        &Track::date_added },
+    { "format",            &Track::format },
+    { "has_aiff",          &Track::has_aiff },
+    { "match_key",         &Track::match_key },
+    { "filepath",          &Track::filepath },
+    { "color_label",       &Track::color_label },
+    { "bitrate",           &Track::bitrate },
+    { "comment",           &Track::comment },
+    { "play_count",        &Track::play_count },
+    { "date_played",       &Track::date_played },
+    { "energy",            &Track::energy },
+    { "mood_tags",         &Track::mood_tags },
+    { "style_tags",        &Track::style_tags },
+    { "danceability",      &Track::danceability },
+    { "valence",           &Track::valence },
+    { "vocal_prob",        &Track::vocal_prob },
+    { "essentia_analyzed", &Track::essentia_analyzed },
+    { "is_prepared",       &Track::is_prepared },
+};
+
+constexpr int kColumnCount = int(sizeof(kColumns) / sizeof(kColumns[0]));
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+
+QString TrackRowDecoder::columns(const QString& alias)
+{
+    const QString prefix = alias.isEmpty() ? QString() : alias + QLatin1Char('.');
+    QStringList cols;
+    cols.reserve(kColumnCount);
+    for (const TrackColumn& c : kColumns)
+        cols.append(prefix + QLatin1String(c.name));
+    return cols.join(QStringLiteral(", "));
+}
+
+int TrackRowDecoder::columnCount()
+{
+    return kColumnCount;
+}
+
+Track TrackRowDecoder::decode(const QSqlQuery& q)
+{
+    Track t;
+    for (int i = 0; i < kColumnCount; ++i) {
+        const TrackColumn& c = kColumns[i];
+        const QVariant v = q.value(i);
+        switch (c.kind) {
+        case TrackColumn::Int64: t.*c.i64  = v.toLongLong();                  break;
+        case TrackColumn::Int:   t.*c.i32  = v.toInt();                       break;
+        case TrackColumn::Bool:  t.*c.flag = v.toInt() != 0;                  break;
+        case TrackColumn::Real:  t.*c.real = v.toDouble();                    break;
+        case TrackColumn::Float: t.*c.flt  = v.toFloat();                     break;
+        case TrackColumn::Text:  t.*c.text = v.toString().toStdString();      break;
+        }
+    }
+    return t;
+}
+
+#ifdef HAVE_SQLITE3_DIRECT
+Track TrackRowDecoder::decode(sqlite3_stmt* stmt)
+{
+    Track t;
+    for (int i = 0; i < kColumnCount; ++i) {
+        const TrackColumn& c = kColumns[i];
+        switch (c.kind) {
+        case TrackColumn::Int64: t.*c.i64  = sqlite3_column_int64(stmt, i);               break;
+        case TrackColumn::Int:   t.*c.i32  = sqlite3_column_int(stmt, i);                 break;
+        case TrackColumn::Bool:  t.*c.flag = sqlite3_column_int(stmt, i) != 0;            break;
+        case TrackColumn::Real:  t.*c.real = sqlite3_column_double(stmt, i);              break;
+        case TrackColumn::Float: t.*c.flt  = float(sqlite3_column_double(stmt, i));       break;
+        case TrackColumn::Text: {
+            // Text is already UTF-8 in the database — copy the bytes as-is.
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+            if (text)
+                (t.*c.text).assign(text, size_t(sqlite3_column_bytes(stmt, i)));
+            break;
+        }
+        }
+    }
+    return t;
+}
+#endif
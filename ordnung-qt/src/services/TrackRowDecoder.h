@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+
+#include "core/Track.h"
+
+class QSqlQuery;
+
+#ifdef HAVE_SQLITE3_DIRECT
+struct sqlite3_stmt;
+#endif
+
+// TrackRowDecoder — the one place that knows how a full songs row maps onto
+// Track. Every Database loader selects columns() and hands each row to
+// decode(), so adding a column means touching a single table in the .cpp.
+//
+// With HAVE_SQLITE3_DIRECT the decoder reads straight from the sqlite3
+// statement (sqlite3_column_text / _double / _int64) and never builds the
+// per-cell QVariant + QString that QSqlQuery::value() costs.
+class TrackRowDecoder
+{
+public:
+    // Comma-separated column list in decode order, optionally qualified with
+    // a table alias: columns("s") -> "s.id, s.title, ...".
+    static QString columns(const QString& alias = QString());
+
+    static int columnCount();
+
+    // Decode the current row. Columns 0..columnCount()-1 must be columns().
+    static Track decode(const QSqlQuery& q);
+#ifdef HAVE_SQLITE3_DIRECT
+    static Track decode(sqlite3_stmt* stmt);
+#endif
+};
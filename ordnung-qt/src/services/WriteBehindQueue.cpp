@@ -0,0 +1,161 @@
+#include "WriteBehindQueue.h"
+#include "Database.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QDebug>
+
+#include <utility>
+
+WriteBehindQueue::WriteBehindQueue(Database* db, QObject* parent)
+    : QObject(parent)
+    , m_db(db)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kFlushDelayMs);
+    connect(m_timer, &QTimer::timeout, this, &WriteBehindQueue::flush);
+}
+
+WriteBehindQueue::~WriteBehindQueue()
+{
+    if (pendingCount() > 0)
+        qWarning() << "WriteBehindQueue: destroyed with" << pendingCount() << "unflushed writes";
+}
+
+// ── Enqueue ─────────────────────────────────────────────────────────────────
+
+void WriteBehindQueue::updateSongMetadata(long long songId, const Track& t)
+{
+    m_metadata.insert(songId, t);
+    schedule();
+}
+
+void WriteBehindQueue::updateSongColorLabel(long long songId, int colorLabel)
+{
+    m_colorLabels.insert(songId, colorLabel);
+    schedule();
+}
+
+void WriteBehindQueue::updateCuePoint(const CuePoint& cue)
+{
+    m_cueUpdates.insert(cue.id, cue);
+    schedule();
+}
+
+void WriteBehindQueue::deleteCuePoint(long long cueId)
+{
+    m_cueUpdates.remove(cueId);
+    m_cueDeletes.insert(cueId);
+    schedule();
+}
+
+void WriteBehindQueue::recordPlay(long long songId)
+{
+    m_plays.append({songId, QDateTime::currentDateTime()});
+    schedule();
+}
+
+int WriteBehindQueue::pendingCount() const
+{
+    return m_metadata.size() + m_colorLabels.size() + m_cueUpdates.size()
+         + m_cueDeletes.size() + m_plays.size();
+}
+
+void WriteBehindQueue::schedule()
+{
+    // Not restarted on every edit: a steady stream of clicks still flushes
+    // every kFlushDelayMs instead of waiting for a pause.
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+// ── Flush ───────────────────────────────────────────────────────────────────
+
+bool WriteBehindQueue::writeOne(const std::function<bool()>& write)
+{
+    QSqlQuery sp(m_db->m_db);
+    if (!sp.exec(QStringLiteral("SAVEPOINT write_behind")))
+        return false;
+    if (write())
+        return sp.exec(QStringLiteral("RELEASE write_behind"));
+    sp.exec(QStringLiteral("ROLLBACK TO write_behind"));
+    sp.exec(QStringLiteral("RELEASE write_behind"));
+    return false;
+}
+
+bool WriteBehindQueue::flush()
+{
+    m_timer->stop();
+    const int pending = pendingCount();
+    if (pending == 0)
+        return true;
+
+    // BEGIN fails when this connection is already inside a transaction (a
+    // read issued from within syncFromDiskBatch, say). The writes must not
+    // join it: if it rolls back they are lost with nothing left to retry or
+    // report. Leave them queued; the timer fires again once it has ended.
+    if (!m_db->m_db.transaction()) {
+        qDebug() << "WriteBehindQueue: connection busy in a transaction -" << pending
+                 << "writes deferred";
+        schedule();
+        return false;
+    }
+
+    // Take the batch first, so writes queued by anything the flush triggers
+    // start a new batch.
+    auto metadata    = std::exchange(m_metadata, {});
+    auto colorLabels = std::exchange(m_colorLabels, {});
+    auto cueUpdates  = std::exchange(m_cueUpdates, {});
+    auto cueDeletes  = std::exchange(m_cueDeletes, {});
+    auto plays       = std::exchange(m_plays, {});
+
+    int     failed = 0;
+    QString error;
+    auto attempt = [&](const std::function<bool()>& write) {
+        if (writeOne(write))
+            return;
+        ++failed;
+        error = m_db->errorString();
+    };
+    for (auto it = metadata.cbegin(); it != metadata.cend(); ++it)
+        attempt([&] { return m_db->updateSongMetadata(it.key(), it.value()); });
+    for (auto it = colorLabels.cbegin(); it != colorLabels.cend(); ++it)
+        attempt([&] { return m_db->updateSongColorLabel(it.key(), it.value()); });
+    for (auto it = cueUpdates.cbegin(); it != cueUpdates.cend(); ++it)
+        attempt([&] { return m_db->updateCuePoint(it.value()); });
+    for (auto it = cueDeletes.cbegin(); it != cueDeletes.cend(); ++it)
+        attempt([&] { return m_db->deleteCuePoint(*it); });
+    for (const auto& play : std::as_const(plays))
+        attempt([&] { return m_db->recordPlay(play.first, play.second); });
+
+    if (!m_db->m_db.commit()) {
+        qWarning() << "WriteBehindQueue: commit failed:" << m_db->m_db.lastError().text()
+                   << "-" << pending << "writes kept for the next flush";
+        m_db->m_db.rollback();
+        // Anything queued since is newer and wins over the returned batch.
+        metadata.insert(m_metadata);
+        colorLabels.insert(m_colorLabels);
+        cueUpdates.insert(m_cueUpdates);
+        for (const long long id : std::as_const(m_cueDeletes))
+            cueUpdates.remove(id);
+        cueDeletes.unite(m_cueDeletes);
+        m_metadata    = std::move(metadata);
+        m_colorLabels = std::move(colorLabels);
+        m_cueUpdates  = std::move(cueUpdates);
+        m_cueDeletes  = std::move(cueDeletes);
+        m_plays       = std::move(plays) + m_plays;
+        schedule();
+        return false;
+    }
+
+    if (failed > 0) {
+        qWarning() << "WriteBehindQueue:" << failed << "of" << pending
+                   << "writes failed and were dropped:" << error;
+        emit writesFailed(failed, error);
+        return false;
+    }
+    qDebug() << "WriteBehindQueue: flushed" << pending << "writes";
+    return true;
+}
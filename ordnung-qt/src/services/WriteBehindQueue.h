@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+#include "core/Track.h"
+#include "core/CuePoint.h"
+
+class Database;
+class QTimer;
+
+// WriteBehindQueue — batches interactive edits into one transaction.
+//
+// Tagging sessions produce bursts of single-row writes (colour labels, inline
+// edits, cue renames, plays). Each used to be its own autocommit transaction
+// and so its own fsync. The queue holds them briefly instead: repeated writes
+// to the same row collapse to the latest value, and everything pending is
+// written in a single transaction when the flush timer fires.
+//
+// Lives on the thread of the Database it writes to (the GUI's primary
+// connection). Reads through that connection flush first, so nothing ever
+// reads back a value older than what the UI shows; code that reads through
+// another connection (export, pool readers) calls flush() as a barrier.
+class WriteBehindQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WriteBehindQueue(Database* db, QObject* parent = nullptr);
+    ~WriteBehindQueue() override;
+
+    // Same meaning as the Database methods of the same name.
+    void updateSongMetadata(long long songId, const Track& t);
+    void updateSongColorLabel(long long songId, int colorLabel);
+    void updateCuePoint(const CuePoint& cue);
+    void deleteCuePoint(long long cueId);
+
+    // Plays are not coalesced; the play time is taken now, not at flush.
+    void recordPlay(long long songId);
+
+    // Writes everything pending in one transaction, each write under its own
+    // savepoint: a write that fails (a match_key collision after a rename,
+    // say) is rolled back and dropped alone, and writesFailed() reports it.
+    // If the commit itself fails, the batch goes back in the queue and is
+    // retried on the next flush. Inside another transaction of the same
+    // connection nothing is written; the batch stays queued for the next
+    // timer tick. Returns false if anything was not written.
+    bool flush();
+
+    int pendingCount() const;
+
+signals:
+    // count queued writes were dropped by the last flush; error is the
+    // database message of the last of them.
+    void writesFailed(int count, const QString& error);
+
+private:
+    void schedule();
+    // Runs write under a savepoint; rolls it back alone if it fails.
+    bool writeOne(const std::function<bool()>& write);
+
+    Database* m_db;
+    QTimer*   m_timer;
+
+    QHash<long long, Track>    m_metadata;      // song id -> latest row
+    QHash<long long, int>      m_colorLabels;   // song id -> label
+    QHash<long long, CuePoint> m_cueUpdates;    // cue id  -> latest cue
+    QSet<long long>            m_cueDeletes;
+    QVector<QPair<long long, QDateTime>> m_plays;
+
+    static constexpr int kFlushDelayMs = 400;
+};
@@ -1,6 +1,7 @@
 #include "views/BatchEditDialog.h"
 
 #include "services/Database.h"
+#include "services/WriteBehindQueue.h"
 #include "style/Theme.h"
 
 #include <QVBoxLayout>
@@ -190,8 +191,10 @@ void BatchEditDialog::onApplyClicked()
         if (m_rating > 0) { t.rating = m_rating; changed = true; }
 
         if (changed)
-            m_db->updateSongMetadata(t.id, t);
+            m_db->writeBehind()->updateSongMetadata(t.id, t);
     }
+    // One transaction for the whole batch, written before listeners reload.
+    m_db->writeBehind()->flush();
 
     emit applied();
     accept();
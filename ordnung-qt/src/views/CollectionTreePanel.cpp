@@ -1,6 +1,7 @@
 #include "CollectionTreePanel.h"
 #include "PlaylistPanel.h"          // re-use ImportZone
 #include "services/Database.h"
+#include "services/DatabasePool.h"
 #include "style/Theme.h"
 
 #include <QVBoxLayout>
@@ -69,6 +70,22 @@ CollectionTreePanel::CollectionTreePanel(Database* db, QWidget* parent)
     connect(m_importZone, &ImportZone::filesDropped,
             this,         &CollectionTreePanel::onImportZoneFilesDropped);
 
+    m_playlistsWatcher = new QFutureWatcher<QVector<Playlist>>(this);
+    connect(m_playlistsWatcher, &QFutureWatcher<QVector<Playlist>>::finished,
+            this, [this]() {
+                const QFuture<QVector<Playlist>> future = m_playlistsWatcher->future();
+                if (!future.isCanceled() && future.resultCount() > 0)
+                    populatePlaylists(future.result());
+            });
+
+    m_smartWatcher = new QFutureWatcher<QVector<SmartPlaylist>>(this);
+    connect(m_smartWatcher, &QFutureWatcher<QVector<SmartPlaylist>>::finished,
+            this, [this]() {
+                const QFuture<QVector<SmartPlaylist>> future = m_smartWatcher->future();
+                if (!future.isCanceled() && future.resultCount() > 0)
+                    populateSmartPlaylists(future.result());
+            });
+
     buildTree();
 }
 
@@ -112,42 +129,14 @@ void CollectionTreePanel::buildTree()
     // ── Playlists ────────────────────────────────────────────────────────────
     m_playlistsNode = makeCategory(QStringLiteral("Playlists"));
 
-    // Load playlists from DB
-    const QVector<Playlist> playlists = m_db->loadPlaylists();
-    for (const Playlist& p : playlists) {
-        const QString name = QString::fromStdString(p.name)
-            + QStringLiteral("  (") + QString::number(p.total) + QLatin1Char(')');
-        auto* pItem = makeLeaf(name, PlaylistNode, p.id);
-        m_playlistsNode->addChild(pItem);
-    }
-
-    // "+ Create Playlist" action node
-    auto* createItem = makeLeaf(QStringLiteral("+ new playlist"), CreatePlaylist);
-    {
-        QFont italicF = m_tree->font();
-        italicF.setPointSize(Theme::Font::Caption);
-        italicF.setItalic(true);
-        createItem->setFont(0, italicF);
-        createItem->setForeground(0, QColor(Theme::Color::Text3));
-    }
-    m_playlistsNode->addChild(createItem);
+    // Playlist leaves (and the "+ new playlist" node) arrive asynchronously
+    reloadPlaylists();
 
     // ── Smart Playlists ──────────────────────────────────────────────────────
     m_smartNode = makeCategory(QStringLiteral("Smart Playlists"));
 
-    auto* prepared  = makeLeaf(QStringLiteral("Prepared for Gig"),  SmartPlaylist);
-    prepared->setData(0, IdRole, QVariant("prepared"));
-    auto* needsAiff = makeLeaf(QStringLiteral("Needs AIFF"),        SmartPlaylist);
-    needsAiff->setData(0, IdRole, QVariant("needs_aiff"));
-    auto* highBpm   = makeLeaf(QStringLiteral("High BPM (>140)"),   SmartPlaylist);
-    highBpm->setData(0, IdRole, QVariant("high_bpm"));
-    auto* topRated  = makeLeaf(QStringLiteral("Top Rated (★★★+)"), SmartPlaylist);
-    topRated->setData(0, IdRole, QVariant("top_rated"));
-
-    m_smartNode->addChild(prepared);
-    m_smartNode->addChild(needsAiff);
-    m_smartNode->addChild(highBpm);
-    m_smartNode->addChild(topRated);
+    // Built-ins and user-defined ones alike are smart_playlists rows
+    reloadSmartPlaylists();
 
     // ── History ──────────────────────────────────────────────────────────────
     m_historyNode = makeCategory(QStringLiteral("History"));
@@ -165,11 +154,22 @@ void CollectionTreePanel::reloadPlaylists()
 {
     if (!m_playlistsNode) return;
 
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        populatePlaylists(m_db->loadPlaylists());
+        return;
+    }
+    m_playlistsWatcher->setFuture(pool->read<QVector<Playlist>>(
+        QStringLiteral("collection.playlists"),
+        [](Database& db) { return db.loadPlaylists(); }));
+}
+
+void CollectionTreePanel::populatePlaylists(const QVector<Playlist>& playlists)
+{
     // Remove all children
     while (m_playlistsNode->childCount() > 0)
         delete m_playlistsNode->takeChild(0);
 
-    const QVector<Playlist> playlists = m_db->loadPlaylists();
     for (const Playlist& p : playlists) {
         const QString name = QString::fromStdString(p.name)
             + QStringLiteral("  (") + QString::number(p.total) + QLatin1Char(')');
@@ -195,6 +195,41 @@ void CollectionTreePanel::reloadPlaylists()
     m_playlistsNode->addChild(createItem);
 }
 
+void CollectionTreePanel::reloadSmartPlaylists()
+{
+    if (!m_smartNode) return;
+
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        populateSmartPlaylists(m_db->loadSmartPlaylists(m_libraryFolder));
+        return;
+    }
+    m_smartWatcher->setFuture(pool->read<QVector<SmartPlaylist>>(
+        QStringLiteral("collection.smartPlaylists"),
+        [folder = m_libraryFolder](Database& db) { return db.loadSmartPlaylists(folder); }));
+}
+
+void CollectionTreePanel::setLibraryFolder(const QString& folder)
+{
+    if (folder == m_libraryFolder) return;
+    m_libraryFolder = folder;
+    reloadSmartPlaylists();
+}
+
+void CollectionTreePanel::populateSmartPlaylists(const QVector<SmartPlaylist>& playlists)
+{
+    while (m_smartNode->childCount() > 0)
+        delete m_smartNode->takeChild(0);
+
+    for (const SmartPlaylist& p : playlists) {
+        const QString name = QString::fromStdString(p.name)
+            + QStringLiteral("  (") + QString::number(p.total) + QLatin1Char(')');
+        auto* item = makeLeaf(name, SmartPlaylistNode, p.id);
+        item->setToolTip(0, QString::fromStdString(p.query));
+        m_smartNode->addChild(item);
+    }
+}
+
 void CollectionTreePanel::setActivePlaylist(long long id)
 {
     m_activePlaylistId = id;
@@ -228,8 +263,8 @@ void CollectionTreePanel::onItemClicked(QTreeWidgetItem* item, int /*column*/)
         emit playlistSelected(id);
         break;
     }
-    case SmartPlaylist:
-        emit smartPlaylistSelected(idVariant.toString());
+    case SmartPlaylistNode:
+        emit smartPlaylistSelected(QString::number(idVariant.toLongLong()));
         break;
     case CreatePlaylist:
         emit createPlaylistRequested();
@@ -2,6 +2,9 @@
 
 #include <QWidget>
 #include <QTreeWidget>
+#include <QFutureWatcher>
+
+#include "core/Playlist.h"
 
 class Database;
 class ImportZone;
@@ -27,8 +30,14 @@ class CollectionTreePanel : public QWidget
 public:
     explicit CollectionTreePanel(Database* db, QWidget* parent = nullptr);
 
-    // Refresh the playlist nodes from the database.
+    // Refresh the playlist nodes from the database. Loads on a reader
+    // connection; the nodes are rebuilt when the result arrives.
     void reloadPlaylists();
+    // Same for the Smart Playlists node (smart_playlists rows).
+    void reloadSmartPlaylists();
+    // Smart playlist counts cover the tracks under this folder, as the
+    // library view shows them. Reloads the counts.
+    void setLibraryFolder(const QString& folder);
 
     // Highlight the currently-active playlist node.
     void setActivePlaylist(long long id);
@@ -37,7 +46,7 @@ signals:
     // Emitted when the user selects a node. Views respond by loading tracks.
     void collectionSelected();                          // "All Tracks"
     void playlistSelected(long long id);
-    void smartPlaylistSelected(const QString& key);    // "needs_aiff", "high_bpm", …
+    void smartPlaylistSelected(const QString& key);    // smart playlist id, "recently_added", …
     void historyDateSelected(const QString& date);
 
     // Playlist management
@@ -57,10 +66,14 @@ private slots:
 private:
     void buildTree();
     QTreeWidgetItem* makeCategory(const QString& label);
+    void populatePlaylists(const QVector<Playlist>& playlists);
+    void populateSmartPlaylists(const QVector<SmartPlaylist>& playlists);
 
     Database*       m_db;
     QTreeWidget*    m_tree;
     ImportZone*     m_importZone;
+    QFutureWatcher<QVector<Playlist>>* m_playlistsWatcher = nullptr;
+    QFutureWatcher<QVector<SmartPlaylist>>* m_smartWatcher = nullptr;
 
     // Persistent category nodes (never recreated on reload)
     QTreeWidgetItem* m_collectionNode   = nullptr;
@@ -68,6 +81,8 @@ private:
     QTreeWidgetItem* m_smartNode        = nullptr;
     QTreeWidgetItem* m_historyNode      = nullptr;
 
+    QString          m_libraryFolder;
+
     long long        m_activePlaylistId = -1;
 
     // Item data roles
@@ -79,7 +94,7 @@ private:
         RecentlyAdded,
         RecentlyPlayed,
         PlaylistNode,
-        SmartPlaylist,
+        SmartPlaylistNode,
         CreatePlaylist,
         HistoryDate,
         CategoryHeader,
@@ -1,5 +1,6 @@
 #include "CuePointEditor.h"
 #include "services/Database.h"
+#include "services/WriteBehindQueue.h"
 #include "style/Theme.h"
 
 #include <QPainter>
@@ -249,7 +250,7 @@ void CuePointEditor::onDeleteRequested(int slot)
     for (int i = 0; i < m_cues.size(); ++i) {
         const CuePoint& c = m_cues[i];
         if (c.cue_type == CueType::HotCue && c.slot == slot) {
-            m_db->deleteCuePoint(c.id);
+            m_db->writeBehind()->deleteCuePoint(c.id);
             m_cues.removeAt(i);
             refresh();
             return;
@@ -271,7 +272,7 @@ void CuePointEditor::onRenameRequested(int slot)
         if (!ok) return;
 
         c.name = newName.toStdString();
-        m_db->updateCuePoint(c);
+        m_db->writeBehind()->updateCuePoint(c);
         refresh();
         return;
     }
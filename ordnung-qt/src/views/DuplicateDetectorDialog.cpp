@@ -12,6 +12,8 @@
 #include <QMessageBox>
 #include <QDebug>
 
+#include <algorithm>
+
 // ── Helpers ───────────────────────────────────────────────────────────────────
 
 QString DuplicateDetectorDialog::formatTrackCell(const Track& t)
@@ -69,16 +71,16 @@ DuplicateDetectorDialog::DuplicateDetectorDialog(Database* db, QWidget* parent)
     m_table = new QTableWidget(this);
     m_table->setColumnCount(4);
     m_table->setHorizontalHeaderLabels({
-        QStringLiteral("Track A"),
-        QStringLiteral("Track B"),
-        QStringLiteral("Remove A"),
-        QStringLiteral("Remove B")
+        QStringLiteral("#"),
+        QStringLiteral("Track"),
+        QStringLiteral("Location"),
+        QStringLiteral("Remove")
     });
-    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
     m_table->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
-    m_table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Fixed);
+    m_table->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
     m_table->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Fixed);
-    m_table->setColumnWidth(2, 90);
+    m_table->setColumnWidth(0, 40);
     m_table->setColumnWidth(3, 90);
     m_table->verticalHeader()->hide();
     m_table->setSelectionMode(QAbstractItemView::NoSelection);
@@ -117,74 +119,77 @@ DuplicateDetectorDialog::DuplicateDetectorDialog(Database* db, QWidget* parent)
     root->addWidget(footer);
 
     // ── Scan for duplicates ────────────────────────────────────────────────────
-    m_pairs = m_db->findDuplicateTracks();
-    buildTable(m_pairs);
+    m_groups = m_db->findDuplicateGroups();
+    buildTable();
 }
 
-void DuplicateDetectorDialog::buildTable(const QVector<Database::DuplicatePair>& pairs)
+int DuplicateDetectorDialog::remainingInGroup(int group) const
 {
-    m_table->setRowCount(pairs.size());
-
-    const int remaining = static_cast<int>(
-        std::count_if(pairs.begin(), pairs.end(),
-            [this](const Database::DuplicatePair& p) {
-                return !m_removedIds.contains(p.a.id) && !m_removedIds.contains(p.b.id);
-            }));
-    m_countLbl->setText(QStringLiteral("%1 pair%2")
+    return static_cast<int>(
+        std::count_if(m_groups[group].begin(), m_groups[group].end(),
+            [this](const Track& t) { return !m_removedIds.contains(t.id); }));
+}
+
+void DuplicateDetectorDialog::buildTable()
+{
+    int rows = 0;
+    int remaining = 0;
+    for (int g = 0; g < m_groups.size(); ++g) {
+        rows += m_groups[g].size();
+        if (remainingInGroup(g) > 1)
+            ++remaining;
+    }
+    m_table->setRowCount(rows);
+    m_countLbl->setText(QStringLiteral("%1 group%2")
                             .arg(remaining)
                             .arg(remaining == 1 ? QString() : QStringLiteral("s")));
 
-    for (int row = 0; row < pairs.size(); ++row) {
-        const Database::DuplicatePair& pair = pairs[row];
-
-        auto* itemA = new QTableWidgetItem(formatTrackCell(pair.a));
-        auto* itemB = new QTableWidgetItem(formatTrackCell(pair.b));
-        itemA->setTextAlignment(Qt::AlignTop | Qt::AlignLeft);
-        itemB->setTextAlignment(Qt::AlignTop | Qt::AlignLeft);
-
-        if (m_removedIds.contains(pair.a.id))
-            itemA->setForeground(QColor(Theme::Color::Text3));
-        if (m_removedIds.contains(pair.b.id))
-            itemB->setForeground(QColor(Theme::Color::Text3));
-
-        m_table->setItem(row, 0, itemA);
-        m_table->setItem(row, 1, itemB);
-
-        // Remove A button
-        auto* btnA = new QPushButton(QStringLiteral("Remove"), m_table);
-        btnA->setObjectName(QStringLiteral("missingRemoveBtn"));
-        btnA->setEnabled(!m_removedIds.contains(pair.a.id) && !m_removedIds.contains(pair.b.id));
-        connect(btnA, &QPushButton::clicked, this, [this, row]{ onRemoveA(row); });
-        m_table->setCellWidget(row, 2, btnA);
-
-        // Remove B button
-        auto* btnB = new QPushButton(QStringLiteral("Remove"), m_table);
-        btnB->setObjectName(QStringLiteral("missingRemoveBtn"));
-        btnB->setEnabled(!m_removedIds.contains(pair.a.id) && !m_removedIds.contains(pair.b.id));
-        connect(btnB, &QPushButton::clicked, this, [this, row]{ onRemoveB(row); });
-        m_table->setCellWidget(row, 3, btnB);
-
-        m_table->setRowHeight(row, 64);
+    int row = 0;
+    for (int g = 0; g < m_groups.size(); ++g) {
+        const Database::DuplicateGroup& group = m_groups[g];
+        // A group keeps at least one copy; removal stops there.
+        const bool canRemove = remainingInGroup(g) > 1;
+
+        for (int i = 0; i < group.size(); ++i, ++row) {
+            const Track& t = group[i];
+            const bool removed = m_removedIds.contains(t.id);
+
+            auto* groupItem = new QTableWidgetItem(i == 0 ? QString::number(g + 1) : QString());
+            auto* trackItem = new QTableWidgetItem(formatTrackCell(t));
+            auto* pathItem  = new QTableWidgetItem(QString::fromStdString(t.filepath));
+            groupItem->setTextAlignment(Qt::AlignTop | Qt::AlignHCenter);
+            trackItem->setTextAlignment(Qt::AlignTop | Qt::AlignLeft);
+            pathItem->setTextAlignment(Qt::AlignTop | Qt::AlignLeft);
+            pathItem->setToolTip(pathItem->text());
+
+            if (removed) {
+                trackItem->setForeground(QColor(Theme::Color::Text3));
+                pathItem->setForeground(QColor(Theme::Color::Text3));
+            }
+
+            m_table->setItem(row, 0, groupItem);
+            m_table->setItem(row, 1, trackItem);
+            m_table->setItem(row, 2, pathItem);
+
+            auto* btn = new QPushButton(QStringLiteral("Remove"), m_table);
+            btn->setObjectName(QStringLiteral("missingRemoveBtn"));
+            btn->setEnabled(canRemove && !removed);
+            connect(btn, &QPushButton::clicked, this, [this, g, i]{ onRemove(g, i); });
+            m_table->setCellWidget(row, 3, btn);
+
+            m_table->setRowHeight(row, 52);
+        }
     }
 }
 
-void DuplicateDetectorDialog::onRemoveA(int row)
+void DuplicateDetectorDialog::onRemove(int group, int index)
 {
-    if (row < 0 || row >= m_pairs.size()) return;
-    removeRow(row, m_pairs[row].a.id);
-}
+    if (group < 0 || group >= m_groups.size()) return;
+    if (index < 0 || index >= m_groups[group].size()) return;
 
-void DuplicateDetectorDialog::onRemoveB(int row)
-{
-    if (row < 0 || row >= m_pairs.size()) return;
-    removeRow(row, m_pairs[row].b.id);
-}
-
-void DuplicateDetectorDialog::removeRow(int row, long long removeId)
-{
-    const QString title = removeId == m_pairs[row].a.id
-        ? QString::fromStdString(m_pairs[row].a.title)
-        : QString::fromStdString(m_pairs[row].b.title);
+    const Track& track = m_groups[group][index];
+    const long long removeId = track.id;
+    const QString title = QString::fromStdString(track.title);
 
     const auto reply = QMessageBox::question(
         this, QStringLiteral("Remove Track"),
@@ -203,5 +208,5 @@ void DuplicateDetectorDialog::removeRow(int row, long long removeId)
     qInfo() << "DuplicateDetectorDialog: removed track id=" << removeId;
 
     // Rebuild the table to reflect the removal
-    buildTable(m_pairs);
+    buildTable();
 }
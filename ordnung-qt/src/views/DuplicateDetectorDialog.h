@@ -10,8 +10,8 @@ class QLabel;
 class QPushButton;
 
 // DuplicateDetectorDialog — scans the library for duplicate tracks
-// (same artist+title) and presents them for review.
-// User can remove one track from each pair or skip.
+// (same artist+title) and presents them for review, one row per track,
+// grouped by song. User can remove copies until one is left in a group.
 class DuplicateDetectorDialog : public QDialog
 {
     Q_OBJECT
@@ -22,12 +22,11 @@ public:
     QVector<long long> removedIds() const { return m_removedIds; }
 
 private slots:
-    void onRemoveA(int row);
-    void onRemoveB(int row);
-    void removeRow(int row, long long removeId);
+    void onRemove(int group, int index);
 
 private:
-    void buildTable(const QVector<Database::DuplicatePair>& pairs);
+    void buildTable();
+    int  remainingInGroup(int group) const;
     static QString formatTrackCell(const Track& t);
 
     Database*    m_db;
@@ -35,6 +34,6 @@ private:
     QLabel*       m_countLbl = nullptr;
     QPushButton*  m_closeBtn = nullptr;
 
-    QVector<Database::DuplicatePair> m_pairs;
-    QVector<long long>               m_removedIds;
+    QVector<Database::DuplicateGroup> m_groups;
+    QVector<long long>                m_removedIds;
 };
@@ -11,8 +11,11 @@
 #include "views/DuplicateDetectorDialog.h"
 #include "services/M3UExporter.h"
 #include "models/TrackModel.h"
+#include "models/TrackUpdateCoalescer.h"
 #include "commands/UpdateFormatCommand.h"
 #include "services/Database.h"
+#include "services/DatabasePool.h"
+#include "services/WriteBehindQueue.h"
 #include "services/LibraryScanner.h"
 #include "services/PlaylistImporter.h"
 #include "services/AudioAnalyzer.h"
@@ -39,6 +42,8 @@
 #include <QInputDialog>
 #include <QDebug>
 
+#include <utility>
+
 static QWidget* makeSep(QWidget* parent)
 {
     auto* sep = new QWidget(parent);
@@ -68,6 +73,9 @@ LibraryView::LibraryView(TrackModel* tracks, Database* db,
     m_searchEdit = new QLineEdit(toolbar);
     m_searchEdit->setObjectName("searchInput");
     m_searchEdit->setPlaceholderText("search tracks...");
+    m_searchEdit->setToolTip("Words match title, artist, album, genre and comment.\n"
+                             "Filters: bpm:122-128  key:8A,9A  genre:techno  rating>=3\n"
+                             "energy:7-  aiff:no  \"exact phrase\"  -exclude");
     m_searchEdit->setClearButtonEnabled(true);
     m_searchEdit->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     m_searchEdit->setMinimumWidth(160);
@@ -139,6 +147,7 @@ LibraryView::LibraryView(TrackModel* tracks, Database* db,
 
     // ── Track panels ──────────────────────────────────────────────────────
     m_trackTable  = new TrackTableView(tracks, undoStack, this);
+    m_analysisUpdates = new TrackUpdateCoalescer(tracks, this);
     m_trackTable->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     m_detailPanel = new TrackDetailPanel(db, this);
     m_detailPanel->setVisible(false);
@@ -174,20 +183,29 @@ LibraryView::LibraryView(TrackModel* tracks, Database* db,
     root->addWidget(m_playerBar);
 
     // ── Connections ───────────────────────────────────────────────────────
+    m_loadWatcher = new QFutureWatcher<QVector<Track>>(this);
+    connect(m_loadWatcher, &QFutureWatcher<QVector<Track>>::finished,
+            this, &LibraryView::onTracksLoaded);
+
+    m_searchWatcher = new QFutureWatcher<SearchResults>(this);
+    connect(m_searchWatcher, &QFutureWatcher<SearchResults>::finished,
+            this, &LibraryView::onSearchFinished);
+
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(kSearchDebounceMs);
+    connect(m_searchTimer, &QTimer::timeout, this, &LibraryView::runSearch);
+
     connect(m_searchEdit, &QLineEdit::textChanged,
             this, [this](const QString& text) {
-                const QString query = text.trimmed();
-                if (query.isEmpty()) {
-                    // Reset to proxy filter mode (show all)
-                    m_trackTable->setSearchText({});
-                    m_searchBadge->setVisible(false);
+                // Whatever is in flight is for an older query now.
+                m_searchWatcher->cancel();
+                if (text.trimmed().isEmpty()) {
+                    m_searchTimer->stop();
+                    runSearch();
                 } else {
-                    m_trackModel->searchFts(query);
-                    const int count = m_trackModel->rowCount();
-                    m_searchBadge->setText(QString("%1 results").arg(count));
-                    m_searchBadge->setVisible(true);
+                    m_searchTimer->start();
                 }
-                updateStats();
             });
 
     // Track table multi-selection for batch edit
@@ -252,6 +270,30 @@ LibraryView::LibraryView(TrackModel* tracks, Database* db,
                 else
                     m_db->removeSongFromPlaylist(songId, playlistId);
             });
+
+    // Not restarted per change, so a stream of analysis updates still
+    // refreshes the counts every kSmartCountsDelayMs.
+    m_smartCountsTimer = new QTimer(this);
+    m_smartCountsTimer->setSingleShot(true);
+    m_smartCountsTimer->setInterval(kSmartCountsDelayMs);
+    connect(m_smartCountsTimer, &QTimer::timeout,
+            m_collectionPanel, &CollectionTreePanel::reloadSmartPlaylists);
+    const auto scheduleSmartCounts = [this] {
+        if (!m_smartCountsTimer->isActive())
+            m_smartCountsTimer->start();
+    };
+    connect(m_trackModel, &QAbstractItemModel::dataChanged,  this, scheduleSmartCounts);
+    connect(m_trackModel, &QAbstractItemModel::rowsRemoved,  this, scheduleSmartCounts);
+
+    // Queued: flushes run inside database calls, which must not block on a dialog.
+    if (WriteBehindQueue* queue = m_db->writeBehind()) {
+        connect(queue, &WriteBehindQueue::writesFailed,
+                this, [this](int count, const QString& error) {
+                    QMessageBox::warning(this, QStringLiteral("Save Failed"),
+                        QStringLiteral("%1 edit(s) could not be saved and were discarded:\n\n%2")
+                            .arg(count).arg(error));
+                }, Qt::QueuedConnection);
+    }
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -261,6 +303,7 @@ LibraryView::LibraryView(TrackModel* tracks, Database* db,
 void LibraryView::setLibraryFolder(const QString& path)
 {
     m_libraryFolder = path;
+    m_collectionPanel->setLibraryFolder(path);
     if (path.isEmpty()) {
         m_folderBtn->setText("library");
         m_folderBtn->setToolTip(QString());
@@ -281,14 +324,123 @@ void LibraryView::loadAndScan()
 {
     if (m_libraryFolder.isEmpty()) return;
 
-    const QVector<Track> dbTracks = m_db->loadLibrarySongs(m_libraryFolder);
-    qInfo() << "[Library] Loaded" << dbTracks.size() << "tracks from DB";
-    m_trackModel->loadFromDatabase(dbTracks);
     m_detailPanel->clear();
     m_trackTable->setSearchText({});
     m_searchEdit->clear();
+
+    // The folder scan appends to the model, so it starts once this load lands.
+    m_rescanAfterLoad = true;
+    const QString folder = m_libraryFolder;
+    showTracksAsync([folder](Database& db) { return db.loadLibrarySongs(folder); },
+                    [](int count) { qInfo() << "[Library] Loaded" << count << "tracks from DB"; });
+}
+
+void LibraryView::showTracksAsync(std::function<QVector<Track>(Database&)> query,
+                                  std::function<void(int)> onLoaded)
+{
+    m_onLoaded = std::move(onLoaded);
+
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        // Standalone Database (no pool): load synchronously as before.
+        m_loadWatcher->cancel();
+        applyLoadedTracks(query(*m_db));
+        return;
+    }
+
+    m_loadWatcher->setFuture(
+        pool->read<QVector<Track>>(QStringLiteral("library.tracks"), std::move(query)));
+}
+
+void LibraryView::cancelPendingLoad()
+{
+    m_onLoaded = nullptr;
+    m_loadWatcher->cancel();
+    m_searchWatcher->cancel();
+}
+
+void LibraryView::onTracksLoaded()
+{
+    const QFuture<QVector<Track>> future = m_loadWatcher->future();
+    if (!future.isCanceled() && future.resultCount() > 0)
+        applyLoadedTracks(future.result());
+    else if (m_rescanAfterLoad)
+        applyLoadedTracks({}, false);  // superseded: still start the pending scan
+}
+
+void LibraryView::applyLoadedTracks(const QVector<Track>& tracks, bool replaceModel)
+{
+    if (replaceModel) {
+        m_trackModel->loadFromDatabase(tracks);
+        updateStats();
+        if (const auto onLoaded = std::exchange(m_onLoaded, nullptr))
+            onLoaded(tracks.size());
+    }
+    if (m_rescanAfterLoad) {
+        m_rescanAfterLoad = false;
+        rescan();
+    }
+}
+
+void LibraryView::runSearch()
+{
+    const QString query = m_searchEdit->text().trimmed();
+    if (query.isEmpty()) {
+        m_trackTable->setSearchText({});
+        m_searchBadge->setVisible(false);
+        // Leaving search: bring back what the sidebar had selected.
+        if (!m_trackModel->searchQuery().isEmpty())
+            reloadCurrentView();
+        updateStats();
+        return;
+    }
+
+    const int pageSize = TrackModel::kBatchSize;
+    auto search = [query, pageSize](Database& db) {
+        SearchResults results;
+        results.query  = query;
+        results.tracks = db.searchTracks(query, pageSize);
+        results.total  = results.tracks.size() < pageSize
+            ? int(results.tracks.size()) : db.countSearchMatches(query);
+        return results;
+    };
+
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        applySearchResults(search(*m_db));
+        return;
+    }
+    // Cancels a library load still running, just as a load cancels a search.
+    m_onLoaded = nullptr;
+    m_searchWatcher->setFuture(
+        pool->read<SearchResults>(QStringLiteral("library.tracks"), std::move(search)));
+}
+
+void LibraryView::onSearchFinished()
+{
+    const QFuture<SearchResults> future = m_searchWatcher->future();
+    if (future.isCanceled() || future.resultCount() == 0)
+        return;
+    applySearchResults(future.result());
+}
+
+void LibraryView::applySearchResults(const SearchResults& results)
+{
+    if (results.query != m_searchEdit->text().trimmed())
+        return;  // typed on since; the newer query is on its way
+
+    m_trackModel->showSearchResults(results.query, results.tracks, results.total);
     updateStats();
-    rescan();
+    m_searchBadge->setText(QString("%1 results").arg(results.total));
+    m_searchBadge->setVisible(true);
+}
+
+void LibraryView::reloadCurrentView()
+{
+    if (m_activePlaylistId > 0)
+        onPlaylistSelected(m_activePlaylistId);
+    else
+        onCollectionSelected();
 }
 
 void LibraryView::rescan()
@@ -296,14 +448,7 @@ void LibraryView::rescan()
     if (m_libraryFolder.isEmpty()) return;
     if (m_scanWatcher && m_scanWatcher->isRunning()) return;
 
-    const QVector<Track> known = m_db->loadLibrarySongs(m_libraryFolder);
-    QSet<QString> knownPaths;
-    knownPaths.reserve(known.size());
-    for (const Track& t : known)
-        knownPaths.insert(QString::fromStdString(t.filepath));
-
-    qInfo() << "[Library] Scanning for new files in:" << m_libraryFolder
-            << "(already tracked:" << knownPaths.size() << ")";
+    qInfo() << "[Library] Scanning for new files in:" << m_libraryFolder;
 
     if (!m_scanWatcher) {
         m_scanWatcher = new QFutureWatcher<QVector<Track>>(this);
@@ -312,7 +457,14 @@ void LibraryView::rescan()
     }
 
     const QString folder = m_libraryFolder;
-    m_scanWatcher->setFuture(QtConcurrent::run([folder, knownPaths]() -> QVector<Track> {
+    // New files are those on disk whose path is not tracked yet.
+    const auto scan = [folder](const QVector<Track>& tracked) {
+        QSet<QString> knownPaths;
+        knownPaths.reserve(tracked.size());
+        for (const Track& t : tracked)
+            knownPaths.insert(QString::fromStdString(t.filepath));
+        qInfo() << "[Library] Already tracked:" << knownPaths.size();
+
         // Fast scan: filename-only, no ffprobe. Tracks appear in table immediately.
         // AudioAnalyzer::analyzeLibrary() fills in BPM/key/bitrate in the background.
         const QVector<Track> all = LibraryScanner::scanFast(folder);
@@ -322,7 +474,18 @@ void LibraryView::rescan()
                 newOnes.append(t);
         }
         return newOnes;
-    }));
+    };
+
+    DatabasePool* pool = m_db->pool();
+    if (!pool) {
+        const QVector<Track> tracked = m_db->loadLibrarySongs(folder);
+        m_scanWatcher->setFuture(QtConcurrent::run([scan, tracked] { return scan(tracked); }));
+        return;
+    }
+    // The whole scan runs as a pool read: its connection belongs to a thread
+    // the pool owns, and the pool waits for it on shutdown.
+    m_scanWatcher->setFuture(pool->read<QVector<Track>>(QStringLiteral("library.scan"),
+        [scan, folder](Database& db) { return scan(db.loadLibrarySongs(folder)); }));
 }
 
 void LibraryView::importPlaylistFile(const QString& filePath)
@@ -385,15 +548,15 @@ void LibraryView::onCollectionSelected()
 {
     if (m_libraryFolder.isEmpty()) return;
     m_activePlaylistId = -1;
-    const QVector<Track> tracks = m_db->loadLibrarySongs(m_libraryFolder);
-    m_trackModel->loadFromDatabase(tracks);
     m_detailPanel->clear();
-    updateStats();
+    const QString folder = m_libraryFolder;
+    showTracksAsync([folder](Database& db) { return db.loadLibrarySongs(folder); });
 }
 
 void LibraryView::onPlaylistSelected(long long id)
 {
     m_activePlaylistId = id;
+    cancelPendingLoad();
     m_trackModel->loadPlaylist(id);
     m_detailPanel->clear();
     updateStats();
@@ -404,32 +567,25 @@ void LibraryView::onSmartPlaylistSelected(const QString& key)
     m_activePlaylistId = -1;
     m_detailPanel->clear();
 
-    QVector<Track> tracks;
-    if (key == QStringLiteral("needs_aiff")) {
-        const QVector<Track> all = m_db->loadLibrarySongs(m_libraryFolder);
-        for (const Track& t : all)
-            if (!t.has_aiff) tracks.append(t);
-    } else if (key == QStringLiteral("high_bpm")) {
-        const QVector<Track> all = m_db->loadLibrarySongs(m_libraryFolder);
-        for (const Track& t : all)
-            if (t.bpm > 140.0) tracks.append(t);
-    } else if (key == QStringLiteral("top_rated")) {
-        const QVector<Track> all = m_db->loadLibrarySongs(m_libraryFolder);
-        for (const Track& t : all)
-            if (t.rating >= 3) tracks.append(t);
-    } else if (key == QStringLiteral("prepared")) {
-        tracks = m_db->loadPreparedTracks();
-    } else if (key == QStringLiteral("recently_added")) {
-        tracks = m_db->loadRecentlyAdded(30);
-    } else if (key == QStringLiteral("recently_played")) {
-        tracks = m_db->loadRecentlyPlayed(50);
-    } else {
-        onCollectionSelected();
+    if (key == QStringLiteral("recently_added")) {
+        showTracksAsync([](Database& db) { return db.loadRecentlyAdded(30); });
+        return;
+    }
+    if (key == QStringLiteral("recently_played")) {
+        showTracksAsync([](Database& db) { return db.loadRecentlyPlayed(50); });
         return;
     }
 
-    m_trackModel->loadFromDatabase(tracks);
-    updateStats();
+    // Anything else is a smart_playlists id; its members are materialized,
+    // so this reads them like a static playlist.
+    bool ok = false;
+    const long long id = key.toLongLong(&ok);
+    if (!ok) {
+        onCollectionSelected();
+        return;
+    }
+    const QString folder = m_libraryFolder;
+    showTracksAsync([id, folder](Database& db) { return db.loadSmartPlaylistTracks(id, folder); });
 }
 
 void LibraryView::onImportRequested(const QStringList& filePaths)
@@ -495,12 +651,15 @@ void LibraryView::onPlayRequested(const QString& filePath,
     m_playerBar->setVisible(true);
     m_playerBar->playFile(filePath, title, artist);
     if (m_currentSongId > 0)
-        m_db->recordPlay(m_currentSongId);
+        m_db->writeBehind()->recordPlay(m_currentSongId);
 }
 
 void LibraryView::onScanFinished()
 {
-    const QVector<Track> newTracks = m_scanWatcher->result();
+    const QFuture<QVector<Track>> future = m_scanWatcher->future();
+    if (future.isCanceled() || future.resultCount() == 0)
+        return;   // the pool closed before the scan ran
+    const QVector<Track> newTracks = future.result();
     if (newTracks.isEmpty()) {
         qInfo() << "[Library] Scan complete: no new files found";
         return;
@@ -510,13 +669,10 @@ void LibraryView::onScanFinished()
     // ingestAndAppend marks each new track with is_analyzing = true
     m_trackModel->ingestAndAppend(newTracks);
     updateStats();
+    m_collectionPanel->reloadSmartPlaylists();   // counts now include the new files
 
     // Collect newly-added tracks (those with is_analyzing set) for background analysis
-    QVector<Track> toAnalyze;
-    for (const Track& t : m_trackModel->tracks()) {
-        if (t.is_analyzing)
-            toAnalyze.append(t);
-    }
+    const QVector<Track> toAnalyze = m_trackModel->analyzingTracks();
     if (toAnalyze.isEmpty()) return;
 
     // Cancel any previous analysis run
@@ -526,44 +682,29 @@ void LibraryView::onScanFinished()
     }
 
     m_analyzer = new AudioAnalyzer(this);
+    // Posted straight from the worker thread; the coalescer applies results
+    // to the model once per frame.
     connect(m_analyzer, &AudioAnalyzer::trackAnalyzed,
-            this, &LibraryView::onTrackAnalyzed);
+            m_analysisUpdates, &TrackUpdateCoalescer::post, Qt::DirectConnection);
     connect(m_analyzer, &AudioAnalyzer::finished,
             this, [this]() { onAutoAnalysisFinished(); });
 
-    // Timer forces viewport repaints so the analyzing indicator stays visible
-    if (!m_analyzeTimer) {
-        m_analyzeTimer = new QTimer(this);
-        m_analyzeTimer->setInterval(500);
-        connect(m_analyzeTimer, &QTimer::timeout, this, [this]() {
-            if (m_trackTable && m_trackTable->viewport())
-                m_trackTable->viewport()->update();
-        });
-    }
-    m_analyzeTimer->start();
+    m_trackTable->setAnalyzingAnimation(true);
 
     qInfo() << "[Library] Auto-analyzing" << toAnalyze.size() << "new tracks in background...";
     m_analyzer->analyzeLibrary(toAnalyze);
 }
 
-void LibraryView::onTrackAnalyzed(const Track& updated)
-{
-    m_trackModel->updateTrackMetadata(updated);
-}
-
 void LibraryView::onAutoAnalysisFinished()
 {
-    if (m_analyzeTimer)
-        m_analyzeTimer->stop();
+    m_trackTable->setAnalyzingAnimation(false);
+    m_analysisUpdates->flush();   // results posted before finished was emitted
 
     // Clear any remaining is_analyzing flags (e.g. if analysis was cancelled)
-    const QVector<Track>& tracks = m_trackModel->tracks();
-    for (int i = 0; i < tracks.size(); ++i) {
-        if (tracks[i].is_analyzing)
-            m_trackModel->setIsAnalyzing(i, false);
-    }
+    m_trackModel->clearAnalyzing();
 
     updateStats();
+    m_collectionPanel->reloadSmartPlaylists();   // BPM rules see the analyzed values
     qInfo() << "[Library] Background analysis complete.";
 }
 
@@ -577,8 +718,8 @@ void LibraryView::onExportClicked()
 // Run audio analysis on all library tracks.
 void LibraryView::onAnalyzeClicked()
 {
-    const QVector<Track>& tracks = m_trackModel->tracks();
-    if (tracks.isEmpty()) {
+    const TrackStore& store = m_trackModel->store();
+    if (store.isEmpty()) {
         QMessageBox::information(this, QStringLiteral("Analyze"),
                                  QStringLiteral("No tracks to analyze."));
         return;
@@ -587,10 +728,16 @@ void LibraryView::onAnalyzeClicked()
     auto* analyzer = new AudioAnalyzer(this);
     AnalysisProgressDialog dlg(analyzer, this);
 
+    // The analyzer hands its list to a worker thread, so it gets copies.
+    QVector<Track> tracks;
+    tracks.reserve(store.size());
+    for (int row = 0; row < store.size(); ++row)
+        tracks.append(store.track(row));
     analyzer->analyzeLibrary(tracks);
     if (dlg.exec() == QDialog::Accepted) {
         const QVector<Track> updated = dlg.updatedTracks();
         if (!updated.isEmpty()) {
+            cancelPendingLoad();
             m_trackModel->loadFromDatabase(updated);
             updateStats();
             qInfo() << "[Library] Analysis complete:" << updated.size() << "tracks updated";
@@ -617,19 +764,15 @@ void LibraryView::onEditSelectedClicked()
     tracks.reserve(selected.size());
     for (const QModelIndex& proxyIdx : selected) {
         const QModelIndex srcIdx = m_trackTable->proxy()->mapToSource(proxyIdx);
-        if (srcIdx.isValid() && srcIdx.row() < m_trackModel->tracks().size())
-            tracks.append(m_trackModel->tracks()[srcIdx.row()]);
+        if (srcIdx.isValid() && srcIdx.row() < m_trackModel->store().size())
+            tracks.append(m_trackModel->track(srcIdx.row()));
     }
 
     if (tracks.isEmpty()) return;
 
     auto* dlg = new BatchEditDialog(tracks, m_db, this);
     connect(dlg, &BatchEditDialog::applied, this, [this]() {
-        // Reload current view
-        if (m_activePlaylistId > 0)
-            onPlaylistSelected(m_activePlaylistId);
-        else
-            onCollectionSelected();
+        reloadCurrentView();
     });
     dlg->exec();
     dlg->deleteLater();
@@ -639,10 +782,7 @@ void LibraryView::onFindMissingClicked()
 {
     auto* dlg = new MissingFilesDialog(m_db, this);
     connect(dlg, &MissingFilesDialog::libraryChanged, this, [this]() {
-        if (m_activePlaylistId > 0)
-            onPlaylistSelected(m_activePlaylistId);
-        else
-            onCollectionSelected();
+        reloadCurrentView();
     });
     dlg->exec();
     dlg->deleteLater();
@@ -677,10 +817,8 @@ void LibraryView::onPrepareToggleRequested(long long songId, bool currentlyPrepa
 void LibraryView::onHistoryDateSelected(const QString& date)
 {
     m_activePlaylistId = -1;
-    const QVector<Track> tracks = m_db->loadTracksPlayedOn(date);
-    m_trackModel->loadFromDatabase(tracks);
     m_detailPanel->clear();
-    updateStats();
+    showTracksAsync([date](Database& db) { return db.loadTracksPlayedOn(date); });
 }
 
 void LibraryView::onExportPlaylistM3uRequested(long long playlistId)
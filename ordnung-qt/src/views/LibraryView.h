@@ -4,6 +4,7 @@
 #include <QVariantMap>
 #include <QFutureWatcher>
 #include <QTimer>
+#include <functional>
 #include "core/Track.h"
 
 class TrackModel;
@@ -19,6 +20,7 @@ class TrackDetailPanel;
 class PlayerBar;
 class ExportWizard;
 class AudioAnalyzer;
+class TrackUpdateCoalescer;
 class AnalysisProgressDialog;
 class BatchEditDialog;
 class MissingFilesDialog;
@@ -55,7 +57,6 @@ private slots:
                          const QString& title,
                          const QString& artist);
     void onScanFinished();
-    void onTrackAnalyzed(const Track& updated);
     void onAutoAnalysisFinished();
     void onExportClicked();
     void onAnalyzeClicked();
@@ -74,6 +75,28 @@ private:
     void importPlaylistFile(const QString& filePath);
     void updateStats();
 
+    // Runs query on a reader connection and loads the result into the track
+    // model when it arrives; onLoaded(count) runs afterwards. A newer request
+    // (or a synchronous load such as a playlist) supersedes one still running.
+    void showTracksAsync(std::function<QVector<Track>(Database&)> query,
+                         std::function<void(int)> onLoaded = {});
+    void cancelPendingLoad();
+    void onTracksLoaded();
+    void applyLoadedTracks(const QVector<Track>& tracks, bool replaceModel = true);
+
+    // Search-as-you-type: keystrokes restart m_searchTimer; when it fires the
+    // first page of matches (plus the total) is fetched on a reader connection
+    // on the same channel as showTracksAsync, so either supersedes the other.
+    struct SearchResults {
+        QString        query;
+        QVector<Track> tracks;
+        int            total = 0;
+    };
+    void runSearch();
+    void onSearchFinished();
+    void applySearchResults(const SearchResults& results);
+    void reloadCurrentView();
+
     TrackModel*  m_trackModel;
     Database*    m_db;
     QUndoStack*  m_undoStack;
@@ -100,9 +123,23 @@ private:
     // Async scan
     QFutureWatcher<QVector<Track>>* m_scanWatcher = nullptr;
 
+    // Async track loads for the table (latest request wins)
+    QFutureWatcher<QVector<Track>>* m_loadWatcher = nullptr;
+    std::function<void(int)>        m_onLoaded;
+    bool                            m_rescanAfterLoad = false;
+
+    QTimer*                         m_searchTimer   = nullptr;
+    QFutureWatcher<SearchResults>*  m_searchWatcher = nullptr;
+    static constexpr int kSearchDebounceMs = 150;
+
+    // Edits can move tracks in or out of smart playlists; the sidebar counts
+    // are reloaded once the edits pause (or at most this often while they don't).
+    QTimer*                         m_smartCountsTimer = nullptr;
+    static constexpr int kSmartCountsDelayMs = 1000;
+
     // Background metadata analysis (auto-started after fast scan)
     AudioAnalyzer* m_analyzer      = nullptr;
-    QTimer*        m_analyzeTimer  = nullptr;  // forces viewport repaints while analyzing
+    TrackUpdateCoalescer* m_analysisUpdates = nullptr;  // trackAnalyzed results, once per frame
 
     long long m_activePlaylistId = -1;
     long long m_currentSongId    = -1;  // track expanded/playing, for recordPlay
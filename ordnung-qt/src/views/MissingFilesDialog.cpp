@@ -1,6 +1,8 @@
 #include "views/MissingFilesDialog.h"
 
 #include "services/Database.h"
+#include "services/DatabasePool.h"
+#include "services/MissingFileScanner.h"
 #include "style/Theme.h"
 
 #include <QVBoxLayout>
@@ -11,11 +13,18 @@
 #include <QLabel>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QFileInfo>
 
 MissingFilesDialog::MissingFilesDialog(Database* db, QWidget* parent)
     : QDialog(parent)
     , m_db(db)
+    , m_scanner(new MissingFileScanner(this))
 {
+    connect(m_scanner, &MissingFileScanner::missingFound,
+            this, &MissingFilesDialog::onMissingFound);
+    connect(m_scanner, &MissingFileScanner::finished,
+            this, &MissingFilesDialog::onScanFinished);
+
     setWindowTitle("Missing Files");
     setFixedSize(640, 480);
     setStyleSheet(
@@ -114,6 +123,7 @@ MissingFilesDialog::MissingFilesDialog(Database* db, QWidget* parent)
             .arg(Theme::Font::Mono, Theme::Font::MonoFallback)
             .arg(Theme::Color::BorderHov));
     connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(this, &QDialog::finished, m_scanner, &MissingFileScanner::cancel);
     footer->addWidget(closeBtn);
 
     root->addLayout(footer);
@@ -123,69 +133,126 @@ MissingFilesDialog::MissingFilesDialog(Database* db, QWidget* parent)
 
 void MissingFilesDialog::reload()
 {
-    const QVector<Track> missing = m_db->findMissingTracks();
-    m_countLabel->setText(QString("%1 missing").arg(missing.size()));
-    m_countLabel->setVisible(!missing.isEmpty());
-
-    m_table->setRowCount(missing.size());
-    for (int row = 0; row < missing.size(); ++row) {
-        const Track& t = missing[row];
-        const long long songId = t.id;
-
-        auto* titleItem = new QTableWidgetItem(QString::fromStdString(t.title));
-        titleItem->setForeground(QColor(Theme::Color::Text));
-        m_table->setItem(row, 0, titleItem);
-
-        auto* artistItem = new QTableWidgetItem(QString::fromStdString(t.artist));
-        artistItem->setForeground(QColor(Theme::Color::Text2));
-        m_table->setItem(row, 1, artistItem);
-
-        auto* pathItem = new QTableWidgetItem(QString::fromStdString(t.filepath));
-        pathItem->setForeground(QColor(Theme::Color::Amber));
-        m_table->setItem(row, 2, pathItem);
-
-        // Action buttons cell
-        auto* cellWidget = new QWidget(m_table);
-        auto* cellLayout = new QHBoxLayout(cellWidget);
-        cellLayout->setContentsMargins(2, 2, 2, 2);
-        cellLayout->setSpacing(4);
-
-        auto* locateBtn = new QPushButton("LOCATE", cellWidget);
-        locateBtn->setObjectName("missingLocateBtn");
-        locateBtn->setCursor(Qt::PointingHandCursor);
-        locateBtn->setFixedHeight(24);
-        locateBtn->setStyleSheet(
-            QString("QPushButton { background: transparent; border: 1px solid %1; "
-                    "color: %2; font-size: %3px; padding: 0 6px; "
-                    "font-family: '%4', '%5'; }"
-                    "QPushButton:hover { border-color: %2; }")
-                .arg(Theme::Color::Border, Theme::Color::Accent)
-                .arg(Theme::Font::Small)
-                .arg(Theme::Font::Mono, Theme::Font::MonoFallback));
-        connect(locateBtn, &QPushButton::clicked, this, [this, songId]() {
-            onLocateClicked(songId);
-        });
-        cellLayout->addWidget(locateBtn);
-
-        auto* removeBtn = new QPushButton("REMOVE", cellWidget);
-        removeBtn->setObjectName("missingRemoveBtn");
-        removeBtn->setCursor(Qt::PointingHandCursor);
-        removeBtn->setFixedHeight(24);
-        removeBtn->setStyleSheet(
-            QString("QPushButton { background: transparent; border: 1px solid %1; "
-                    "color: %2; font-size: %3px; padding: 0 6px; "
-                    "font-family: '%4', '%5'; }"
-                    "QPushButton:hover { border-color: %2; }")
-                .arg(Theme::Color::Border, Theme::Color::Red)
-                .arg(Theme::Font::Small)
-                .arg(Theme::Font::Mono, Theme::Font::MonoFallback));
-        connect(removeBtn, &QPushButton::clicked, this, [this, songId]() {
-            onRemoveClicked(songId);
+    m_table->setRowCount(0);
+    m_scanning = true;
+    updateCountLabel();
+
+    // With a pool the rows are read by a pool read (the scanner's own threads
+    // must not open pool connections) and the scanner waits for them;
+    // otherwise load here and hand the rows over.
+    if (DatabasePool* pool = m_db->pool()) {
+        QFuture<QVector<Track>> rows = pool->read<QVector<Track>>(
+            QStringLiteral("missingFiles.tracks"),
+            [](Database& db) { return db.loadAllSongs(); });
+        m_scanner->start([rows]() mutable {
+            rows.waitForFinished();
+            return rows.resultCount() > 0 ? rows.result() : QVector<Track>();
         });
-        cellLayout->addWidget(removeBtn);
+    } else {
+        const QVector<Track> tracks = m_db->loadAllSongs();
+        m_scanner->start([tracks]() { return tracks; });
+    }
+}
+
+void MissingFilesDialog::onMissingFound(int generation, const QVector<Track>& tracks)
+{
+    // Batches queued before a cancel or Remove All still arrive; drop them.
+    if (!m_scanner->isCurrent(generation))
+        return;
+    m_table->setUpdatesEnabled(false);
+    for (const Track& t : tracks)
+        appendRow(t);
+    m_table->setUpdatesEnabled(true);
+    updateCountLabel();
+}
+
+void MissingFilesDialog::onScanFinished(int generation, int checked, int missing)
+{
+    if (!m_scanner->isCurrent(generation))
+        return;
+    Q_UNUSED(checked)
+    Q_UNUSED(missing)
+    m_scanning = false;
+    updateCountLabel();
+}
+
+void MissingFilesDialog::updateCountLabel()
+{
+    const int count = m_table->rowCount();
+    m_countLabel->setText(m_scanning ? QString("%1 missing · scanning…").arg(count)
+                                     : QString("%1 missing").arg(count));
+    m_countLabel->setVisible(m_scanning || count > 0);
+}
 
-        m_table->setCellWidget(row, 3, cellWidget);
+int MissingFilesDialog::rowForSong(long long songId) const
+{
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        if (m_table->item(row, 0)->data(Qt::UserRole).toLongLong() == songId)
+            return row;
     }
+    return -1;
+}
+
+void MissingFilesDialog::appendRow(const Track& t)
+{
+    const int row = m_table->rowCount();
+    const long long songId = t.id;
+    m_table->insertRow(row);
+
+    auto* titleItem = new QTableWidgetItem(QString::fromStdString(t.title));
+    titleItem->setData(Qt::UserRole, songId);
+    titleItem->setForeground(QColor(Theme::Color::Text));
+    m_table->setItem(row, 0, titleItem);
+
+    auto* artistItem = new QTableWidgetItem(QString::fromStdString(t.artist));
+    artistItem->setForeground(QColor(Theme::Color::Text2));
+    m_table->setItem(row, 1, artistItem);
+
+    auto* pathItem = new QTableWidgetItem(QString::fromStdString(t.filepath));
+    pathItem->setForeground(QColor(Theme::Color::Amber));
+    m_table->setItem(row, 2, pathItem);
+
+    // Action buttons cell
+    auto* cellWidget = new QWidget(m_table);
+    auto* cellLayout = new QHBoxLayout(cellWidget);
+    cellLayout->setContentsMargins(2, 2, 2, 2);
+    cellLayout->setSpacing(4);
+
+    auto* locateBtn = new QPushButton("LOCATE", cellWidget);
+    locateBtn->setObjectName("missingLocateBtn");
+    locateBtn->setCursor(Qt::PointingHandCursor);
+    locateBtn->setFixedHeight(24);
+    locateBtn->setStyleSheet(
+        QString("QPushButton { background: transparent; border: 1px solid %1; "
+                "color: %2; font-size: %3px; padding: 0 6px; "
+                "font-family: '%4', '%5'; }"
+                "QPushButton:hover { border-color: %2; }")
+            .arg(Theme::Color::Border, Theme::Color::Accent)
+            .arg(Theme::Font::Small)
+            .arg(Theme::Font::Mono, Theme::Font::MonoFallback));
+    connect(locateBtn, &QPushButton::clicked, this, [this, songId]() {
+        onLocateClicked(songId);
+    });
+    cellLayout->addWidget(locateBtn);
+
+    auto* removeBtn = new QPushButton("REMOVE", cellWidget);
+    removeBtn->setObjectName("missingRemoveBtn");
+    removeBtn->setCursor(Qt::PointingHandCursor);
+    removeBtn->setFixedHeight(24);
+    removeBtn->setStyleSheet(
+        QString("QPushButton { background: transparent; border: 1px solid %1; "
+                "color: %2; font-size: %3px; padding: 0 6px; "
+                "font-family: '%4', '%5'; }"
+                "QPushButton:hover { border-color: %2; }")
+            .arg(Theme::Color::Border, Theme::Color::Red)
+            .arg(Theme::Font::Small)
+            .arg(Theme::Font::Mono, Theme::Font::MonoFallback));
+    connect(removeBtn, &QPushButton::clicked, this, [this, songId]() {
+        onRemoveClicked(songId);
+    });
+    cellLayout->addWidget(removeBtn);
+
+    m_table->setCellWidget(row, 3, cellWidget);
 }
 
 void MissingFilesDialog::onLocateClicked(long long songId)
@@ -197,14 +264,29 @@ void MissingFilesDialog::onLocateClicked(long long songId)
         return;
 
     m_db->updateTrackFilepath(songId, newPath);
-    reload();
+
+    // Re-check just this row; the rest of the scan result is still valid.
+    const int row = rowForSong(songId);
+    if (row >= 0) {
+        if (QFileInfo::exists(newPath)) {
+            m_table->removeRow(row);
+        } else {
+            m_table->item(row, 2)->setText(newPath);
+        }
+        updateCountLabel();
+    }
     emit libraryChanged();
 }
 
 void MissingFilesDialog::onRemoveClicked(long long songId)
 {
     m_db->deleteTrack(songId);
-    reload();
+
+    const int row = rowForSong(songId);
+    if (row >= 0) {
+        m_table->removeRow(row);
+        updateCountLabel();
+    }
     emit libraryChanged();
 }
 
@@ -223,10 +305,14 @@ void MissingFilesDialog::onRemoveAllClicked()
     if (answer != QMessageBox::Yes)
         return;
 
-    const QVector<Track> missing = m_db->findMissingTracks();
-    for (const Track& t : missing)
-        m_db->deleteTrack(t.id);
+    // Delete what the scan listed rather than scanning again; a scan still in
+    // progress is stopped so nothing is appended afterwards.
+    m_scanner->cancel();
+    m_scanning = false;
+    for (int row = 0; row < m_table->rowCount(); ++row)
+        m_db->deleteTrack(m_table->item(row, 0)->data(Qt::UserRole).toLongLong());
 
-    reload();
+    m_table->setRowCount(0);
+    updateCountLabel();
     emit libraryChanged();
 }
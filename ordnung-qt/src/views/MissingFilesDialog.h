@@ -1,8 +1,12 @@
 #pragma once
 
 #include <QDialog>
+#include <QVector>
+
+#include "core/Track.h"
 
 class Database;
+class MissingFileScanner;
 class QTableWidget;
 class QLabel;
 
@@ -19,11 +23,18 @@ private slots:
     void onLocateClicked(long long songId);
     void onRemoveClicked(long long songId);
     void onRemoveAllClicked();
+    void onMissingFound(int generation, const QVector<Track>& tracks);
+    void onScanFinished(int generation, int checked, int missing);
 
 private:
     void reload();
+    void appendRow(const Track& t);
+    void updateCountLabel();
+    int  rowForSong(long long songId) const;
 
-    Database*     m_db;
-    QTableWidget* m_table      = nullptr;
-    QLabel*       m_countLabel = nullptr;
+    Database*           m_db;
+    MissingFileScanner* m_scanner    = nullptr;
+    bool                m_scanning   = false;
+    QTableWidget*       m_table      = nullptr;
+    QLabel*             m_countLabel = nullptr;
 };
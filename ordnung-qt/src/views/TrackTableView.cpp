@@ -3,6 +3,7 @@
 #include "models/TrackModel.h"
 #include "delegates/FormatDelegate.h"
 #include "views/table/LibraryTableColumn.h"
+#include "views/table/LibraryTableRowPainter.h"
 #include "style/Theme.h"
 
 #include <QAbstractItemModel>
@@ -17,13 +18,253 @@
 #include <QUndoStack>
 #include <QPalette>
 #include <QColor>
+#include <QGuiApplication>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
 
 // ── GenreFilterProxy ─────────────────────────────────────────────────────────
 
+namespace {
+
+// Rows per task when a large model is indexed or matched in parallel.
+constexpr int kParallelChunk = 8192;
+
+// NFKD splits "é" into "e" plus a combining accent (and "ﬁ" into "fi");
+// dropping the marks and case-folding leaves text that compares plainly.
+std::string foldText(const QString& text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+    QString plain;
+    plain.reserve(decomposed.size());
+    for (const QChar ch : decomposed)
+        if (ch.category() != QChar::Mark_NonSpacing)
+            plain.append(ch);
+    return plain.toCaseFolded().toStdString();
+}
+
+// Pure ASCII, the common case, is lowered byte by byte with no QString.
+void appendFolded(std::string& out, const std::string& text)
+{
+    for (const unsigned char c : text) {
+        if (c >= 0x80) {
+            out += foldText(QString::fromStdString(text));
+            return;
+        }
+    }
+    for (const unsigned char c : text)
+        out.push_back(char(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c));
+}
+
+// Fields joined by a unit separator, which no query contains, so a match
+// never spans two fields.
+std::string searchKey(const TrackRef& t)
+{
+    const std::string* fields[] = {&t.title(), &t.artist(), &t.album(), &t.genre(), &t.keySig()};
+    std::string key;
+    key.reserve(fields[0]->size() + fields[1]->size() + fields[2]->size()
+                + fields[3]->size() + fields[4]->size() + 4);
+    for (const std::string* field : fields) {
+        if (!key.empty())
+            key.push_back('\x1f');
+        appendFolded(key, *field);
+    }
+    return key;
+}
+
+// std::string::find scans for the first byte with memchr (SIMD in every
+// libc we ship on) and compares only at the hits.
+bool containsFolded(const std::string& key, const std::string& needle)
+{
+    return key.find(needle) != std::string::npos;
+}
+
+// fn(from, to) over [first, last], split across the global thread pool when
+// the range is large. The caller blocks until every chunk is done.
+template<typename Fn>
+void forEachRowChunk(int first, int last, Fn fn)
+{
+    if (last - first + 1 <= kParallelChunk) {
+        fn(first, last);
+        return;
+    }
+    QVector<int> starts;
+    for (int from = first; from <= last; from += kParallelChunk)
+        starts.append(from);
+    QtConcurrent::blockingMap(starts, [&](int from) {
+        fn(from, qMin(from + kParallelChunk - 1, last));
+    });
+}
+
+} // namespace
+
 GenreFilterProxy::GenreFilterProxy(QObject* parent)
     : QSortFilterProxyModel(parent)
 {}
 
+void GenreFilterProxy::setSourceModel(QAbstractItemModel* source)
+{
+    for (const QMetaObject::Connection& c : std::as_const(m_sourceConnections))
+        disconnect(c);
+    m_sourceConnections.clear();
+
+    // Connected before the base class hooks up its own handlers, so the index
+    // is current by the time those re-filter the affected rows.
+    if (source) {
+        m_sourceConnections << connect(source, &QAbstractItemModel::rowsInserted,
+                this, [this](const QModelIndex&, int first, int last) {
+                    if (auto* tm = qobject_cast<TrackModel*>(sourceModel()))
+                        m_sorter.insertRows(tm->store(), first, last);
+                    if (m_foldedSearch.empty()) return;
+                    if (size_t(first) > m_keys.size()) { rebuildIndex(); return; }
+                    const int count = last - first + 1;
+                    m_keys.insert(m_keys.begin() + first, count, std::string());
+                    m_matches.insert(m_matches.begin() + first, count, 0);
+                    indexRows(first, last);
+                });
+        m_sourceConnections << connect(source, &QAbstractItemModel::rowsRemoved,
+                this, [this](const QModelIndex&, int first, int last) {
+                    m_sorter.removeRows(first, last);
+                    if (m_foldedSearch.empty()) return;
+                    if (size_t(last) >= m_keys.size()) { rebuildIndex(); return; }
+                    m_keys.erase(m_keys.begin() + first, m_keys.begin() + last + 1);
+                    m_matches.erase(m_matches.begin() + first, m_matches.begin() + last + 1);
+                });
+        m_sourceConnections << connect(source, &QAbstractItemModel::rowsMoved,
+                this, [this](const QModelIndex&, int first, int last,
+                             const QModelIndex&, int dest) {
+                    m_sorter.moveRows(first, last, dest);
+                    if (m_foldedSearch.empty()) return;
+                    auto move = [=](auto& v) {
+                        if (dest > last)
+                            std::rotate(v.begin() + first, v.begin() + last + 1, v.begin() + dest);
+                        else
+                            std::rotate(v.begin() + dest, v.begin() + first, v.begin() + last + 1);
+                    };
+                    move(m_keys);
+                    move(m_matches);
+                });
+        m_sourceConnections << connect(source, &QAbstractItemModel::dataChanged,
+                this, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+                    if (auto* tm = qobject_cast<TrackModel*>(sourceModel()))
+                        m_sorter.updateRows(tm->store(), topLeft.row(), bottomRight.row());
+                    if (!m_foldedSearch.empty())
+                        indexRows(topLeft.row(), bottomRight.row());
+                });
+        m_sourceConnections << connect(source, &QAbstractItemModel::modelReset,
+                                       this, &GenreFilterProxy::rebuildIndexes);
+        m_sourceConnections << connect(source, &QAbstractItemModel::layoutChanged,
+                                       this, &GenreFilterProxy::rebuildIndexes);
+    }
+
+    QSortFilterProxyModel::setSourceModel(source);
+    rebuildIndexes();
+}
+
+void GenreFilterProxy::rebuildIndexes()
+{
+    m_sorter.clear();
+    auto* tm = qobject_cast<TrackModel*>(sourceModel());
+    if (tm && !m_sorter.isEmpty()) {
+        m_sorter.buildKeys(tm->store());
+        m_sorter.rank();
+    }
+    rebuildIndex();
+}
+
+void GenreFilterProxy::setSortColumns(const QVector<TrackSorter::SortColumn>& columns)
+{
+    const int           oldColumn = sortColumn();
+    const Qt::SortOrder oldOrder  = sortOrder();
+
+    m_sorter.setColumns(columns);
+    if (columns.isEmpty()) {
+        QSortFilterProxyModel::sort(-1);
+        return;
+    }
+    if (auto* tm = qobject_cast<TrackModel*>(sourceModel())) {
+        m_sorter.buildKeys(tm->store());
+        m_sorter.rank();
+    }
+
+    const TrackSorter::SortColumn& primary = columns.first();
+    if (primary.column == oldColumn && primary.order == oldOrder)
+        invalidate();   // same primary column: the base class would skip the sort
+    else
+        QSortFilterProxyModel::sort(primary.column, primary.order);
+}
+
+void GenreFilterProxy::sort(int column, Qt::SortOrder order)
+{
+    QVector<TrackSorter::SortColumn> columns;
+    if (column >= 0 && (QGuiApplication::keyboardModifiers() & Qt::ShiftModifier)) {
+        columns = m_sorter.columns();
+        auto it = std::find_if(columns.begin(), columns.end(),
+            [column](const TrackSorter::SortColumn& c) { return c.column == column; });
+        if (it == columns.end())
+            columns.append({column, order});
+        else if (it == columns.begin())
+            it->order = order;
+        else   // the header shows the primary column, so its order is no toggle here
+            it->order = it->order == Qt::AscendingOrder ? Qt::DescendingOrder
+                                                        : Qt::AscendingOrder;
+    } else if (column >= 0) {
+        columns.append({column, order});
+    }
+    setSortColumns(columns);
+}
+
+bool GenreFilterProxy::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    if (m_sorter.isEmpty())
+        return QSortFilterProxyModel::lessThan(left, right);
+    return m_sorter.compare(left.row(), right.row()) < 0;
+}
+
+void GenreFilterProxy::rebuildIndex()
+{
+    auto* tm = qobject_cast<TrackModel*>(sourceModel());
+    if (m_foldedSearch.empty() || !tm) {
+        std::vector<std::string>().swap(m_keys);
+        std::vector<char>().swap(m_matches);
+        return;
+    }
+    const int rows = tm->store().size();
+    m_keys.assign(rows, std::string());
+    m_matches.assign(rows, 0);
+    if (rows > 0)
+        indexRows(0, rows - 1);
+}
+
+void GenreFilterProxy::indexRows(int first, int last)
+{
+    auto* tm = qobject_cast<TrackModel*>(sourceModel());
+    if (!tm) return;
+    const TrackStore& tracks = tm->store();
+    if (m_keys.size() != size_t(tracks.size())) {
+        rebuildIndex();   // out of step with the model; start over
+        return;
+    }
+    last = qMin(last, tracks.size() - 1);
+    forEachRowChunk(first, last, [&](int from, int to) {
+        for (int r = from; r <= to; ++r) {
+            m_keys[r]    = searchKey(tracks[r]);
+            m_matches[r] = containsFolded(m_keys[r], m_foldedSearch);
+        }
+    });
+}
+
+void GenreFilterProxy::matchRows(int first, int last, bool onlyMatches)
+{
+    forEachRowChunk(first, last, [&](int from, int to) {
+        for (int r = from; r <= to; ++r)
+            if (!onlyMatches || m_matches[r])
+                m_matches[r] = containsFolded(m_keys[r], m_foldedSearch);
+    });
+}
+
 void GenreFilterProxy::setGenreFilter(const QString& genre)
 {
     m_genreFilter = genre;
@@ -40,6 +281,23 @@ void GenreFilterProxy::setGenreFilter(const QString& genre)
 void GenreFilterProxy::setSearchText(const QString& text)
 {
     m_searchText = text.trimmed();
+    const std::string folded = foldText(m_searchText);
+
+    if (folded.empty()) {
+        m_foldedSearch.clear();
+        rebuildIndex();                        // releases the index
+    } else if (m_foldedSearch.empty()) {
+        m_foldedSearch = folded;
+        rebuildIndex();                        // first search: build keys
+    } else {
+        // A query that contains the previous one can only match a subset of
+        // its rows, so only those need another look.
+        const bool narrowing = folded.find(m_foldedSearch) != std::string::npos;
+        m_foldedSearch = folded;
+        if (!m_keys.empty())
+            matchRows(0, int(m_keys.size()) - 1, narrowing);
+    }
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -53,28 +311,15 @@ void GenreFilterProxy::setSearchText(const QString& text)
 bool GenreFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex& /*sourceParent*/) const
 {
     auto* tm = qobject_cast<TrackModel*>(sourceModel());
-    if (!tm || sourceRow >= tm->tracks().size())
+    if (!tm || sourceRow >= tm->store().size())
         return true;
 
-    const Track& t = tm->tracks()[sourceRow];
-
-    if (!m_searchText.isEmpty()) {
-        const QString title  = QString::fromStdString(t.title);
-        const QString artist = QString::fromStdString(t.artist);
-        const QString album  = QString::fromStdString(t.album);
-        const QString genre  = QString::fromStdString(t.genre);
-        const QString keySig = QString::fromStdString(t.key_sig);
-
-        if (!title.contains(m_searchText,  Qt::CaseInsensitive)
-         && !artist.contains(m_searchText, Qt::CaseInsensitive)
-         && !album.contains(m_searchText,  Qt::CaseInsensitive)
-         && !genre.contains(m_searchText,  Qt::CaseInsensitive)
-         && !keySig.contains(m_searchText, Qt::CaseInsensitive))
-            return false;
-    }
+    if (!m_foldedSearch.empty()
+        && (size_t(sourceRow) >= m_matches.size() || !m_matches[sourceRow]))
+        return false;
 
     if (!m_genreFilter.isEmpty()) {
-        const QString genre = QString::fromStdString(t.genre);
+        const QString genre = QString::fromStdString(tm->store().genre(sourceRow));
         if (!genre.contains(m_genreFilter, Qt::CaseInsensitive))
             return false;
     }
@@ -117,6 +362,17 @@ TrackTableView::TrackTableView(TrackModel* model, QUndoStack* undoStack, QWidget
     verticalHeader()->hide();
     verticalHeader()->setDefaultSectionSize(Theme::Layout::TrackRowH);
     setSortingEnabled(true);
+    // Connected after setSortingEnabled, so this runs once the proxy has
+    // sorted: a Shift-click adds a tie-breaker, and the indicator the header
+    // just moved onto it goes back to the primary column.
+    connect(horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, [this] {
+        const int primary = m_proxy->sortColumn();
+        if (primary >= 0 && (horizontalHeader()->sortIndicatorSection() != primary
+                             || horizontalHeader()->sortIndicatorOrder() != m_proxy->sortOrder())) {
+            const QSignalBlocker block(horizontalHeader());
+            horizontalHeader()->setSortIndicator(primary, m_proxy->sortOrder());
+        }
+    });
 
     // User can resize columns (Interactive); we distribute width by m_columnWeights on window resize.
     const int colCount = LibraryTableColumn::columnCount();
@@ -161,6 +417,13 @@ TrackTableView::TrackTableView(TrackModel* model, QUndoStack* undoStack, QWidget
     setPalette(p);
 }
 
+TrackTableView::~TrackTableView()
+{
+    // The painter's cache holds fonts and pixmaps; free them while
+    // QApplication is still alive rather than at static destruction.
+    LibraryTableRowPainter::clearRenderCache();
+}
+
 void TrackTableView::setSearchText(const QString& text)
 {
     m_proxy->setSearchText(text);
@@ -194,21 +457,21 @@ QVariantMap TrackTableView::toggleRow(int proxyRow)
     m_expandedTrackId = nowExpanded ? trackId : -1LL;
 
     if (nowExpanded) {
-        const Track& t = m_trackModel->tracks()[srcRow];
+        const TrackRef t = m_trackModel->store()[srcRow];
         QVariantMap map;
-        map["id"]       = (long long)t.id;
-        map["title"]    = QString::fromStdString(t.title);
-        map["artist"]   = QString::fromStdString(t.artist);
-        map["album"]    = QString::fromStdString(t.album);
-        map["genre"]    = QString::fromStdString(t.genre);
-        map["bpm"]      = t.bpm;
-        map["rating"]   = t.rating;
-        map["time"]     = QString::fromStdString(t.time);
-        map["key"]      = QString::fromStdString(t.key_sig);
-        map["added"]    = QString::fromStdString(t.date_added);
-        map["format"]   = QString::fromStdString(t.format);
-        map["has_aiff"] = t.has_aiff;
-        map["filepath"] = QString::fromStdString(t.filepath);
+        map["id"]       = (long long)t.id();
+        map["title"]    = QString::fromStdString(t.title());
+        map["artist"]   = QString::fromStdString(t.artist());
+        map["album"]    = QString::fromStdString(t.album());
+        map["genre"]    = QString::fromStdString(t.genre());
+        map["bpm"]      = t.bpm();
+        map["rating"]   = t.rating();
+        map["time"]     = QString::fromStdString(t.time());
+        map["key"]      = QString::fromStdString(t.keySig());
+        map["added"]    = QString::fromStdString(t.dateAdded());
+        map["format"]   = QString::fromStdString(t.format());
+        map["has_aiff"] = t.hasAiff();
+        map["filepath"] = QString::fromStdString(t.filepath());
         emit trackExpanded(map);
         return map;
     }
@@ -231,6 +494,39 @@ QVector<QPair<int, long long>> TrackTableView::visibleTrackIds() const
     return result;
 }
 
+void TrackTableView::setAnalyzingAnimation(bool running)
+{
+    if (!running) {
+        if (m_spinnerTimer)
+            m_spinnerTimer->stop();
+        return;
+    }
+    if (!m_spinnerTimer) {
+        m_spinnerTimer = new QTimer(this);
+        m_spinnerTimer->setInterval(LibraryTableRowPainter::kSpinnerFrameMs);
+        connect(m_spinnerTimer, &QTimer::timeout, this, &TrackTableView::repaintAnalyzingRows);
+    }
+    m_spinnerTimer->start();
+}
+
+void TrackTableView::repaintAnalyzingRows()
+{
+    const int first = rowAt(0);
+    if (first < 0) return;
+    int last = rowAt(viewport()->height() - 1);
+    if (last < 0)
+        last = m_proxy->rowCount() - 1;
+
+    const int titleCol = LibraryTableColumn::columnIndex(LibraryTableColumn::Title);
+    const TrackStore& store = m_trackModel->store();
+    for (int r = first; r <= last; ++r) {
+        const QModelIndex proxyIdx = m_proxy->index(r, titleCol);
+        const int srcRow = m_proxy->mapToSource(proxyIdx).row();
+        if (srcRow >= 0 && srcRow < store.size() && store.isAnalyzing(srcRow))
+            viewport()->update(thumbnailRect(visualRect(proxyIdx)));
+    }
+}
+
 QRect TrackTableView::thumbnailRect(const QRect& cellRect)
 {
     const int sz = Theme::Layout::TrackThumbSize;
@@ -247,14 +543,14 @@ void TrackTableView::tryPlayFromThumbnail(const QModelIndex& proxyIdx, const QPo
     if (!thumbnailRect(cellRect).contains(pos))
         return;
     const QModelIndex sourceIdx = m_proxy->mapToSource(proxyIdx);
-    if (!sourceIdx.isValid() || sourceIdx.row() >= m_trackModel->tracks().size())
+    if (!sourceIdx.isValid() || sourceIdx.row() >= m_trackModel->store().size())
         return;
-    const Track& t = m_trackModel->tracks()[sourceIdx.row()];
-    if (t.filepath.empty())
+    const TrackRef t = m_trackModel->store()[sourceIdx.row()];
+    if (t.filepath().empty())
         return;
-    emit playRequested(QString::fromStdString(t.filepath),
-                      QString::fromStdString(t.title),
-                      QString::fromStdString(t.artist));
+    emit playRequested(QString::fromStdString(t.filepath()),
+                      QString::fromStdString(t.title()),
+                      QString::fromStdString(t.artist()));
 }
 
 void TrackTableView::mousePressEvent(QMouseEvent* event)
@@ -268,8 +564,8 @@ void TrackTableView::mousePressEvent(QMouseEvent* event)
             // Click on Color column cycles the Pioneer label 0→1→…→8→0.
             // setColorLabel also persists to DB.
             const QModelIndex srcIdx = m_proxy->mapToSource(proxyIdx);
-            if (srcIdx.isValid() && srcIdx.row() < m_trackModel->tracks().size()) {
-                const int cur = m_trackModel->tracks()[srcIdx.row()].color_label;
+            if (srcIdx.isValid() && srcIdx.row() < m_trackModel->store().size()) {
+                const int cur = m_trackModel->store().colorLabel(srcIdx.row());
                 m_trackModel->setColorLabel(srcIdx.row(), (cur + 1) % 9);
             }
         } else if (inThumb) {
@@ -399,6 +695,13 @@ void TrackTableView::applyColumnVisibilityAndWidths()
     // Last column has Stretch resize mode; it gets the remainder automatically and stays within the viewport.
 }
 
+void TrackTableView::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::FontChange || event->type() == QEvent::StyleChange)
+        LibraryTableRowPainter::clearRenderCache();   // cached layouts use the old fonts
+    QTableView::changeEvent(event);
+}
+
 void TrackTableView::resizeEvent(QResizeEvent* event)
 {
     QTableView::resizeEvent(event);
@@ -446,10 +749,10 @@ void TrackTableView::contextMenuEvent(QContextMenuEvent* event)
     const QModelIndex proxyIdx = indexAt(event->pos());
     if (proxyIdx.isValid()) {
         const QModelIndex srcIdx = m_proxy->mapToSource(proxyIdx);
-        if (srcIdx.isValid() && srcIdx.row() < m_trackModel->tracks().size()) {
-            const Track& t = m_trackModel->tracks()[srcIdx.row()];
-            const long long songId = t.id;
-            const bool prepared    = t.is_prepared;
+        if (srcIdx.isValid() && srcIdx.row() < m_trackModel->store().size()) {
+            const TrackRef t = m_trackModel->store()[srcIdx.row()];
+            const long long songId = t.id();
+            const bool prepared    = t.isPrepared();
             const QString actionText = prepared
                 ? QStringLiteral("Remove Preparation Mark")
                 : QStringLiteral("Mark as Prepared");
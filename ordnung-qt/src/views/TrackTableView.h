@@ -4,30 +4,79 @@
 #include <QSortFilterProxyModel>
 #include <QVector>
 
+#include "models/TrackSorter.h"
+
+#include <string>
+#include <vector>
+
 class TrackModel;
 class FormatDelegate;
 class QUndoStack;
+class QTimer;
 
 // GenreFilterProxy extends QSortFilterProxyModel to support:
 //   1. Text search across title, artist, album, genre, key columns
 //   2. Genre tag filter (exact substring match within the genre field)
+//
+// While a search is active every source row has a search key: its five
+// fields case-folded and stripped of diacritics, built once and kept in step
+// with the source model's row signals. setSearchText matches the folded
+// query against those keys up front (in parallel for large models, and only
+// over the previous matches when the query just got longer), so
+// filterAcceptsRow is a lookup.
+//
+// Nothing sets a non-empty search yet: LibraryView's search box runs an FTS
+// query on a pool reader and only ever clears this filter, so the folded
+// index is never built. It is kept for an in-view filter over the rows
+// already loaded.
+//
+// Sorting goes through TrackSorter's typed keys, which the same row signals
+// keep current. Shift-clicking a header adds that column as a tie-breaker
+// (or flips it, if already sorted on) instead of replacing the sort.
 class GenreFilterProxy : public QSortFilterProxyModel
 {
     Q_OBJECT
 public:
     explicit GenreFilterProxy(QObject* parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
     void setGenreFilter(const QString& genre);
     QString genreFilter() const { return m_genreFilter; }
 
     void setSearchText(const QString& text);
 
+    // Sort by several columns at once, highest priority first; empty = unsorted.
+    void setSortColumns(const QVector<TrackSorter::SortColumn>& columns);
+    const QVector<TrackSorter::SortColumn>& sortColumns() const { return m_sorter.columns(); }
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
 
 private:
+    // Recompute keys and matches for source rows [first, last].
+    void indexRows(int first, int last);
+    // Re-test rows [first, last] against m_foldedSearch; with onlyMatches,
+    // rows that already failed are left failed.
+    void matchRows(int first, int last, bool onlyMatches);
+    void rebuildIndex();
+    // Sort keys and search index from scratch, after a source reset.
+    void rebuildIndexes();
+
     QString m_genreFilter;
     QString m_searchText;
+
+    // Indexed only while m_foldedSearch is non-empty; one entry per source row.
+    std::string              m_foldedSearch;
+    std::vector<std::string> m_keys;
+    std::vector<char>        m_matches;
+
+    TrackSorter m_sorter;
+
+    QVector<QMetaObject::Connection> m_sourceConnections;
 };
 
 // TrackTableView — configured QTableView for the track list.
@@ -41,6 +90,7 @@ class TrackTableView : public QTableView
 public:
     explicit TrackTableView(TrackModel* model, QUndoStack* undoStack,
                             QWidget* parent = nullptr);
+    ~TrackTableView() override;
 
     GenreFilterProxy* proxy() const { return m_proxy; }
     TrackModel*       trackModel() const { return m_trackModel; }
@@ -58,6 +108,10 @@ public:
     // Returns all currently visible (proxy) rows as FormatSnapshot-compatible data.
     QVector<QPair<int, long long>> visibleTrackIds() const;
 
+    // Animate the analyzing spinner while background analysis runs. Each
+    // frame repaints only the thumbnails of visible rows still analyzing.
+    void setAnalyzingAnimation(bool running);
+
 signals:
     void trackExpanded(const QVariantMap& trackData);
     void trackCollapsed();
@@ -75,6 +129,7 @@ protected:
     void keyPressEvent(QKeyEvent* event) override;
     void leaveEvent(QEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
     void contextMenuEvent(QContextMenuEvent* event) override;
 
 private:
@@ -82,6 +137,7 @@ private:
     void onSectionResized(int logicalIndex, int oldSize, int newSize);
     static QRect thumbnailRect(const QRect& cellRect);
     void tryPlayFromThumbnail(const QModelIndex& proxyIdx, const QPoint& pos);
+    void repaintAnalyzingRows();
 
     QVector<int> m_columnWeights;
     QVector<int> m_columnMinWidths;
@@ -92,6 +148,7 @@ private:
     GenreFilterProxy* m_proxy;
     FormatDelegate*   m_delegate;
     QUndoStack*       m_undoStack;
+    QTimer*           m_spinnerTimer    = nullptr;
     long long         m_expandedTrackId = -1;
     int               m_hoveredRow      = -1;
     bool              m_hoveredThumb    = false;
@@ -1,15 +1,16 @@
 #pragma once
 
-#include "core/Track.h"
+#include "core/TrackStore.h"
 
 // Row as data wrapper: one row = one track. The library table is row-centric;
 // each row is the single unit of data (a track) with multiple column attributes.
+// Holds a handle into the model's TrackStore, not a copy of the track.
 struct LibraryTableRow {
-    const Track* track = nullptr;
-    int          rowIndex = -1;
+    TrackRef track;
+    int      rowIndex = -1;
 
     LibraryTableRow() = default;
-    LibraryTableRow(const Track* t, int row) : track(t), rowIndex(row) {}
+    LibraryTableRow(const TrackStore* store, int row) : track(store, row), rowIndex(row) {}
 
-    bool isValid() const { return track != nullptr && rowIndex >= 0; }
+    bool isValid() const { return track.isValid() && rowIndex >= 0; }
 };
@@ -6,28 +6,266 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QApplication>
+#include <QCache>
 #include <QFontMetrics>
+#include <QHash>
+#include <QPixmap>
+#include <QStaticText>
 #include <QStyle>
 #include <QTableView>
 #include <QDateTime>
 
+#include <memory>
+#include <string>
+
 namespace LibraryTableRowPainter {
 
+// ── Render cache ─────────────────────────────────────────────────────────────
+//
+// Scrolling repaints every visible cell each frame, and most of what a cell
+// draws is the same as last frame: the same fonts, the same elided titles,
+// the same "128" or "8A", the same badge and dots. All of it is built once
+// and reused. Text is laid out into QStaticText (drawn in the painter's pen
+// colour); badges, dots and the thumbnail frame are antialiased once into
+// pixmaps per device pixel ratio, so cells blit them without antialiasing.
+// Everything lives on the GUI thread.
+
+namespace {
+
+struct CachedText {
+    QStaticText text;
+    int         width = 0;
+};
+
+// An elided cell: the source it was made from, so an edit to the track makes
+// the entry stale without any explicit invalidation.
+struct ElidedText {
+    std::string source;
+    CachedText  text;
+};
+
+struct ElideKey {
+    long long id;
+    int       column;
+    int       width;
+    bool operator==(const ElideKey& o) const
+    { return id == o.id && column == o.column && width == o.width; }
+};
+
+size_t qHash(const ElideKey& k, size_t seed = 0)
+{
+    return qHashMulti(seed, k.id, k.column, k.width);
+}
+
+struct RenderCache {
+    bool  fontsReady = false;
+    QFont title, caption, mono, badge;
+    int   titleHeight = 0, captionHeight = 0, monoHeight = 0;
+
+    QCache<ElideKey, ElidedText> elided{4096};   // ~10 screens of text cells
+    QHash<QString, CachedText>   monoTexts;      // short mono strings: "128", "8A", "3:45"
+    QHash<QString, QPixmap>      pixmaps;        // badges and dots, keyed with the DPR
+
+    void ensureFonts()
+    {
+        if (fontsReady) return;
+        title = QApplication::font();
+        title.setPointSize(Theme::Font::Body);
+        title.setWeight(QFont::Normal);
+        caption = QApplication::font();
+        caption.setPointSize(Theme::Font::Caption);
+        caption.setWeight(QFont::Normal);
+        mono = QFont(QLatin1String(Theme::Font::Mono));
+        mono.setStyleHint(QFont::Monospace);
+        mono.setPointSize(Theme::Font::Meta);
+        badge = QFont(QLatin1String(Theme::Font::Mono));
+        badge.setStyleHint(QFont::Monospace);
+        badge.setPointSize(Theme::Font::Badge);
+        badge.setWeight(QFont::DemiBold);
+        titleHeight   = QFontMetrics(title).height();
+        captionHeight = QFontMetrics(caption).height();
+        monoHeight    = QFontMetrics(mono).height();
+        fontsReady = true;
+    }
+};
+
+// Held on the heap so clearRenderCache() can destroy it: its fonts, pixmaps
+// and static texts must not outlive QApplication, as a plain static would.
+std::unique_ptr<RenderCache>& cacheSlot()
+{
+    static std::unique_ptr<RenderCache> slot;
+    return slot;
+}
+
+RenderCache& cache()
+{
+    std::unique_ptr<RenderCache>& slot = cacheSlot();
+    if (!slot)
+        slot = std::make_unique<RenderCache>();
+    return *slot;
+}
+
+CachedText makeText(const QString& text, const QFont& font)
+{
+    CachedText c;
+    c.text = QStaticText(text);
+    c.text.setTextFormat(Qt::PlainText);
+    c.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    c.text.prepare(QTransform(), font);
+    c.width = QFontMetrics(font).horizontalAdvance(text);
+    return c;
+}
+
+// Draw text within r, vertically centred, aligned left, right or centred.
+void drawText(QPainter* p, const QRect& r, const CachedText& text, const QFont& font,
+              int lineHeight, Qt::Alignment align)
+{
+    int x = r.left();
+    if (align & Qt::AlignRight)
+        x = r.left() + r.width() - text.width;
+    else if (align & Qt::AlignHCenter)
+        x = r.left() + (r.width() - text.width) / 2;
+    p->setFont(font);
+    p->drawStaticText(QPointF(x, r.top() + (r.height() - lineHeight) / 2), text.text);
+}
+
+const CachedText& monoText(const QString& text)
+{
+    RenderCache& c = cache();
+    auto it = c.monoTexts.find(text);
+    if (it == c.monoTexts.end()) {
+        if (c.monoTexts.size() > 4096)   // distinct values are few; this is only a backstop
+            c.monoTexts.clear();
+        it = c.monoTexts.insert(text, makeText(text, c.mono));
+    }
+    return it.value();
+}
+
+// source elided to width in font, cached per (track, column, width).
+const CachedText& elidedText(long long id, int column, int width, const std::string& source,
+                             const QString& placeholder, const QFont& font)
+{
+    RenderCache& c = cache();
+    const ElideKey key{id, column, width};
+    ElidedText* entry = c.elided.object(key);
+    if (!entry || entry->source != source) {
+        const QString text = source.empty() ? placeholder : QString::fromStdString(source);
+        entry = new ElidedText{source,
+            makeText(QFontMetrics(font).elidedText(text, Qt::ElideRight, width), font)};
+        c.elided.insert(key, entry);
+    }
+    return entry->text;
+}
+
+QString pixmapKey(const QString& what, qreal dpr)
+{
+    return what + QLatin1Char('@') + QString::number(dpr);
+}
+
+// A transparent pixmap of logical size, with fn painting it antialiased.
+template<typename Fn>
+QPixmap renderPixmap(const QSize& size, qreal dpr, Fn fn)
+{
+    QPixmap pm(size * dpr);
+    pm.setDevicePixelRatio(dpr);
+    pm.fill(Qt::transparent);
+    QPainter p(&pm);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.setRenderHint(QPainter::TextAntialiasing, true);
+    fn(p);
+    return pm;
+}
+
+const QPixmap& dotPixmap(const QColor& color, int radius, qreal dpr)
+{
+    RenderCache& c = cache();
+    const QString key = pixmapKey(QStringLiteral("dot:%1:%2").arg(color.name(QColor::HexArgb)).arg(radius), dpr);
+    auto it = c.pixmaps.find(key);
+    if (it == c.pixmaps.end()) {
+        const int side = 2 * radius + 2;   // a pixel of room for the antialiased edge
+        it = c.pixmaps.insert(key, renderPixmap(QSize(side, side), dpr, [&](QPainter& p) {
+            p.setPen(Qt::NoPen);
+            p.setBrush(color);
+            p.drawEllipse(QPointF(side / 2.0, side / 2.0), radius, radius);
+        }));
+    }
+    return it.value();
+}
+
+void drawDot(QPainter* p, const QPoint& center, const QColor& color, int radius)
+{
+    const QPixmap& pm = dotPixmap(color, radius, p->device()->devicePixelRatioF());
+    p->drawPixmap(center - QPoint(radius + 1, radius + 1), pm);
+}
+
+const QPixmap& thumbPixmap(qreal dpr)
+{
+    RenderCache& c = cache();
+    const QString key = pixmapKey(QStringLiteral("thumb"), dpr);
+    auto it = c.pixmaps.find(key);
+    if (it == c.pixmaps.end()) {
+        const int sz = Theme::Layout::TrackThumbSize;
+        it = c.pixmaps.insert(key, renderPixmap(QSize(sz + 2, sz + 2), dpr, [&](QPainter& p) {
+            QPainterPath path;
+            path.addRoundedRect(QRectF(1, 1, sz, sz), 2, 2);
+            p.fillPath(path, QColor(Theme::Color::Bg3));
+            p.setPen(QColor(Theme::Color::Text3));
+            p.drawPath(path);
+        }));
+    }
+    return it.value();
+}
+
+const QPixmap& badgePixmap(const QString& format, qreal dpr)
+{
+    RenderCache& c = cache();
+    const QString key = pixmapKey(QStringLiteral("badge:") + format, dpr);
+    auto it = c.pixmaps.find(key);
+    if (it == c.pixmaps.end()) {
+        const Theme::Badge::Colors colors = Theme::Badge::forFormat(format);
+        const QString formatUpper = format.toUpper();
+        const int badgeW = QFontMetrics(c.badge).horizontalAdvance(formatUpper) + 2 * Theme::Badge::HPad;
+        const QRect badgeRect(0, 0, badgeW, Theme::Badge::Height);
+        it = c.pixmaps.insert(key, renderPixmap(badgeRect.size(), dpr, [&](QPainter& p) {
+            QPainterPath path;
+            path.addRoundedRect(badgeRect, Theme::Badge::Radius, Theme::Badge::Radius);
+            p.fillPath(path, colors.bg);
+            p.setFont(c.badge);
+            p.setPen(colors.text);
+            p.drawText(badgeRect, Qt::AlignCenter, formatUpper);
+        }));
+    }
+    return it.value();
+}
+
+} // namespace
+
+void clearRenderCache()
+{
+    cacheSlot().reset();   // rebuilt on the next paint
+}
+
 static void fillBackground(QPainter* p, const QStyleOptionViewItem& opt, bool expanded)
 {
-    const bool selected = opt.state & QStyle::State_Selected;
-    const bool hovered  = opt.state & QStyle::State_MouseOver;
+    static const QColor selHover(Theme::Color::RowSelHov);
+    static const QColor selected(Theme::Color::AccentBg);
+    static const QColor hover(Theme::Color::RowHov);
+    static const QColor expandedBg(Theme::Color::RowExpanded);
+    static const QColor bg(Theme::Color::Bg);
 
-    if (selected && hovered)
-        p->fillRect(opt.rect, QColor(Theme::Color::RowSelHov));
-    else if (selected)
-        p->fillRect(opt.rect, QColor(Theme::Color::AccentBg));
-    else if (hovered)
-        p->fillRect(opt.rect, QColor(Theme::Color::RowHov));
+    const bool isSelected = opt.state & QStyle::State_Selected;
+    const bool isHovered  = opt.state & QStyle::State_MouseOver;
+
+    if (isSelected && isHovered)
+        p->fillRect(opt.rect, selHover);
+    else if (isSelected)
+        p->fillRect(opt.rect, selected);
+    else if (isHovered)
+        p->fillRect(opt.rect, hover);
     else if (expanded)
-        p->fillRect(opt.rect, QColor(Theme::Color::RowExpanded));
+        p->fillRect(opt.rect, expandedBg);
     else
-        p->fillRect(opt.rect, QColor(Theme::Color::Bg));
+        p->fillRect(opt.rect, bg);
 }
 
 void paintCell(QPainter* painter,
@@ -38,14 +276,25 @@ void paintCell(QPainter* painter,
                bool rowExpanded,
                QTableView* view)
 {
-    if (!row.isValid() || row.track == nullptr)
+    if (!row.isValid())
         return;
 
-    const Track& t = *row.track;
+    static const QColor accent(Theme::Color::Accent);
+    static const QColor textBright(Theme::Color::TextBright);
+    static const QColor text2(Theme::Color::Text2);
+    static const QColor text3(Theme::Color::Text3);
+    static const QColor green(Theme::Color::Green);
+    static const QColor separator(Theme::Color::RowSeparator);
+
+    const TrackRef& t = row.track;
     const int colCount = LibraryTableColumn::columnCount();
+    RenderCache& rc = cache();
+    rc.ensureFonts();
 
+    // Text is laid out once and pixmaps are pre-antialiased, so only the
+    // spinner arc needs geometry antialiasing.
     painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setRenderHint(QPainter::Antialiasing, false);
     painter->setRenderHint(QPainter::TextAntialiasing, true);
 
     fillBackground(painter, option, rowExpanded);
@@ -53,17 +302,10 @@ void paintCell(QPainter* painter,
     const LibraryTableColumn::ColumnRole role = LibraryTableColumn::columnRole(columnIndex);
     const bool isFirstColumn = (columnIndex == LibraryTableColumn::columnIndex(LibraryTableColumn::Title));
 
-    if (isFirstColumn && rowExpanded) {
-        painter->fillRect(QRect(cellRect.left(), cellRect.top(), 2, cellRect.height()),
-                         QColor(Theme::Color::Accent));
-    }
+    if (isFirstColumn && rowExpanded)
+        painter->fillRect(QRect(cellRect.left(), cellRect.top(), 2, cellRect.height()), accent);
 
-    const QString title   = QString::fromStdString(t.title);
-    const QString artist  = QString::fromStdString(t.artist);
-    const double  bpm     = t.bpm;
-    const QString keySig  = QString::fromStdString(t.key_sig);
-    const QString timeStr = QString::fromStdString(t.time);
-    const QString format  = QString::fromStdString(t.format.empty() ? "mp3" : t.format);
+    const qreal dpr = painter->device()->devicePixelRatioF();
 
     switch (role) {
     case LibraryTableColumn::Title: {
@@ -73,49 +315,39 @@ void paintCell(QPainter* painter,
         const int thumbY    = cellRect.top() + (cellRect.height() - thumbSize) / 2;
         const QRect thumbRect(thumbX, thumbY, thumbSize, thumbSize);
 
-        QPainterPath path;
-        path.addRoundedRect(thumbRect, 2, 2);
-        painter->fillPath(path, QColor(Theme::Color::Bg3));
-        painter->setPen(QColor(Theme::Color::Text3));
-        painter->drawPath(path);
+        painter->drawPixmap(thumbX - 1, thumbY - 1, thumbPixmap(dpr));
 
         // Analyzing indicator — spinning arc overlay when background ffprobe is running
-        if (t.is_analyzing) {
-            const qint64 frame = QDateTime::currentMSecsSinceEpoch() / 120;
+        if (t.isAnalyzing()) {
+            const qint64 frame = QDateTime::currentMSecsSinceEpoch() / kSpinnerFrameMs;
             const int startAngle = static_cast<int>((frame % 30) * 12) * 16;  // rotates every 3.6s
-            QPen arcPen{QColor(Theme::Color::Accent)};
+            QPen arcPen{accent};
             arcPen.setWidth(2);
             arcPen.setCapStyle(Qt::RoundCap);
+            painter->setRenderHint(QPainter::Antialiasing, true);
             painter->setPen(arcPen);
             painter->setBrush(Qt::NoBrush);
             painter->drawArc(thumbRect.adjusted(4, 4, -4, -4), startAngle, 120 * 16);
+            painter->setRenderHint(QPainter::Antialiasing, false);
         }
 
         const int titleLeft = thumbX + thumbSize + Theme::Layout::GapSm;
         const QRect titleRect(titleLeft, cellRect.top(),
                               cellRect.right() - titleLeft - Theme::Layout::TrackCellPadH,
                               cellRect.height());
-        QFont f = QApplication::font();
-        f.setPointSize(Theme::Font::Body);
-        f.setWeight(QFont::Normal);
-        QFontMetrics fm(f);
-        painter->setFont(f);
-        painter->setPen(QColor(Theme::Color::TextBright));
-        painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter,
-                          fm.elidedText(title, Qt::ElideRight, titleRect.width()));
+        painter->setPen(textBright);
+        drawText(painter, titleRect,
+                 elidedText(t.id(), columnIndex, titleRect.width(), t.title(), QString(), rc.title),
+                 rc.title, rc.titleHeight, Qt::AlignLeft);
         break;
     }
     case LibraryTableColumn::Artist: {
         const QRect r = cellRect.adjusted(Theme::Layout::TrackCellPadH, 0,
                                           -Theme::Layout::TrackCellPadH, 0);
-        QFont f = QApplication::font();
-        f.setPointSize(Theme::Font::Caption);
-        f.setWeight(QFont::Normal);
-        QFontMetrics fm(f);
-        painter->setFont(f);
-        painter->setPen(QColor(Theme::Color::Text2));
-        painter->drawText(r, Qt::AlignLeft | Qt::AlignVCenter,
-                          fm.elidedText(artist, Qt::ElideRight, r.width()));
+        painter->setPen(text2);
+        drawText(painter, r,
+                 elidedText(t.id(), columnIndex, r.width(), t.artist(), QString(), rc.caption),
+                 rc.caption, rc.captionHeight, Qt::AlignLeft);
         break;
     }
     case LibraryTableColumn::Bpm:
@@ -123,118 +355,69 @@ void paintCell(QPainter* painter,
     case LibraryTableColumn::Time: {
         QString text;
         if (role == LibraryTableColumn::Bpm)
-            text = bpm > 0 ? QString::number(static_cast<int>(bpm)) : QString();
+            text = t.bpm() > 0 ? QString::number(static_cast<int>(t.bpm())) : QString();
         else if (role == LibraryTableColumn::Key)
-            text = keySig;
+            text = QString::fromStdString(t.keySig());
         else
-            text = timeStr;
-        const QString display = text.isEmpty() ? QStringLiteral("--") : text;
+            text = QString::fromStdString(t.time());
         const bool rightAlign = (role == LibraryTableColumn::Bpm || role == LibraryTableColumn::Time);
         const QRect r = cellRect.adjusted(Theme::Layout::TrackCellPadH, 0,
                                           -Theme::Layout::TrackCellPadH, 0);
-        QFont f{QLatin1String(Theme::Font::Mono)};
-        f.setStyleHint(QFont::Monospace);
-        f.setPointSize(Theme::Font::Meta);
-        painter->setFont(f);
-        painter->setPen(QColor(text.isEmpty() ? Theme::Color::Text3 : Theme::Color::Text2));
-        painter->drawText(r, (rightAlign ? Qt::AlignRight : Qt::AlignCenter) | Qt::AlignVCenter, display);
+        painter->setPen(text.isEmpty() ? text3 : text2);
+        drawText(painter, r, monoText(text.isEmpty() ? QStringLiteral("--") : text),
+                 rc.mono, rc.monoHeight, rightAlign ? Qt::AlignRight : Qt::AlignHCenter);
         break;
     }
-    case LibraryTableColumn::Format:
-        if (format.isEmpty()) {
-            const QRect r = cellRect.adjusted(Theme::Layout::TrackCellPadH, 0,
-                                             -Theme::Layout::TrackCellPadH, 0);
-            QFont f{QLatin1String(Theme::Font::Mono)};
-            f.setPointSize(Theme::Font::Meta);
-            painter->setFont(f);
-            painter->setPen(QColor(Theme::Color::Text3));
-            painter->drawText(r, Qt::AlignCenter, QStringLiteral("--"));
-        } else {
-            const Theme::Badge::Colors colors = Theme::Badge::forFormat(format);
-            const QString formatUpper = format.toUpper();
-            QFont badgeFont{QLatin1String(Theme::Font::Mono)};
-            badgeFont.setStyleHint(QFont::Monospace);
-            badgeFont.setPointSize(Theme::Font::Badge);
-            badgeFont.setWeight(QFont::DemiBold);
-            painter->setFont(badgeFont);
-            const QFontMetrics fm(badgeFont);
-            const int textWidth = fm.horizontalAdvance(formatUpper);
-            const int badgeW = textWidth + 2 * Theme::Badge::HPad;
-            const int badgeH = Theme::Badge::Height;
-            const int badgeX = cellRect.left() + (cellRect.width() - badgeW) / 2;
-            const int badgeY = cellRect.top() + (cellRect.height() - badgeH) / 2;
-            const QRect badgeRect(badgeX, badgeY, badgeW, badgeH);
-            QPainterPath path;
-            path.addRoundedRect(badgeRect, Theme::Badge::Radius, Theme::Badge::Radius);
-            painter->fillPath(path, colors.bg);
-            painter->setPen(colors.text);
-            painter->drawText(badgeRect, Qt::AlignCenter, formatUpper);
-        }
+    case LibraryTableColumn::Format: {
+        // An empty format is shown as "mp3", as TrackModel::data does.
+        const QString format = QString::fromStdString(t.format().empty() ? "mp3" : t.format());
+        const QPixmap& badge = badgePixmap(format, dpr);
+        const QSize badgeSize = badge.size() / badge.devicePixelRatio();
+        painter->drawPixmap(cellRect.left() + (cellRect.width() - badgeSize.width()) / 2,
+                            cellRect.top() + (cellRect.height() - badgeSize.height()) / 2,
+                            badge);
         break;
+    }
     case LibraryTableColumn::Color: {
-        // Paint a filled circle in the Pioneer label color, centered in the narrow column.
-        const QColor c = Theme::Color::labelColor(t.color_label);
-        if (c.alpha() > 0) {
-            const int dotR = 5;
-            const QPoint center = cellRect.center();
-            painter->setPen(Qt::NoPen);
-            painter->setBrush(c);
-            painter->drawEllipse(center, dotR, dotR);
-        }
+        // Filled circle in the Pioneer label color, centered in the narrow column.
+        const QColor c = Theme::Color::labelColor(t.colorLabel());
+        if (c.alpha() > 0)
+            drawDot(painter, cellRect.center(), c, 5);
         break;
     }
-    case LibraryTableColumn::Prepared: {
-        // Paint a small green dot when the track is marked as prepared.
-        if (t.is_prepared) {
-            const int dotR = 3;
-            const QPoint center = cellRect.center();
-            painter->setPen(Qt::NoPen);
-            painter->setBrush(QColor(Theme::Color::Green));
-            painter->drawEllipse(center, dotR, dotR);
-        }
+    case LibraryTableColumn::Prepared:
+        // Small green dot when the track is marked as prepared.
+        if (t.isPrepared())
+            drawDot(painter, cellRect.center(), green, 3);
         break;
-    }
     case LibraryTableColumn::Bitrate: {
-        const QString text = t.bitrate > 0
-            ? QString::number(t.bitrate)
-            : QStringLiteral("--");
         const QRect r = cellRect.adjusted(Theme::Layout::TrackCellPadH, 0,
                                           -Theme::Layout::TrackCellPadH, 0);
-        QFont f{QLatin1String(Theme::Font::Mono)};
-        f.setStyleHint(QFont::Monospace);
-        f.setPointSize(Theme::Font::Meta);
-        painter->setFont(f);
-        painter->setPen(QColor(t.bitrate > 0 ? Theme::Color::Text2 : Theme::Color::Text3));
-        painter->drawText(r, Qt::AlignRight | Qt::AlignVCenter, text);
+        painter->setPen(t.bitrate() > 0 ? text2 : text3);
+        drawText(painter, r,
+                 monoText(t.bitrate() > 0 ? QString::number(t.bitrate()) : QStringLiteral("--")),
+                 rc.mono, rc.monoHeight, Qt::AlignRight);
         break;
     }
     case LibraryTableColumn::Comment: {
-        const QString text = QString::fromStdString(t.comment);
         const QRect r = cellRect.adjusted(Theme::Layout::TrackCellPadH, 0,
                                           -Theme::Layout::TrackCellPadH, 0);
-        QFont f = QApplication::font();
-        f.setPointSize(Theme::Font::Caption);
-        QFontMetrics fm(f);
-        painter->setFont(f);
-        painter->setPen(QColor(text.isEmpty() ? Theme::Color::Text3 : Theme::Color::Text2));
-        painter->drawText(r, Qt::AlignLeft | Qt::AlignVCenter,
-                          fm.elidedText(text.isEmpty() ? QStringLiteral("—") : text,
-                                        Qt::ElideRight, r.width()));
+        painter->setPen(t.comment().empty() ? text3 : text2);
+        drawText(painter, r,
+                 elidedText(t.id(), columnIndex, r.width(), t.comment(), QStringLiteral("—"), rc.caption),
+                 rc.caption, rc.captionHeight, Qt::AlignLeft);
         break;
     }
     }
 
     // Vertical separator (right edge of cell, except last column)
-    if (columnIndex < colCount - 1) {
-        painter->fillRect(QRect(cellRect.right(), cellRect.top(), 1, cellRect.height()),
-                         QColor(Theme::Color::RowSeparator));
-    }
+    if (columnIndex < colCount - 1)
+        painter->fillRect(QRect(cellRect.right(), cellRect.top(), 1, cellRect.height()), separator);
 
     // Row divider — full viewport width at bottom of row (drawn in every column so it appears even when scrolled)
     if (view && view->viewport()) {
         const int fullWidth = view->viewport()->width();
-        painter->fillRect(QRect(0, cellRect.bottom(), fullWidth, 1),
-                         QColor(Theme::Color::RowSeparator));
+        painter->fillRect(QRect(0, cellRect.bottom(), fullWidth, 1), separator);
     }
 
     painter->restore();
@@ -13,6 +13,9 @@ class QTableView;
 // divider line so rows are clearly separated.
 namespace LibraryTableRowPainter {
 
+// The analyzing spinner advances one step per this many milliseconds.
+constexpr int kSpinnerFrameMs = 120;
+
 void paintCell(QPainter* painter,
                int columnIndex,
                const QRect& cellRect,
@@ -21,4 +24,10 @@ void paintCell(QPainter* painter,
                bool rowExpanded,
                QTableView* view);
 
+// Drops cached fonts, text layouts and pixmaps; call when the application
+// font or style changes, and before QApplication goes away (TrackTableView's
+// destructor does). Track edits need no call: cached text is checked against
+// the track's current value.
+void clearRenderCache();
+
 } // namespace LibraryTableRowPainter